@@ -41,8 +41,10 @@
 #define SMX_HEAP_CSZ_MAX      4136                       /* maximum dynamic chunk size <3> */
 #define SMX_HEAP_USE_MAX      (SMX_HEAP_SPACE*3/4)       /* level to turn on cmerge */
 #define SMX_HEAP_USE_MIN      (SMX_HEAP_USE_MAX - 256)   /* level to turn off cmerge */
+#define SMX_HEAP_BP           0                          /* mheap small block pools <4> */
 
 #define SMX_NUM_BLOCKS         30   /* number of blocks of all sizes */
+#define SMX_NUM_CVS             4   /* number of condition variables */
 #define SMX_NUM_EQS             2
 #define SMX_NUM_EGS             2
 #define SMX_NUM_LSRS           10
@@ -174,5 +176,9 @@
       stack pool must be aligned on an 8-byte boundary.
    3. Replace default value with actual value for application. Does not include 
       chunks permanently allocated at the start of operation.
+   4. Set to 1 to serve small mheap blocks (16-128 bytes) from block pools,
+      if EH_BP is also set. Pool blocks bypass the heap mutex, EVB logging,
+      debug and fence chunks, and double-free detection, so this is off by 
+      default. See mheap_init() in sys.c and eheap.c.
 */
 #endif /* SMX_ACFG_H */
\ No newline at end of file
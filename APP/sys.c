@@ -138,25 +138,53 @@ void smx_IdleMain(u32)
 ============================================================================*/
 /* Large bin size array. The first 13 bins are small bins, spaced 8 bytes apart. 
    The next 16 bins are large bins spaced 112 bytes apart. The top bin contains 
-   all chunks >= 2048 bytes. The array ends with 0xFFFFFFFF. */
+   all chunks >= 2048 bytes. The array ends with 0xFFFFFFFF. If EH_TLSF, the 
+   large bins have TLSF layout for EH_TLSF_SLI == 2: each power of 2 from 128
+   thru 1024 is divided into 4 bins. See eheap.h note 6. */
 
 u32 const mheap_binsz[]
+#if EH_TLSF
+/*bin  0    1     2     3     4     5     6     7     8     9     10    11 */
+      {24,  32,   40,   48,   56,   64,   72,   80,   88,   96,   104,  112, \
+/*bin 12    13    14    15    16    17    18    19    20    21    22    23 */
+      120,  128,  160,  192,  224,  256,  320,  384,  448,  512,  640,  768, \
+/*bin 24    25    26    27    28    29    end */
+      896,  1024, 1280, 1536, 1792, 2048, 0xFFFFFFFF};
+#else
 /*bin  0    1     2     3     4     5     6     7     8     9     10    11 */
       {24,  32,   40,   48,   56,   64,   72,   80,   88,   96,   104,  112, \
 /*bin 12    13    14    15    16    17    18    19    20    21    22    23 */
       120,  128,  256,  384,  512,  640,  768,  896,  1024, 1152, 1280, 1408, \
 /*bin 24    25    26    27    28       end */
       1536, 1664, 1792, 1920, 2048, 0xFFFFFFFF};
+#endif
 
 HBCB        mheap_bin[(sizeof(mheap_binsz)/4)-1];  /* mheap bins */
 u32         mheap_hn;                              /* mheap heap number */
 EHV         mheap_hv;                              /* mheap variable struct */
 
+#if EH_BP && SMX_HEAP_BP
+BPCB        mheap_bp[] = {{16}, {24}, {32}, {48}, {64}, {96}, {128}}; /* mheap block pools */
+#endif
+
 #if EH_STATS
 u32         mheap_bnum[(sizeof(mheap_binsz)/4)-1]; /* mheap number of chunks per bin */
 u32         mheap_bsum[(sizeof(mheap_binsz)/4)-1]; /* mheap sum of chunk sizes per bin */
 #endif
 
+#if EH_BUDDY
+#define     MHEAP_BUDDY_AN  15            /* mheap buddy arena = 32KB */
+#endif
+
+#if EH_HANDLES
+EHH         mheap_hdl[32];                /* mheap handles */
+#endif
+
+#if EH_OSTATS
+EHOS        mheap_os[SMX_NUM_TASKS + 4];  /* mheap owner statistics */
+EHOS        mheap_ss[64];                 /* mheap call site statistics */
+#endif
+
 #pragma section = "mheap" /*<11>*/
 
 /* mheap_init()
@@ -172,6 +200,26 @@ void mheap_init(void)
    /* clear mheap variables structure */
    memset((void*)&mheap_hv, 0, sizeof(EHV));
 
+  #if EH_BP && SMX_HEAP_BP
+   /* load mheap block pool sizes (acfg.h note 4) */
+   mheap_hv.bpcbp = (BPCB_PTR)mheap_bp;
+   mheap_hv.bpnum = sizeof(mheap_bp)/sizeof(BPCB);
+  #endif
+
+  #if EH_HANDLES
+   /* load mheap handle array */
+   mheap_hv.hdlp = (EHH_PTR)mheap_hdl;
+   mheap_hv.hdln = sizeof(mheap_hdl)/sizeof(EHH);
+  #endif
+
+  #if EH_OSTATS
+   /* load mheap owner and call site statistics arrays */
+   mheap_hv.osp = (EHOS_PTR)mheap_os;
+   mheap_hv.osn = sizeof(mheap_os)/sizeof(EHOS);
+   mheap_hv.ssp = (EHOS_PTR)mheap_ss;
+   mheap_hv.ssn = sizeof(mheap_ss)/sizeof(EHOS);
+  #endif
+
    /* initialize mheap */
    mheap_hn = smx_HeapInit(hsz, 0, hsa, &mheap_hv, (u32*)mheap_binsz, 
                                           (HBCB*)mheap_bin, EH_NORM, "mheap");
@@ -181,10 +229,19 @@ void mheap_init(void)
    mheap_hv.mgr = smx_HeapManager;     /* call heap manager for mheap */
    mheap_hv.mode.fl.amerge = ON;       /* automatic merge control */
 
+  #if EH_BUDDY
+   /* get buddy arena for MPU regions from mheap */
+   smx_HeapBuddyInit(MHEAP_BUDDY_AN, NULL, mheap_hn);
+  #endif
+
   #if defined(SMX_DEBUG)
    mheap_hv.mode.fl.fill = ON;         /* load fill patterns into data blocks */
   #endif
 
+  #if EH_OSTATS
+   mheap_hv.mode.fl.debug = ON;        /* owner and site are in debug chunks */
+  #endif
+
   #if EH_STATS
    mheap_hv.bnump = (u32*)&mheap_bnum; /* record heap statistics */
    mheap_hv.bsump = (u32*)&mheap_bsum;
@@ -220,11 +277,20 @@ void smx_HeapManager(u32 hn)
       if (--heap_scan == 0)
       {
          smx_HeapScan(NULL, 4, 4, hn);
+        #if EH_BP && SMX_HEAP_BP
+         /* return empty block pool slabs to the heap */
+         smx_HeapPoolTrim(hn);
+        #endif
          heap_scan = HEAP_SCAN_CNT;
       }
       /* heap bin scan and fix */
       if (smx_HeapBinScan(i, 2, 10, hn))
          i = (i == eh_hvp[hn]->top_bin ? 0 : i + 1);
+
+     #if EH_HANDLES
+      /* slide unlocked handle blocks down, a few chunks at a time */
+      smx_HeapCompact(8, hn);
+     #endif
    }
 
    /* automatic heap chunk merge control */
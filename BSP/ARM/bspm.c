@@ -732,7 +732,11 @@ int sb_IRQToInt(int irq_num)
 
 void * sb_DMABufferAlloc(uint num_bytes)
 {
+  #if SMX_CFG_HEAP_PLACE
+   return(smx_HeapMallocP(num_bytes, 0, SMX_HP_DMA));
+  #else
    return(smx_HeapMalloc(num_bytes));
+  #endif
 }
 
 
@@ -746,7 +750,11 @@ void * sb_DMABufferAlloc(uint num_bytes)
 
 bool sb_DMABufferFree(void *buf)
 {
+  #if SMX_CFG_HEAP_PLACE
+   return(smx_HeapFreeP(buf));
+  #else
    return(smx_HeapFree(buf));
+  #endif
 }
 
 #endif /* 0/1 */
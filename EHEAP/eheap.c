@@ -39,6 +39,11 @@
 
 EHV_PTR  eh_hvp[EH_NUM_HEAPS]; /* pointers to eh variable structures */
 u32      eh_hvpn = 0;          /* next available eh_hvp slot */
+#if EH_TRACE
+EHTR_PTR eh_trp = NULL;        /* trace ring pointer, NULL if off */
+u32      eh_tri = 0;           /* trace record index (total records) */
+u32      eh_trn = 0;           /* trace ring size in records */
+#endif
 
 /*===========================================================================*
                                   MACROS
@@ -46,6 +51,21 @@ u32      eh_hvpn = 0;          /* next available eh_hvp slot */
 
 #define BK_LNK(cp)      (CCB_PTR)((u32)cp->blf & (u32)~EH_FLAGS)
 #define DEBUG_CHK(bp)   (((u32)*((u32*)bp - 1))&EH_DEBUG)
+#define BP_MAPX(p)      (((u32)(p) >> EH_BP_SLAB_AN) - ((u32)eh_hvp[hn]->pi >> EH_BP_SLAB_AN))
+#if EH_OSTATS
+#define BP_RSV(bsz)     ((2*EH_BP_SLAB/(bsz) + (bsz) - 1)/(bsz)) /* index blocks <8> */
+#define BP_OSX(bp, bsz) ((u8*)((u32)(bp) & ~(EH_BP_SLAB - 1)) + \
+                         2*(((u32)(bp) & (EH_BP_SLAB - 1))/(bsz)))
+#else
+#define BP_RSV(bsz)     0
+#endif
+#define BP_NBS(bsz)     (EH_BP_SLAB/(bsz) - BP_RSV(bsz)) /* blocks per slab */
+#define BD_IN(bp)       (eh_hvp[hn]->bdap != NULL && (u8*)(bp) >= eh_hvp[hn]->bdap && \
+                         (u8*)(bp) < eh_hvp[hn]->bdap + ((u32)1 << eh_hvp[hn]->bdan))
+#define BD_NODE(off, o) ((1 << (eh_hvp[hn]->bdan - (o))) - 1 + ((off) >> (o))) /*<20>*/
+#define BD_TST(m, x)    ((m)[(x) >> 3] & (1 << ((x) & 7)))
+#define BD_SET(m, x)    ((m)[(x) >> 3] |= (u8)(1 << ((x) & 7)))
+#define BD_CLR(m, x)    ((m)[(x) >> 3] &= (u8)~(1 << ((x) & 7)))
 
 /*============================================================================
                            SUBROUTINE PROTOTYPES
@@ -55,17 +75,52 @@ static CCB_PTR  aligned_srch(u32 csz, u32 an, u32 hn);
 static void     bin_dq(CCB_PTR cp, u32 hn);
 static void     bin_nq(CCB_PTR cp, u32 hn);
 static u32      bin_find(u32 csz, u32 hn);
-static bool     bp_free(void* bp, u32 hn);
-static void     bp_init(u32 hn);
-static void*    bp_malloc(u32 sz, u32 an, u32 hn);
+#if EH_TLSF
+static CCB_PTR  bin_ff(u32 csz, u32 hn);
+static u32      bin_tlsf(u32 hn);
+#endif
+static CCB_PTR  chunk_chk(void* bp, u32 hn);
+static bool     chunk_grow(CCB_PTR cp, u32 csz, u32 hn);
 static void     chunk_merge_up(CCB_PTR cp, u32 hn);
 static CCB_PTR  chunk_split(CCB_PTR cp, u32 csz, u32 hn, u32 iu = 0);
 static void     chunk_unfree(CCB_PTR cp, u32 hn);
 static void     debug_load(CCB_PTR cp);
+static bool     fence_chk(CCB_PTR cp);
 static void     fix_ffl_bs(u32 binno, u32 num, u32 hn);
 static void     fix_fl_bs(u32 num, u32 hn);
 static CCB_PTR  fix_fl_sz(CCB_PTR cp, u32 hn);
+#if EH_HANDLES
+static bool     hdl_chk(EHH_PTR hp, u32 hn);
+static EHH_PTR  hdl_find(CCB_PTR cp, u32 hn);
+#endif
 static CCB_PTR  merge_space(CCB_PTR cp, u32 d, u32 hn);
+#if EH_OSTATS
+static EHOS_PTR os_add(EHOS_PTR tp, u32 n, u32 id, s32 dsz, s32 dnum);
+#if EH_BP
+static void     os_bpcount(void* bp, u32 bsz, s32 dnum, u32 hn);
+#endif
+static void     os_count(CDCB_PTR dcp, s32 dsz, s32 dnum, u32 hn);
+static u32      os_peek(EHOS_PTR tp, u32 n, u32 id, EH_PK_PAR par, u32 hn);
+#endif
+
+#if EH_BP
+static void     bp_add(u32* cp, s32 n);
+static void*    bp_detach(void** lp);
+static BPCB_PTR bp_find(u32 sz, u32 an, u32 hn);
+static void*    bp_get(BPCB_PTR bpcbp);
+static void     bp_init(u32 hn);
+static void*    bp_malloc(u32 sz, u32 an, u32 hn);
+static void*    bp_pop(void** lp);
+static void     bp_push(void** lp, void* fbp, void* lbp);
+static void*    bp_realloc(void* cbp, u32 sz, u32 an, u32 hn);
+static bool     bp_refill(BPCB_PTR bpcbp, u32 hn);
+static BPCB_PTR bp_slab(void* bp, u32 hn);
+#endif
+
+#if EH_BUDDY
+static void     bd_dq(EHBF_PTR fp, u32 o, u32 hn);
+static void     bd_nq(EHBF_PTR fp, u32 o, u32 hn);
+#endif
 
 #if SB_CPU_ARMM7
 static CCB_PTR  dctc_get(CCB_PTR* dtcp, u32* dp, u32 csz, u32 an, u32 hn);
@@ -282,9 +337,11 @@ bool eh_BinSeed(u32 num, u32 bsz, u32 hn)
    eh_hvp[hn]->errno = EH_OK;
    hmode = eh_hvp[hn]->mode;
 
-   /* get big chunk */
+   /* get big chunk, not a block pool block */
    sz = num*(bsz + EH_CHK_OVH) - EH_CHK_OVH;
+   eh_hvp[hn]->mode.fl.nobp = ON;
    bp = (u32)eh_Malloc(sz, 0, hn);
+   eh_hvp[hn]->mode.fl.nobp = OFF;
    if (bp == NULL)
    {
       eh_error(EH_INSUFF_HEAP, 1, hn);
@@ -302,7 +359,13 @@ bool eh_BinSeed(u32 num, u32 bsz, u32 hn)
       ncp->blf = (CCB_PTR)((u32)cp | EH_INUSE);
       cp = ncp;
       if (eh_hvp[hn]->mode.fl.debug)
+      {
          debug_load(cp);
+         #if EH_OSTATS
+         /* count new chunk. Its size is still counted in the big chunk. */
+         os_count((CDCB_PTR)cp, 0, 1, hn);
+         #endif
+      }
    }
 
    /* adjust blf pointer of next chunk (could be ec) */
@@ -479,6 +542,204 @@ bool eh_BinSort(u32 binno, u32 fnum, u32 hn)
    return false;
 }
 
+#if EH_BUDDY
+/*
+*  eh_BuddyGet()
+*
+*  Gets a block of the smallest power of 2 >= sz from the buddy arena. The
+*  block is aligned on its size, so it can be an MPU region. Splits a larger
+*  free block, if no block of the right size is free. Returns NULL if no 
+*  block is available. <20>
+*/
+void* eh_BuddyGet(u32 sz, u32 hn)
+{
+   EHBF_PTR fp;      /* free block pointer */
+   u32      m;       /* free list map */
+   u32      o, k;    /* block orders (log2 sizes) */
+
+   if (eh_hvp[hn]->bdap == NULL || sz == 0 || sz > ((u32)1 << eh_hvp[hn]->bdan))
+   {
+      eh_error(EH_INV_PAR, 2, hn);
+      return NULL;
+   }
+   eh_hvp[hn]->errno = EH_OK;
+
+   /* find needed order, then smallest free block of that order or larger */
+   for (k = EH_BUDDY_MIN_AN; ((u32)1 << k) < sz; k++) {}
+   m = eh_hvp[hn]->bdbmap >> (k - EH_BUDDY_MIN_AN);
+   if (m == 0)
+   {
+      eh_error(EH_INSUFF_HEAP, 2, hn);
+      return NULL;
+   }
+   for (o = k; !(m & 1); m >>= 1, o++) {}
+   fp = eh_hvp[hn]->bdflp[o - EH_BUDDY_MIN_AN];
+   bd_dq(fp, o, hn);
+
+   /* split block down to order k, freeing upper halves */
+   for (; o > k; o--)
+   {
+      BD_SET(eh_hvp[hn]->bdsmap, BD_NODE((u8*)fp - eh_hvp[hn]->bdap, o));
+      bd_nq((EHBF_PTR)((u8*)fp + ((u32)1 << (o - 1))), o - 1, hn);
+   }
+
+   eh_hvp[hn]->bdused += (u32)1 << k;
+   if (eh_hvp[hn]->bdused > eh_hvp[hn]->bdhwm)
+      eh_hvp[hn]->bdhwm = eh_hvp[hn]->bdused;
+   return fp;
+}
+
+/*
+*  eh_BuddyInit()
+*
+*  Sets up a buddy arena of 2^an bytes for heap hn. The arena is allocated
+*  from heap hn, if ap is NULL; otherwise ap must be aligned on 2^an. The
+*  free lists and bit maps are allocated from heap hn.
+*/
+bool eh_BuddyInit(u32 an, u8* ap, u32 hn)
+{
+   u32   lsz;     /* free list array size */
+   u32   msz;     /* size of each bit map */
+   u32   nl;      /* number of orders */
+   u8*   tp;      /* table pointer */
+
+   nl = an - EH_BUDDY_MIN_AN + 1;
+   if (eh_hvp[hn]->bdap != NULL || an <= EH_BUDDY_MIN_AN || an > 31 ||
+      ((u32)ap & (((u32)1 << an) - 1)) != 0)
+   {
+      eh_error(EH_INV_PAR, 1, hn);
+      return false;
+   }
+   eh_hvp[hn]->errno = EH_OK;
+
+   /* allocate free lists and bit maps, then arena, if not given */
+   lsz = nl*sizeof(EHBF_PTR);
+   msz = ((1 << nl) + 7)/8;
+   eh_hvp[hn]->mode.fl.nobp = ON;
+   tp = (u8*)eh_Malloc(lsz + 2*msz, 0, hn);
+   if (tp != NULL && ap == NULL)
+   {
+      if ((ap = (u8*)eh_Malloc((u32)1 << an, an, hn)) == NULL)
+         eh_Free(tp, hn);
+   }
+   eh_hvp[hn]->mode.fl.nobp = OFF;
+   if (tp == NULL || ap == NULL)
+   {
+      eh_error(EH_INSUFF_HEAP, 1, hn);
+      return false;
+   }
+   memset(tp, 0, lsz + 2*msz);
+
+   eh_hvp[hn]->bdan   = an;
+   eh_hvp[hn]->bdbmap = 0;
+   eh_hvp[hn]->bdflp  = (EHBF_PTR*)tp;
+   eh_hvp[hn]->bdfmap = tp + lsz;
+   eh_hvp[hn]->bdhwm  = 0;
+   eh_hvp[hn]->bdsmap = tp + lsz + msz;
+   eh_hvp[hn]->bdused = 0;
+
+   /* whole arena is one free block */
+   eh_hvp[hn]->bdap = ap;
+   bd_nq((EHBF_PTR)ap, an, hn);
+   return true;
+}
+
+/*
+*  eh_BuddyPeek()
+*
+*  Returns information concerning the buddy arena.
+*/
+u32 eh_BuddyPeek(EH_PK_PAR par, u32 hn)
+{
+   u32 m;            /* free list map */
+   u32 o;            /* order */
+   u32 val = 0;      /* value returned */
+
+   if (eh_hvp[hn]->bdap == NULL)
+   {
+      eh_error(EH_INV_PAR, 1, hn);
+      return -1;
+   }
+   eh_hvp[hn]->errno = EH_OK;
+
+   switch (par)
+   {
+      case EH_PK_INUSE:
+         val = eh_hvp[hn]->bdused;
+         break;
+      case EH_PK_LARGEST:
+         m = eh_hvp[hn]->bdbmap;
+         for (o = EH_BUDDY_MIN_AN - 1; m != 0; m >>= 1, o++) {}
+         val = (eh_hvp[hn]->bdbmap == 0 ? 0 : (u32)1 << o);
+         break;
+      case EH_PK_MAXUSE:
+         val = eh_hvp[hn]->bdhwm;
+         break;
+      case EH_PK_SIZE:
+         val = (u32)1 << eh_hvp[hn]->bdan;
+         break;
+      case EH_PK_SPACE:
+         val = ((u32)1 << eh_hvp[hn]->bdan) - eh_hvp[hn]->bdused;
+         break;
+      default:
+         eh_error(EH_INV_PAR, 1, hn);
+         val = -1;
+   }
+   return val;
+}
+
+/*
+*  eh_BuddyRel()
+*
+*  Releases a block to the buddy arena. Finds the block size from the split
+*  map, then merges the block with its buddy, for as long as the buddy is 
+*  free. Returns false if bp is not an arena block in use. <20>
+*/
+bool eh_BuddyRel(void* bp, u32 hn)
+{
+   u8*   ap = eh_hvp[hn]->bdap;  /* arena pointer */
+   u32   boff;    /* buddy offset */
+   u32   o;       /* block order */
+   u32   off;     /* block offset */
+
+   if (!BD_IN(bp))
+   {
+      eh_error(EH_INV_PAR, 2, hn);
+      return false;
+   }
+   off = (u8*)bp - ap;
+
+   /* descend split nodes from root to the block */
+   for (o = eh_hvp[hn]->bdan; o > EH_BUDDY_MIN_AN && 
+                  BD_TST(eh_hvp[hn]->bdsmap, BD_NODE(off, o)); o--) {}
+   if ((off & (((u32)1 << o) - 1)) != 0)
+   {
+      eh_error(EH_INV_PAR, 2, hn);
+      return false;
+   }
+   if (BD_TST(eh_hvp[hn]->bdfmap, BD_NODE(off, o)))
+   {
+      eh_error(EH_HEAP_ERROR, 2, hn);  /* double free */
+      return false;
+   }
+   eh_hvp[hn]->errno = EH_OK;
+   eh_hvp[hn]->bdused -= (u32)1 << o;
+
+   /* merge with free buddies */
+   for (; o < eh_hvp[hn]->bdan; o++)
+   {
+      boff = off ^ ((u32)1 << o);
+      if (!BD_TST(eh_hvp[hn]->bdfmap, BD_NODE(boff, o)))
+         break;
+      bd_dq((EHBF_PTR)(ap + boff), o, hn);
+      off &= ~((u32)1 << o);
+      BD_CLR(eh_hvp[hn]->bdsmap, BD_NODE(off, o + 1));
+   }
+   bd_nq((EHBF_PTR)(ap + off), o, hn);
+   return true;
+}
+#endif /* EH_BUDDY */
+
 /*
 *  eh_Calloc()
 *
@@ -488,13 +749,14 @@ bool eh_BinSort(u32 binno, u32 fnum, u32 hn)
 void* eh_Calloc(u32 num, u32 sz, u32 an, u32 hn)
 {
    void* bp;
+   u32   fill = eh_hvp[hn]->mode.fl.fill;
 
    eh_hvp[hn]->mode.fl.fill = OFF;
    eh_hvp[hn]->errno     = EH_OK;
    bp = eh_Malloc(num*sz, an, hn);
-   if (bp > 0)   /* clear block */
+   if (bp != NULL)   /* clear block */
       memset((void*)bp, 0, num*sz);
-   eh_hvp[hn]->mode.fl.fill = ON;
+   eh_hvp[hn]->mode.fl.fill = fill;
    return bp;
 }
 
@@ -585,6 +847,100 @@ u32 eh_ChunkPeek(void* vp, EH_PK_PAR par, u32 hn)
    return val;
 }
 
+#if EH_HANDLES
+/*
+*  eh_Compact()
+*
+*  Examines up to num chunks, starting where the previous call stopped. Each 
+*  unlocked handle block that follows a free chunk, other than dc or tc, is 
+*  slid down to the start of the free chunk, and its handle is updated. The 
+*  free chunk becomes the chunk above the block, and it is merged with the 
+*  next chunk, if free, so free space moves up the heap as compaction 
+*  proceeds. Returns true when the end of the heap is reached; the next call
+*  starts from the start of the heap. <19>
+*/
+bool eh_Compact(u32 num, u32 hn)
+{
+   CCB_PTR  cp;      /* chunk pointer */
+   u32      flags;
+   u32*     fp;      /* fill pointer */
+   u32      fsz;     /* free chunk size */
+   EHH_PTR  hp;      /* handle pointer */
+   u32      i;
+   CCB_PTR  mcp;     /* moved chunk pointer */
+   CCB_PTR  ncp;     /* next chunk pointer */
+   CCB_PTR  pcp;     /* previous chunk pointer */
+   CCB_PTR  px = (CCB_PTR)eh_hvp[hn]->px;
+   u32      usz;     /* inuse chunk size */
+
+   eh_hvp[hn]->errno = EH_OK;
+   if ((cp = eh_hvp[hn]->cmp) == NULL)
+      cp = (CCB_PTR)eh_hvp[hn]->pi;
+
+   for (; num > 0; num--, cp = cp->fl)
+   {
+      if (cp >= px)
+      {
+         eh_hvp[hn]->cmp = NULL;
+         return true;
+      }
+
+      /* look for free chunk followed by unlocked handle block */
+      mcp = cp->fl;
+      if (!EH_IS_FREE(cp) || cp == eh_hvp[hn]->dcp || cp == eh_hvp[hn]->tcp
+          || mcp >= px || (hp = hdl_find(mcp, hn)) == NULL || hp->lock > 0)
+         continue;
+
+      fsz = (u32)mcp - (u32)cp;
+      usz = (u32)mcp->fl - (u32)mcp;
+      pcp = BK_LNK(cp);
+      ncp = mcp->fl;
+
+      /* slide inuse chunk down to cp and fix its links and handle */
+      bin_dq(cp, hn);
+      memmove((void*)cp, (void*)mcp, usz);
+      mcp = cp;
+      flags = (u32)mcp->blf & EH_FLAGS;
+      mcp->blf = (CCB_PTR)((u32)pcp | flags);
+      mcp->fl = (CCB_PTR)((u32)mcp + usz);
+      if (flags & EH_SSP)
+         *((u32*)mcp->fl - 1) -= fsz;
+      hp->bp = (void*)((u32)hp->bp - fsz);
+
+      /* make free chunk above it */
+      cp = mcp->fl;
+      cp->fl  = ncp;
+      cp->blf = mcp;
+      cp->sz  = fsz;
+      flags = (u32)ncp->blf & EH_FLAGS;
+      ncp->blf = (CCB_PTR)((u32)cp | flags);
+      if (EH_IS_FREE(ncp))
+         chunk_merge_up(cp, hn);
+
+      /* fill and put free chunk into its bin, unless dc or tc */
+      if (cp != eh_hvp[hn]->dcp && cp != eh_hvp[hn]->tcp)
+      {
+         if (eh_hvp[hn]->mode.fl.fill)
+         {
+            fp = (u32*)cp + cp->sz/4 - 1;
+            for (i = (cp->sz - sizeof(CCB))/4; i > 0; i--, fp--)
+               *fp = EH_FREE_FILL;
+         }
+         bin_nq(cp, hn);
+      }
+
+      /* restart heap scan/fix, if in progress */
+      eh_hvp[hn]->hsp = NULL;
+      eh_hvp[hn]->mode.fl.hs_fwd = ON;
+
+      /* continue with the new free chunk */
+      cp = mcp;
+   }
+   eh_hvp[hn]->cmp = cp;
+   return false;
+}
+#endif
+
 /*
 *  eh_Extend()
 *
@@ -697,6 +1053,12 @@ bool eh_Free(void* bp, u32 hn)
    if (bp == NULL)
       return true;
 
+   #if EH_BUDDY
+   /* release block to buddy arena, if it is in the arena */
+   if (BD_IN(bp))
+      return eh_BuddyRel(bp, hn);
+   #endif
+
    /* check that bp is in heap range */
    pi = (CCB_PTR)eh_hvp[hn]->pi;
    px = (CCB_PTR)eh_hvp[hn]->px;
@@ -708,10 +1070,13 @@ bool eh_Free(void* bp, u32 hn)
    }
 
    #if EH_BP
-   if (bp < eh_hvp[hn]->fhcp)
+   /* release block to its block pool, if it is in a slab */
+   if (bp_slab(bp, hn) != NULL)
    {
-      if (bp_free(bp, hn))
+      if (eh_PoolRel(bp, hn))
          return true;
+      eh_error(EH_INV_PAR, 2, hn);
+      return false;
    }
    #endif
 
@@ -747,6 +1112,12 @@ bool eh_Free(void* bp, u32 hn)
    /* reduce eh_hvp[hn]->hused */
    eh_hvp[hn]->hused -= cp->sz;
 
+   #if EH_OSTATS
+   /* uncount debug chunk from its owner and call site */
+   if (DEBUG_CHK(bp))
+      os_count((CDCB_PTR)cp, -(s32)cp->sz, -1, hn);
+   #endif
+
    #if EH_SS_MERGE
    /* merge spare space from inuse prechunk with freed chunk unless realloc */
    if (((u32)pcp->blf & EH_SSP) && !eh_hvp[hn]->mode.fl.realloc)
@@ -766,6 +1137,10 @@ bool eh_Free(void* bp, u32 hn)
          eh_hvp[hn]->hsp = cpn;
       if (eh_hvp[hn]->hfp == cp)
          eh_hvp[hn]->hfp = cpn;
+      #if EH_HANDLES
+      if (eh_hvp[hn]->cmp == cp)
+         eh_hvp[hn]->cmp = cpn;
+      #endif
       cp = cpn;
    }
    #endif
@@ -787,6 +1162,10 @@ bool eh_Free(void* bp, u32 hn)
             eh_hvp[hn]->hsp = pcp;
          if (eh_hvp[hn]->hfp == cp)
             eh_hvp[hn]->hfp = pcp;
+         #if EH_HANDLES
+         if (eh_hvp[hn]->cmp == cp)
+            eh_hvp[hn]->cmp = pcp;
+         #endif
          cp = pcp;
       }
       else
@@ -819,6 +1198,207 @@ bool eh_Free(void* bp, u32 hn)
    return true;
 }
 
+/*
+*  eh_FreeM()
+*
+*  Frees n blocks. Sorts bpp[] by address, then frees each run of blocks whose
+*  chunks are adjacent in the heap as one chunk, so that the run is merged and
+*  binned once. Each chunk is checked as by eh_Free(), and the fences of each 
+*  debug chunk are checked, since merged chunks cannot be checked later by 
+*  eh_Scan(). Clears bpp[]. Returns false if any block was not freed or had a 
+*  broken fence. <21>
+*/
+bool eh_FreeM(void** bpp, u32 n, u32 hn)
+{
+   void*    bp;      /* block pointer */
+   CCB_PTR  cp;      /* run chunk pointer */
+   EH_ERRNO err = EH_OK; /* first error */
+   u32      flags;
+   u32      i, j;
+   CCB_PTR  ncp;     /* next chunk pointer */
+   bool     pass = true;
+   void*    pbp = NULL; /* previous block pointer */
+   #if EH_OSTATS
+   u32      sz;      /* merged chunk size */
+   #endif
+
+   eh_hvp[hn]->errno = EH_OK;
+   if (bpp == NULL)
+   {
+      eh_error(EH_INV_PAR, 2, hn);
+      return false;
+   }
+
+   /* sort block pointers by address. n is normally small. */
+   for (i = 1; i < n; i++)
+   {
+      bp = bpp[i];
+      for (j = i; j > 0 && (u32)bpp[j-1] > (u32)bp; j--)
+         bpp[j] = bpp[j-1];
+      bpp[j] = bp;
+   }
+
+   for (i = 0; i < n; i = j)
+   {
+      bp = bpp[i];
+      j  = i + 1;
+      bpp[i] = NULL;
+      if (bp != NULL && bp == pbp)  /* same block twice */
+      {
+         if (err == EH_OK)
+            err = EH_HEAP_ERROR;
+         continue;
+      }
+      pbp = bp;
+      if ((cp = chunk_chk(bp, hn)) != NULL)
+      {
+         if (DEBUG_CHK(bp) && !fence_chk(cp) && err == EH_OK)
+            err = EH_HEAP_FENCE_BRKN;
+
+         /* merge following chunks of the batch into cp */
+         for (; j < n && (ncp = chunk_chk(bpp[j], hn)) == cp->fl && 
+                                                   BK_LNK(ncp) == cp; j++)
+         {
+            if (DEBUG_CHK(bpp[j]) && !fence_chk(ncp) && err == EH_OK)
+               err = EH_HEAP_FENCE_BRKN;
+            #if EH_OSTATS
+            /* move ncp space to cp, for eh_Free() to uncount */
+            sz = (u32)ncp->fl - (u32)ncp;
+            if (DEBUG_CHK(bpp[j]))
+               os_count((CDCB_PTR)ncp, -(s32)sz, -1, hn);
+            if (DEBUG_CHK(bp))
+               os_count((CDCB_PTR)cp, sz, 0, hn);
+            #endif
+            flags = (u32)ncp->fl->blf & EH_FLAGS;
+            cp->fl = ncp->fl;
+            ncp->fl->blf = (CCB_PTR)((u32)cp | flags);
+
+            /* cp now ends where ncp did, so it has ncp's spare space, if any */
+            cp->blf = (CCB_PTR)(((u32)cp->blf & ~EH_SSP) | ((u32)ncp->blf & EH_SSP));
+
+            /* Adjust heap scan and fix pointers, if necessary */
+            if (eh_hvp[hn]->hsp == ncp)
+               eh_hvp[hn]->hsp = cp;
+            if (eh_hvp[hn]->hfp == ncp)
+               eh_hvp[hn]->hfp = cp;
+            #if EH_HANDLES
+            if (eh_hvp[hn]->cmp == ncp)
+               eh_hvp[hn]->cmp = cp;
+            #endif
+            pbp = bpp[j];
+            bpp[j] = NULL;
+         }
+      }
+      if (!eh_Free(bp, hn))
+      {
+         pass = false;
+         if (err == EH_OK)
+            err = eh_hvp[hn]->errno;
+      }
+   }
+   if (err != EH_OK)
+   {
+      eh_error(err, 2, hn);
+      pass = false;
+   }
+   return pass;
+}
+
+#if EH_HANDLES
+/*
+*  eh_HandleAlloc()
+*
+*  Allocates a movable block of sz bytes from heap hn and returns a handle 
+*  for it, or NULL if there is no free handle or not enough heap space. The
+*  block is 8-byte aligned and unlocked. <19>
+*/
+EHH_PTR eh_HandleAlloc(u32 sz, u32 hn)
+{
+   u32*     bp;      /* block pointer */
+   EHH_PTR  hp;      /* handle pointer */
+   EHH_PTR  hpx;     /* handle array end */
+   u32      nobp;    /* nobp save */
+
+   eh_hvp[hn]->errno = EH_OK;
+
+   /* find a free handle */
+   hp  = eh_hvp[hn]->hdlp;
+   hpx = hp + eh_hvp[hn]->hdln;
+   for (; hp < hpx && hp->bp != NULL; hp++) {}
+   if (hp == hpx)
+   {
+      eh_error(EH_INSUFF_HEAP, 1, hn);
+      return NULL;
+   }
+
+   /* get a chunk, not a block pool block, with room for the handle pointer */
+   nobp = eh_hvp[hn]->mode.fl.nobp;
+   eh_hvp[hn]->mode.fl.nobp = ON;
+   bp = (u32*)eh_Malloc(sz + 8, 0, hn);
+   eh_hvp[hn]->mode.fl.nobp = nobp;
+   if (bp == NULL)
+      return NULL;
+
+   *bp = (u32)hp;
+   hp->bp = (void*)(bp + 2);
+   hp->lock = 0;
+   return hp;
+}
+
+/*
+*  eh_HandleFree()
+*
+*  Frees the block of handle hp and the handle. Fails if the block is locked.
+*/
+bool eh_HandleFree(EHH_PTR hp, u32 hn)
+{
+   if (!hdl_chk(hp, hn))
+      return false;
+   if (hp->lock > 0)
+   {
+      eh_error(EH_INV_PAR, 2, hn);
+      return false;
+   }
+   if (!eh_Free((void*)((u32)hp->bp - 8), hn))
+      return false;
+   hp->bp = NULL;
+   return true;
+}
+
+/*
+*  eh_HandleLock()
+*
+*  Locks the block of handle hp, so that eh_Compact() does not move it, and
+*  returns its block pointer. Locks nest. Returns NULL if hp is invalid.
+*/
+void* eh_HandleLock(EHH_PTR hp, u32 hn)
+{
+   if (!hdl_chk(hp, hn))
+      return NULL;
+   hp->lock++;
+   return hp->bp;
+}
+
+/*
+*  eh_HandleUnlock()
+*
+*  Undoes one eh_HandleLock() of handle hp. When no locks remain, the block 
+*  may be moved, and pointers to it must no longer be used.
+*/
+bool eh_HandleUnlock(EHH_PTR hp, u32 hn)
+{
+   if (!hdl_chk(hp, hn))
+      return false;
+   if (hp->lock == 0)
+   {
+      eh_error(EH_INV_PAR, 2, hn);
+      return false;
+   }
+   hp->lock--;
+   return true;
+}
+#endif
+
 /*
 *  eh_Init()
 *
@@ -826,9 +1406,9 @@ bool eh_Free(void* bp, u32 hn)
 *  chunk of 8 bytes, an end chunk of 8 bytes, a donor chunk, and a top chunk. 
 *  Start and end chunks have 0 data bytes, the donor chunk has dcsz bytes,
 *  and the top chunk has the remaining free space. Initializes the 
-*  eh_hvp[hn]->hcb PCB, heap bins, heap modes, heap used & high-water mark, and 
-*  returns true, if successful or if heap already initialized. Fails and 
-*  returns false if parameters are invalid.
+*  eh_hvp[hn]->hcb PCB, heap bins, heap modes, heap used & high-water mark, 
+*  and block pools, if any, and returns true, if successful or if heap already
+*  initialized. Fails and returns false if parameters are invalid.
 */
 u32 eh_Init(u32 sz, u32 dcsz, u8* hp, EHV_PTR vp, u32* bszap, HBCB* binp, 
                                               u32 mode, const char* name)
@@ -906,11 +1486,6 @@ u32 eh_Init(u32 sz, u32 dcsz, u8* hp, EHV_PTR vp, u32* bszap, HBCB* binp,
    vp->mode.fl.use_dc = OFF;
    vp->tcp   = tc;
 
-   /* initialize block pools, if enabled */
-   #if EH_BP
-   bp_init(hn);
-   #endif
-
    /* initialize dc */
    if (dcsz < 24)
    {
@@ -928,9 +1503,6 @@ u32 eh_Init(u32 sz, u32 dcsz, u8* hp, EHV_PTR vp, u32* bszap, HBCB* binp,
 
    /* initialize vp pointers */
    vp->dcp   = dc;
-   #if EH_BP
-   vp->fhcp  = dc;
-   #endif
 
    /* set user-modifiable heap flags */
    hmode.wd = mode;
@@ -963,6 +1535,11 @@ u32 eh_Init(u32 sz, u32 dcsz, u8* hp, EHV_PTR vp, u32* bszap, HBCB* binp,
    for ( ; vp->bszap[i+1] < 0xFFFFFFFF; i++){}
    vp->top_bin = i;
 
+   #if EH_TLSF
+   /* check for TLSF upper bin layout */
+   vp->ubf0 = bin_tlsf(hn);
+   #endif
+
    /* clear the bin array and bin map */
    memset((void*)vp->binp, 0, 8*(vp->top_bin + 1));
    vp->bmap = 0;
@@ -973,7 +1550,17 @@ u32 eh_Init(u32 sz, u32 dcsz, u8* hp, EHV_PTR vp, u32* bszap, HBCB* binp,
    /* initialize heap scan pointer to start of heap */
    vp->hsp = (CCB_PTR)sc;
 
-   /* initialize bin sorting */
+   #if EH_HANDLES
+   /* start compaction at start of heap */
+   vp->cmp = NULL;
+   #endif
+
+   #if EH_BUDDY
+   /* no buddy arena until eh_BuddyInit() */
+   vp->bdap = NULL;
+   #endif
+
+   /* initialize bin sorting */
    vp->csbin = -1;
    vp->bsmap = 0;
 
@@ -1003,7 +1590,14 @@ u32 eh_Init(u32 sz, u32 dcsz, u8* hp, EHV_PTR vp, u32* bszap, HBCB* binp,
    vp->hused = 32;
    vp->mode  = hmode;
    vp->name  = name;
+   vp->rinpl = 0;
+   vp->rmove = 0;
    vp->tbsz  = 0;
+
+   /* initialize block pools, if enabled */
+   #if EH_BP
+   bp_init(hn);
+   #endif
    return hn;
 }
 
@@ -1035,13 +1629,9 @@ void* eh_Malloc(u32 sz, u32 an, u32 hn)
    eh_hvp[hn]->errno = EH_OK;
 
    #if EH_BP
-   if (sz <= 12)
-   {
-      if (bp = bp_malloc(sz, an, hn))
-      {
-         return bp;
-      }
-   }
+   /* get block from block pool, if sz fits one */
+   if ((bp = bp_malloc(sz, an, hn)) != NULL)
+      return bp;
    #endif
 
    hmode = eh_hvp[hn]->mode;
@@ -1101,6 +1691,11 @@ retry:
       else /* or try to get from best-fit UBA bin */
       {
          i = bin_find(csz, hn);
+         #if EH_TLSF
+         /* good fit: any chunk in the next larger bin is big enough <6> */
+         if (csz > eh_hvp[hn]->bszap[i] && i < eh_hvp[hn]->top_bin)
+            i++;
+         #endif
          bmap >>= i;
 
          /* search bin[i] for first large-enough chunk */
@@ -1134,6 +1729,12 @@ retry:
             cp = eh_hvp[hn]->tcp;
             eh_hvp[hn]->tcp = chunk_split(cp, csz, hn); /* split from tc */
          } 
+         #if EH_TLSF
+         else if (csz > eh_hvp[hn]->sba_top_sz && (cp = bin_ff(csz, hn)) != NULL)
+         {
+            /* got first fit from bin skipped by good fit, rather than fail */
+         }
+         #endif
          else /* chunk not found in heap */
          {
             /* try auto-recovery if enabled */
@@ -1186,7 +1787,12 @@ retry:
 
    /* load debug information, if enabled */
    if (hmode.fl.debug)
+   {
       debug_load(cp);
+      #if EH_OSTATS
+      os_count((CDCB_PTR)cp, cp->sz, 1, hn);
+      #endif
+   }
 
    /* update heap_used and heap_hwm (must be ahead of block fill) */
    eh_hvp[hn]->hused += cp->sz;
@@ -1249,6 +1855,116 @@ retry:
    return bp;
 }
 
+/*
+*  eh_MallocM()
+*
+*  Allocates n blocks of sizes szp[0] thru szp[n-1] and loads their pointers 
+*  into bpp[]. If possible, gets one chunk for all of them and splits it into
+*  n chunks, so that the search is done once and the blocks are contiguous. 
+*  Otherwise, allocates them one at a time. Each chunk is a normal chunk, 
+*  with its own debug information and fences, if in debug mode. Either all 
+*  blocks are allocated or none are. <22>
+*/
+bool eh_MallocM(const u32* szp, u32 n, void** bpp, u32 hn)
+{
+   void*    bp;      /* block pointer */
+   CCB_PTR  cp;      /* chunk pointer */
+   u32      csz;     /* chunk size */
+   u32      flags;   /* big chunk flags */
+   u32      i;
+   CCB_PTR  ncp;     /* next chunk pointer */
+   u32      nobp;    /* nobp save */
+   u32      tsz = 0; /* total chunk size */
+
+   if (szp == NULL || bpp == NULL || n == 0)
+   {
+      eh_error(EH_INV_PAR, 2, hn);
+      return false;
+   }
+   for (i = 0; i < n; i++)
+   {
+      if (szp[i] == 0 || szp[i] > eh_hvp[hn]->hsz)
+      {
+         eh_error(EH_INSUFF_HEAP, 2, hn);
+         return false;
+      }
+      if (tsz <= eh_hvp[hn]->hsz)
+         tsz += (szp[i] < 16 ? 16 : (szp[i] + 7)&0xFFFFFFF8) + EH_CHK_OVH;
+   }
+
+   /* get one chunk for all blocks and split it */
+   bp = NULL;
+   if (n > 1 && tsz <= eh_hvp[hn]->hsz)
+   {
+      nobp = eh_hvp[hn]->mode.fl.nobp;
+      eh_hvp[hn]->mode.fl.nobp = ON;
+      bp = eh_Malloc(tsz - EH_CHK_OVH, 0, hn);
+      eh_hvp[hn]->mode.fl.nobp = nobp;
+   }
+   if (bp != NULL)
+   {
+      cp = (CCB_PTR)((u32)bp - EH_BP_OFFS);
+      flags = (u32)cp->blf & EH_FLAGS;
+      #if EH_OSTATS
+      if (flags & EH_DEBUG)
+         os_count((CDCB_PTR)cp, -(s32)cp->sz, -1, hn);
+      #endif
+      for (i = 0; i < n; i++, cp = ncp)
+      {
+         /* split next chunk off of cp; last chunk keeps any spare space */
+         if (i < n - 1)
+         {
+            csz = (szp[i] < 16 ? 16 : (szp[i] + 7)&0xFFFFFFF8) + EH_CHK_OVH;
+            ncp = chunk_split(cp, csz, hn);
+            ncp->blf = (CCB_PTR)((u32)cp | flags);
+            cp->blf  = (CCB_PTR)((u32)cp->blf & ~EH_SSP);
+         }
+         bpp[i] = (void*)((u32)cp + EH_BP_OFFS);
+         if (flags & EH_DEBUG)
+         {
+            debug_load(cp);
+            #if EH_OSTATS
+            os_count((CDCB_PTR)cp, cp->sz, 1, hn);
+            #endif
+         }
+         else  /* sz is the first data word */
+            cp->sz = (eh_hvp[hn]->mode.fl.fill ? EH_DATA_FILL : 0);
+      }
+      return true;
+   }
+
+   /* or allocate blocks one at a time */
+   for (i = 0; i < n; i++)
+   {
+      if ((bpp[i] = eh_Malloc(szp[i], 0, hn)) == NULL)
+      {
+         /* free blocks already allocated */
+         while (i > 0)
+         {
+            eh_Free(bpp[--i], hn);
+            bpp[i] = NULL;
+         }
+         eh_error(EH_INSUFF_HEAP, 2, hn);
+         return false;
+      }
+   }
+   return true;
+}
+
+#if EH_OSTATS
+/*
+*  eh_OwnerPeek()
+*
+*  Returns the number of chunks (EH_PK_COUNT), the bytes (EH_PK_SPACE), or 
+*  the maximum bytes (EH_PK_MAXUSE) held by owner onr, which is a task or LSR
+*  handle. Returns 0 if onr holds no debug chunks. <18>
+*/
+u32 eh_OwnerPeek(u32 onr, EH_PK_PAR par, u32 hn)
+{
+   return os_peek(eh_hvp[hn]->osp, eh_hvp[hn]->osn, onr, par, hn);
+}
+#endif
+
 /*
 *  eh_Peek()
 *
@@ -1282,9 +1998,24 @@ u32 eh_Peek(EH_PK_PAR par, u32 hn)
       case EH_PK_INIT:
          val = hmode.fl.init;
          break;
+      case EH_PK_INUSE:
+         val = eh_hvp[hn]->hused;
+         break;
+      case EH_PK_MAXUSE:
+         val = eh_hvp[hn]->hhwm;
+         break;
       case EH_PK_MERGE:
          val = hmode.fl.cmerge;
          break;
+      case EH_PK_REALLOC_IP:
+         val = eh_hvp[hn]->rinpl;
+         break;
+      case EH_PK_REALLOC_MV:
+         val = eh_hvp[hn]->rmove;
+         break;
+      case EH_PK_SIZE:
+         val = eh_hvp[hn]->hsz;
+         break;
       case EH_PK_USE_DC:
          val = hmode.fl.use_dc;
          break;
@@ -1295,12 +2026,193 @@ u32 eh_Peek(EH_PK_PAR par, u32 hn)
    return val;
 }
 
+#if EH_BP
+/*
+*  eh_PoolGet()
+*
+*  Gets a block from the smallest block pool that fits sz, if its free list is 
+*  not empty. Does not add slabs. Returns NULL if no block is available.
+*  Lock-free if USE_LDREX.
+*/
+void* eh_PoolGet(u32 sz, u32 an, u32 hn)
+{
+   BPCB_PTR bpcbp;
+
+   if (sz == 0 || (bpcbp = bp_find(sz, an, hn)) == NULL)
+      return NULL;
+   return bp_get(bpcbp);
+}
+
+/*
+*  eh_PoolPeek()
+*
+*  Returns information concerning block pool pn.
+*/
+u32 eh_PoolPeek(u32 pn, EH_PK_PAR par, u32 hn)
+{
+   BPCB_PTR bpcbp;
+   u32      val = 0; /* value returned */
+
+   /* check for invalid parameter */
+   if (eh_hvp[hn]->bpcbp == NULL || pn >= eh_hvp[hn]->bpnum)
+   {
+      eh_error(EH_INV_PAR, 1, hn);
+      return -1;
+   }
+   eh_hvp[hn]->errno = EH_OK;
+   bpcbp = eh_hvp[hn]->bpcbp + pn;
+
+   switch (par)
+   {
+      case EH_PK_COUNT:
+         val = bpcbp->num_slabs*BP_NBS(bpcbp->bsz) - bpcbp->inuse;
+         break;
+      case EH_PK_INUSE:
+         val = bpcbp->inuse;
+         break;
+      case EH_PK_MAXUSE:
+         val = bpcbp->maxuse;
+         break;
+      case EH_PK_SIZE:
+         val = bpcbp->bsz;
+         break;
+      case EH_PK_SLABS:
+         val = bpcbp->num_slabs;
+         break;
+      case EH_PK_SPACE:
+         val = bpcbp->num_slabs*EH_BP_SLAB;
+         break;
+      default:
+         eh_error(EH_INV_PAR, 1, hn);
+         val = -1;
+   }
+   return val;
+}
+
+/*
+*  eh_PoolRel()
+*
+*  Releases a block to its block pool. Returns false if bp is not a valid block
+*  pool block. Lock-free if USE_LDREX, except for EH_OSTATS counts. <8>
+*/
+bool eh_PoolRel(void* bp, u32 hn)
+{
+   BPCB_PTR bpcbp;
+   u32      offs;  /* offset of bp in its slab */
+
+   if ((bpcbp = bp_slab(bp, hn)) == NULL)
+      return false;
+   offs = (u32)bp & (EH_BP_SLAB - 1);
+   if (offs % bpcbp->bsz != 0 || offs > EH_BP_SLAB - bpcbp->bsz
+                              || offs < BP_RSV(bpcbp->bsz)*bpcbp->bsz)
+      return false;
+
+   #if EH_OSTATS
+   os_bpcount(bp, bpcbp->bsz, -1, hn);
+   #endif
+   bp_push(&bpcbp->pn, bp, bp);
+   bp_add(&bpcbp->inuse, -1);
+   return true;
+}
+
+/*
+*  eh_PoolTrim()
+*
+*  Frees block pool slabs that have no blocks in use back to the heap, except
+*  for one per pool. Detaches each pool free list, counts its free blocks per 
+*  slab in the slab map, puts back blocks of slabs that are in use, then frees
+*  the empty slabs. Returns true if any slab was freed. <15>
+*/
+bool eh_PoolTrim(u32 hn)
+{
+   void*    bp;      /* block pointer */
+   BPCB_PTR bpcbp;   /* block pool control block pointer */
+   void*    fbp;     /* first kept block pointer */
+   bool     freed;   /* a slab has been freed */
+   u32      i;       /* slab map index */
+   bool     keep;    /* keep next empty slab */
+   void*    lbp;     /* last kept block pointer */
+   u16*     map;     /* slab map */
+   u32      nbs;     /* number of blocks per slab */
+   void*    nbp;     /* next block pointer */
+   u32      pn;      /* pool number */
+
+   eh_hvp[hn]->errno = EH_OK;
+   map   = eh_hvp[hn]->bpmap;
+   freed = false;
+   if (map == NULL)
+      return false;
+
+   for (pn = 0; pn < eh_hvp[hn]->bpnum; pn++)
+   {
+      bpcbp = eh_hvp[hn]->bpcbp + pn;
+      if (bpcbp->num_slabs < 2)
+         continue;
+      nbs = BP_NBS(bpcbp->bsz);
+
+      /* detach free list and count free blocks per slab */
+      bp = bp_detach(&bpcbp->pn);
+      for (nbp = bp; nbp != NULL; nbp = *(void**)nbp)
+         map[BP_MAPX(nbp)] += 0x10;
+
+      /* keep the first empty slab */
+      for (i = 0, keep = true; i < eh_hvp[hn]->bpmapn && keep; i++)
+      {
+         if ((map[i] & 0xF) == pn + 1 && (map[i] >> 4) == nbs)
+         {
+            map[i] &= 0xF;
+            keep = false;
+         }
+      }
+
+      /* put back blocks that are not in empty slabs */
+      for (fbp = lbp = NULL; bp != NULL; bp = nbp)
+      {
+         nbp = *(void**)bp;
+         if ((map[BP_MAPX(bp)] >> 4) != nbs)
+         {
+            if (lbp == NULL)
+               fbp = bp;
+            else
+               *(void**)lbp = bp;
+            lbp = bp;
+         }
+      }
+      if (lbp != NULL)
+         bp_push(&bpcbp->pn, fbp, lbp);
+
+      /* free empty slabs and clear counts */
+      for (i = 0; i < eh_hvp[hn]->bpmapn; i++)
+      {
+         if ((map[i] & 0xF) == pn + 1)
+         {
+            if ((map[i] >> 4) == nbs)
+            {
+               map[i] = 0;
+               eh_Free((void*)((((u32)eh_hvp[hn]->pi >> EH_BP_SLAB_AN) + i) 
+                                                     << EH_BP_SLAB_AN), hn);
+               bpcbp->num_slabs--;
+               freed = true;
+            }
+            else
+            {
+               map[i] &= 0xF;
+            }
+         }
+      }
+   }
+   return freed;
+}
+#endif /* EH_BP */
+
 /*
 *  eh_Realloc()
 *
 *  Allocates a new size heap block from an existing heap block, if possible.
 *  Conforms to ANSI C Standard. Preserves debug mode, but temporarily suspends
-*  fill mode, if it is set.
+*  fill mode, if it is set. A block that grows is first extended in place into
+*  the next chunk, if that chunk is free and big enough. A block that shrinks
+*  is split in place. Otherwise, the block is moved. <16>
 */
 void* eh_Realloc(void* cbp, u32 sz, u32 an, u32 hn)
 {
@@ -1311,6 +2223,7 @@ void* eh_Realloc(void* cbp, u32 sz, u32 an, u32 hn)
    u32      data_sav[7];   /* save first 4 words of data block and last 3 of CDCB */
    u32*     dp;            /* data pointer for copying data */
    u32      flags_sav;     /* current chunk flags save */
+   CCB_PTR  fl_sav;        /* current chunk forward link save */
    HMODE    hmode;         /* internal heap mode */
    u32      i;             /* index */
    void*    nbp;           /* new block pointer */
@@ -1328,6 +2241,19 @@ void* eh_Realloc(void* cbp, u32 sz, u32 an, u32 hn)
       return NULL;
    }
 
+   #if EH_BP
+   if (bp_slab(cbp, hn) != NULL)
+      return bp_realloc(cbp, sz, an, hn);
+   #endif
+
+   #if EH_BUDDY
+   if (BD_IN(cbp))
+   {
+      eh_error(EH_INV_PAR, 2, hn);  /* buddy blocks cannot be reallocated */
+      return NULL;
+   }
+   #endif
+
    pi = (CCB_PTR)eh_hvp[hn]->pi;
    px = (CCB_PTR)eh_hvp[hn]->px;
 
@@ -1349,8 +2275,9 @@ void* eh_Realloc(void* cbp, u32 sz, u32 an, u32 hn)
    ncp = NULL;
    amask = ~(0xFFFFFFFF << an);
 
-   /* turn fill mode off */
+   /* turn fill mode off and keep eh_Malloc() out of block pools <14> */
    eh_hvp[hn]->mode.fl.fill = OFF;
+   eh_hvp[hn]->mode.fl.nobp = ON;
 
    /* round block size to 16-bytes or next 8-byte boundary */
    if (sz < 16)
@@ -1361,6 +2288,11 @@ void* eh_Realloc(void* cbp, u32 sz, u32 an, u32 hn)
    /* determine needed and current chunk sizes */
    csz = sz + EH_CHK_OVH;
    ccsz = (u32)ccp->fl - (u32)ccp;
+   fl_sav = ccp->fl;
+
+   /* grow current chunk in place, if possible */
+   if (csz > ccsz && !((u32)cbp & amask) && chunk_grow(ccp, csz, hn))
+      ccsz = (u32)ccp->fl - (u32)ccp;
 
    /* need different chunk if too small or not aligned enough */
    if (csz > ccsz || (u32)cbp & amask)
@@ -1411,10 +2343,14 @@ void* eh_Realloc(void* cbp, u32 sz, u32 an, u32 hn)
             dp = (u32*)ccp + 3;
             for (; i < 7; i++)
                *dp++ = data_sav[i];
+            #if EH_OSTATS
+            /* recount chunk, which eh_Free() uncounted */
+            os_count((CDCB_PTR)ccp, (u32)ccp->fl - (u32)ccp, 1, hn);
+            #endif
          }
       }
    }
-   else /* current chunk is sufficient */
+   else /* current chunk is sufficient or has been grown */
    {
       /* split current chunk, if big enough, merge remnant with upper free 
          chunk, if any, put new free chunk into a bin, unless it is dc or tc,
@@ -1440,7 +2376,33 @@ void* eh_Realloc(void* cbp, u32 sz, u32 an, u32 hn)
          if (ncp != eh_hvp[hn]->dcp && ncp != eh_hvp[hn]->tcp)
             bin_nq(ncp, hn);
       }
+
+      /* if chunk end moved, drop spare space pointer and reload debug info */
+      if (ccp->fl != fl_sav)
+      {
+         ccp->blf = (CCB_PTR)((u32)ccp->blf & ~EH_SSP);
+         if (DEBUG_CHK(cbp))
+         {
+            #if EH_OSTATS
+            CDCB dcb = *(CDCB_PTR)ccp;  /* old owner and site */
+            #endif
+            ccp->sz = (u32)ccp->fl - (u32)ccp;
+            debug_load(ccp);
+            #if EH_OSTATS
+            /* count new size, then uncount old, so a held entry is kept */
+            os_count((CDCB_PTR)ccp, ccp->sz, 1, hn);
+            os_count(&dcb, -(s32)((u32)fl_sav - (u32)ccp), -1, hn);
+            #endif
+         }
+      }
    }
+
+   /* update realloc counters */
+   if (nbp == cbp)
+      eh_hvp[hn]->rinpl++;
+   else if (nbp != NULL)
+      eh_hvp[hn]->rmove++;
+
    eh_hvp[hn]->mode = hmode; /* restore fill mode */
    return nbp;
 }
@@ -1587,6 +2549,11 @@ bool  eh_Recover(u32 sz, u32 num, u32 an, u32 hn)
       eh_hvp[hn]->hsp = NULL;
       eh_hvp[hn]->mode.fl.hs_fwd = ON;
 
+      #if EH_HANDLES
+      /* restart compaction */
+      eh_hvp[hn]->cmp = NULL;
+      #endif
+
       return true;
    }
    else
@@ -1715,13 +2682,17 @@ bool eh_Scan(CCB_PTR cp, u32 fnum, u32 bnum, u32 hn)
       {
          #if defined(EH_BT_DEBUG) || defined(SMX_DEBUG)
          /* report broken lower fences */
-         fp = (u32*)cp + 5;
-         for (n = EH_NUM_FENCES + 1; n > 0; n--, fp++)
+         fp = (u32*)cp + sizeof(CDCB)/4;
+         if (((CDCB_PTR)cp)->fence != EH_FENCE_FILL)
+            fp = NULL;
+         for (n = EH_NUM_FENCES; n > 0 && fp != NULL; n--, fp++)
             if (*fp != EH_FENCE_FILL)
-            {
-               eh_error(EH_HEAP_FENCE_BRKN, 1, hn);
-               return true;
-            }
+               fp = NULL;
+         if (fp == NULL)
+         {
+            eh_error(EH_HEAP_FENCE_BRKN, 1, hn);
+            return true;
+         }
          /* report broken upper fences */
          if ((u32)cp->blf & EH_SSP)
             fp = (u32*)(*((u32*)cp->fl - 1)) - EH_NUM_FENCES;
@@ -1735,8 +2706,13 @@ bool eh_Scan(CCB_PTR cp, u32 fnum, u32 bnum, u32 hn)
             }
          #else
          /* fix broken lower fences */
-         fp = (u32*)cp + 5;
-         for (n = EH_NUM_FENCES + 1; n > 0; n--, fp++)
+         if (((CDCB_PTR)cp)->fence != EH_FENCE_FILL)
+         {
+            ((CDCB_PTR)cp)->fence = EH_FENCE_FILL;
+            eh_error(EH_HEAP_FIXED, 1, hn);
+         }
+         fp = (u32*)cp + sizeof(CDCB)/4;
+         for (n = EH_NUM_FENCES; n > 0; n--, fp++)
             if (*fp != EH_FENCE_FILL)
             {
                *fp = EH_FENCE_FILL;
@@ -1814,6 +2790,76 @@ bool eh_Set(EH_ST_PAR par, u32 val, u32 hn)
    return true;
 }
 
+#if EH_OSTATS
+/*
+*  eh_SitePeek()
+*
+*  Returns the number of chunks (EH_PK_COUNT), the bytes (EH_PK_SPACE), or 
+*  the maximum bytes (EH_PK_MAXUSE) held by call site site, which is the 
+*  return address of a heap API call. Returns 0 if site holds no debug 
+*  chunks. <18>
+*/
+u32 eh_SitePeek(u32 site, EH_PK_PAR par, u32 hn)
+{
+   return os_peek(eh_hvp[hn]->ssp, eh_hvp[hn]->ssn, site, par, hn);
+}
+#endif
+
+#if EH_TRACE
+/*
+*  eh_Trace()
+*
+*  Records a heap operation in the trace ring, if tracing is on. Called by the
+*  heap API layer after the operation. Reentrant, if USE_LDREX. <17>
+*/
+void eh_Trace(EH_TR_OP op, void* bp, void* cbp, u32 sz, u32 an, u32 hn)
+{
+   u32      i;
+   EHTR_PTR trp = eh_trp;
+
+   if (trp == NULL)
+      return;
+
+   /* reserve next record */
+   #if USE_LDREX
+   do
+      i = __LDREX((unsigned long*)&eh_tri);
+   while (__STREX(i + 1, (unsigned long*)&eh_tri));
+   #else
+   i = eh_tri++;
+   #endif
+   trp += i & (eh_trn - 1);
+
+   trp->time = eh_time();
+   trp->bp   = (u32)bp;
+   trp->cbp  = (u32)cbp;
+   trp->sz   = sz;
+   trp->op   = (u8)op;
+   trp->an   = (u8)(an & ~EH_R);
+   trp->hn   = (u8)hn;
+   trp->pad  = 0;
+}
+
+/*
+*  eh_TraceInit()
+*
+*  Starts tracing into a ring of num records at trp, or stops it if trp is
+*  NULL or num is 0. num is rounded down to a power of 2.
+*/
+void eh_TraceInit(EHTR_PTR trp, u32 num)
+{
+   u32 n;
+
+   eh_trp = NULL;
+   if (trp == NULL || num == 0)
+      return;
+   for (n = 1; n <= num/2; n <<= 1) {}
+   eh_trn = n;
+   eh_tri = 0;
+   eh_trp = trp;
+}
+#endif /* EH_TRACE */
+
 /*===========================================================================*
 *                       ALIGNED ALLOCATION SUBROUTINES                       *
 *                           Do Not Call Directly                             *
@@ -2026,6 +3072,10 @@ static CCB_PTR merge_space(CCB_PTR cp, u32 d, u32 hn)
       eh_hvp[hn]->hsp = pcp;
    if (eh_hvp[hn]->hfp == cp)
       eh_hvp[hn]->hfp = pcp;
+   #if EH_HANDLES
+   if (eh_hvp[hn]->cmp == cp)
+      eh_hvp[hn]->cmp = pcp;
+   #endif
 
    if (EH_IS_FREE(pcp) && (pcp != eh_hvp[hn]->dcp)) /* prechunk is free and not dc*/
    {
@@ -2331,139 +3381,320 @@ static CCB_PTR aligned_srch(u32 csz, u32 an, u32 hn)
 *===========================================================================*/
 #if EH_BP
 /*
-*  bp_free()
-*
-*  Frees a block previously allocated from a block pool.
+*  bp_add() -- Add n to *cp, atomically if USE_LDREX.
 */
-static bool bp_free(void* bp, u32 hn)
+static void bp_add(u32* cp, s32 n)
 {
-   BPCB_PTR bpcbp;   /* block pool control block pointer */
+#if USE_LDREX
+   u32 c;
+   do
+      c = __LDREX((unsigned long*)cp);
+   while (__STREX(c + n, (unsigned long*)cp));
+#else
+   *cp += n;
+#endif
+}
 
-   /* return if bpcbp is NULL */
-   bpcbp = eh_hvp[hn]->bpcbp;
-   if (bpcbp == NULL)
-   {
-      return false;
-   }
+/*
+*  bp_detach() -- Detach free list, atomically if USE_LDREX, and return it.
+*/
+static void* bp_detach(void** lp)
+{
+   void* bp;
+#if USE_LDREX
+   do
+      bp = (void*)__LDREX((unsigned long*)lp);
+   while (__STREX(NULL, (unsigned long*)lp));
+#else
+   bp = *lp;
+   *lp = NULL;
+#endif
+   return bp;
+}
 
-   if (bp <= bpcbp->px) /* bp in pb8 */
-   {
-      *(u32*)bp = (u32)bpcbp->pn;
-      bpcbp->pn = bp;
-      bpcbp->inuse--;
-   }
-   else /* bp in pb12 */
-   {
-      bpcbp++;
-      *(u32*)bp = (u32)bpcbp->pn;
-      bpcbp->pn = bp;
-      bpcbp->inuse--;
-   }
-   return true;
+/*
+*  bp_find() -- Find smallest block pool with blocks >= sz. Returns NULL if
+*  none, or if an > 3 or block pools are not in use.
+*/
+static BPCB_PTR bp_find(u32 sz, u32 an, u32 hn)
+{
+   BPCB_PTR bpcbp = eh_hvp[hn]->bpcbp;
+   u32      n;
+
+   if (bpcbp == NULL || an > 3 || !eh_hvp[hn]->mode.fl.init 
+                               || eh_hvp[hn]->mode.fl.nobp)
+      return NULL;
+   for (n = eh_hvp[hn]->bpnum; n > 0; n--, bpcbp++)
+      if (sz <= bpcbp->bsz)
+         return bpcbp;
+   return NULL;
 }
 
 /*
-*  bp_init() -- Create and initialize block pools if enabled.
+*  bp_get() -- Get block from block pool free list and update inuse and 
+*  maxuse. Returns NULL if free list is empty.
 */
-static void bp_init(u32 hn)
+static void* bp_get(BPCB_PTR bpcbp)
 {
-   u32** bp;         /* pointer to block pointer in block */
-   u32   bsz;        /* block size */
-   u32   i;          /* pool index */
-   u32   n;          /* number of blocks / reverse block index */
-   u32*  nbp;        /* next block pointer */
-   u32   psz;        /* pool size */
-   BPCB_PTR bpcbp;   /* block pool control block pointer */
+   void* bp;
 
-   /* create pools */
-   if (eh_hvp[hn]->bpcbp)
+   if ((bp = bp_pop(&bpcbp->pn)) != NULL)
    {
-      for (i = 0; i < 2; i++)
-      {
-         bpcbp = eh_hvp[hn]->bpcbp + i;
-         n     = bpcbp->num_blks;
-         if (n > 0)
-         {
-            /* allocate pool from heap */
-            bsz  = 4 * i + 8;
-            psz  = bsz * n;
-            if ((bpcbp->pn = (u8*)eh_Malloc(psz, 3, hn)) == NULL)
-            {
-               return;
-            }
-
-            /* clear pool and link all of its blocks together */
-            memset (bpcbp->pn, 0, psz);
-            for (bp = (u32**)bpcbp->pn; n > 1; n--)
-            {
-               nbp = (u32*)((u32)bp + bsz);
-               *bp = nbp;
-               bp  = (u32**)nbp;
-            }
-            *bp = NULL; /* last block has NULL pointer */
-
-            /* initialize block pool control block */
-            bpcbp->inuse  = 0;
-            bpcbp->maxuse = 0;
-            bpcbp->pi = bpcbp->pn;
-            bpcbp->px = (void*)((u8*)bpcbp->pi + psz - bsz);
-         }
-         else
-         {
-            bpcbp->pn = 0;
-         }
-      }
+      bp_add(&bpcbp->inuse, 1);
+      if (bpcbp->inuse > bpcbp->maxuse)
+         bpcbp->maxuse = bpcbp->inuse; /* not atomic -- for info only */
    }
+   return bp;
 }
 
 /*
-*  bp_malloc() -- Allocate block from block pool.
+*  bp_init() -- Check and initialize block pools, if any, and allocate and 
+*  clear slab map. Block pools are disabled if anything is wrong.
 */
-static void* bp_malloc(u32 sz, u32 an, u32 hn)
+static void bp_init(u32 hn)
 {
-   void*    bp;      /* pointer to next block in pool */
    BPCB_PTR bpcbp;   /* block pool control block pointer */
+   u32      i, n;
+   u32      psz;     /* previous block size */
 
+   eh_hvp[hn]->bpmap  = NULL;
+   eh_hvp[hn]->bpmapn = 0;
    bpcbp = eh_hvp[hn]->bpcbp;
+   if (bpcbp == NULL)
+      return;
 
-   /* return if alignment > 8 or bpcbp is NULL */
-   if (an > 3 || bpcbp == NULL)
+   /* check block sizes and clear pool control blocks */
+   n = eh_hvp[hn]->bpnum;
+   if (n == 0 || n > EH_BP_MAX)
    {
-      return NULL;
+      eh_hvp[hn]->bpcbp = NULL;
+      return;
    }
-   if (sz <= 8) /* get block from 8-byte pool */
+   for (i = 0, psz = 0; i < n; i++, bpcbp++)
    {
-      if ((bp = bpcbp->pn) != NULL)
+      bpcbp->bsz = (bpcbp->bsz + 7)&0xFFFFFFF8;
+      if (bpcbp->bsz <= psz || bpcbp->bsz > EH_BP_SLAB/4)
       {
-         bpcbp->pn = *(void**)bp;
+         eh_hvp[hn]->bpcbp = NULL;
+         return;
       }
+      psz = bpcbp->bsz;
+      bpcbp->inuse     = 0;
+      bpcbp->maxuse    = 0;
+      bpcbp->num_slabs = 0;
+      bpcbp->pn        = NULL;
    }
-   else /* get block from 12-byte pool */
+
+   /* allocate and clear slab map for the heap */
+   n = BP_MAPX(eh_hvp[hn]->px) + 1;
+   eh_hvp[hn]->mode.fl.nobp = ON;
+   eh_hvp[hn]->bpmap = (u16*)eh_Malloc(2*n, 0, hn);
+   eh_hvp[hn]->mode.fl.nobp = OFF;
+   if (eh_hvp[hn]->bpmap == NULL)
    {
-      if ((bp = (++bpcbp)->pn) != NULL)
-      {
-         if (an <= 2 || (u32)bp & 0x7 == 0)
-         {
-            bpcbp->pn = *(void**)bp;
-         }
-         else
-         {
-            bp = NULL;
-         }
-      }
+      eh_hvp[hn]->bpcbp = NULL;
+      eh_hvp[hn]->errno = EH_OK; /* heap is ok without block pools */
+      return;
    }
+   memset(eh_hvp[hn]->bpmap, 0, 2*n);
+   eh_hvp[hn]->bpmapn = n;
+}
 
-   /* update inuse and maxuse */
+/*
+*  bp_malloc() -- Allocate block from smallest block pool that fits sz. Adds a
+*  slab to the pool if its free list is empty. Returns NULL if there is no such
+*  pool or no slab can be added, so that a chunk is allocated, instead.
+*/
+static void* bp_malloc(u32 sz, u32 an, u32 hn)
+{
+   void*    bp;      /* block pointer */
+   BPCB_PTR bpcbp;   /* block pool control block pointer */
+
+   if ((bpcbp = bp_find(sz, an, hn)) == NULL)
+      return NULL;
+   if ((bp = bp_get(bpcbp)) == NULL && bp_refill(bpcbp, hn))
+      bp = bp_get(bpcbp);
+   #if EH_OSTATS
    if (bp != NULL)
+      os_bpcount(bp, bpcbp->bsz, 1, hn);
+   #endif
+   return bp;
+}
+
+/*
+*  bp_pop() -- Pop first block from free list, atomically if USE_LDREX. <15>
+*/
+static void* bp_pop(void** lp)
+{
+   void* bp;
+#if USE_LDREX
+   do
    {
-      bpcbp->inuse++;
-      if (bpcbp->inuse > bpcbp->maxuse)
+      bp = (void*)__LDREX((unsigned long*)lp);
+      if (bp == NULL)
       {
-         bpcbp->maxuse = bpcbp->inuse;
+         __CLREX();
+         break;
       }
-   }
+   } while (__STREX((unsigned long)*(void**)bp, (unsigned long*)lp));
+#else
+   if ((bp = *lp) != NULL)
+      *lp = *(void**)bp;
+#endif
    return bp;
 }
+
+/*
+*  bp_push() -- Push linked blocks fbp thru lbp onto free list, atomically if
+*  USE_LDREX.
+*/
+static void bp_push(void** lp, void* fbp, void* lbp)
+{
+#if USE_LDREX
+   do
+      *(void**)lbp = (void*)__LDREX((unsigned long*)lp);
+   while (__STREX((unsigned long)fbp, (unsigned long*)lp));
+#else
+   *(void**)lbp = *lp;
+   *lp = fbp;
+#endif
+}
+
+/*
+*  bp_realloc() -- Reallocate block pool block. Returns the same block if it
+*  is big enough. Otherwise, gets a new block, copies the old block to it, and
+*  releases the old block. If a new block cannot be allocated, returns NULL 
+*  and the old block is unchanged.
+*/
+static void* bp_realloc(void* cbp, u32 sz, u32 an, u32 hn)
+{
+   BPCB_PTR bpcbp = bp_slab(cbp, hn);
+   void*    nbp;
+
+   if (sz <= bpcbp->bsz && an <= 3)
+      return cbp;
+   if ((nbp = eh_Malloc(sz, an, hn)) != NULL)
+   {
+      memcpy(nbp, cbp, (sz < bpcbp->bsz ? sz : bpcbp->bsz));
+      eh_PoolRel(cbp, hn);
+   }
+   return nbp;
+}
+
+/*
+*  bp_refill() -- Allocate a slab aligned on EH_BP_SLAB, map it to the block 
+*  pool, and put its blocks into the pool free list. Returns false if a slab
+*  cannot be allocated.
+*/
+static bool bp_refill(BPCB_PTR bpcbp, u32 hn)
+{
+   u8*   bp;    /* block pointer */
+   u32   bsz;   /* block size */
+   u32   i;     /* slab map index */
+   u32   n;     /* number of blocks */
+   u8*   sp;    /* slab pointer */
+  #if EH_OSTATS
+   u32   dbg;   /* debug mode */
+  #endif
+
+   if (eh_hvp[hn]->bpmap == NULL)
+      return false;
+
+  #if EH_OSTATS
+   /* the slab is not a debug chunk, so only its blocks are counted <8> */
+   dbg = eh_hvp[hn]->mode.fl.debug;
+   eh_hvp[hn]->mode.fl.debug = OFF;
+   sp = (u8*)eh_Malloc(EH_BP_SLAB, EH_BP_SLAB_AN, hn);
+   eh_hvp[hn]->mode.fl.debug = dbg;
+  #else
+   sp = (u8*)eh_Malloc(EH_BP_SLAB, EH_BP_SLAB_AN, hn);
+  #endif
+   if (sp == NULL)
+   {
+      eh_hvp[hn]->errno = EH_OK; /* eh_Malloc() will use a chunk */
+      return false;
+   }
+
+   /* do not use slabs in heap extensions, which are not mapped */
+   i = BP_MAPX(sp);
+   if (i >= eh_hvp[hn]->bpmapn)
+   {
+      eh_Free(sp, hn);
+      return false;
+   }
+   eh_hvp[hn]->bpmap[i] = (u16)(bpcbp - eh_hvp[hn]->bpcbp + 1);
+
+   /* link slab blocks together and put them into the pool free list */
+   bsz = bpcbp->bsz;
+  #if EH_OSTATS
+   /* clear owner and site indices in the first blocks */
+   memset(sp, 0, BP_RSV(bsz)*bsz);
+   sp += BP_RSV(bsz)*bsz;
+  #endif
+   for (bp = sp, n = BP_NBS(bsz); n > 1; n--, bp += bsz)
+      *(u8**)bp = bp + bsz;
+   bp_push(&bpcbp->pn, sp, bp);
+   bpcbp->num_slabs++;
+   return true;
+}
+
+/*
+*  bp_slab() -- Return block pool control block pointer for the slab that bp
+*  is in, or NULL if bp is not in a slab.
+*/
+static BPCB_PTR bp_slab(void* bp, u32 hn)
+{
+   u32 i, pn;
+
+   if (eh_hvp[hn]->bpmap == NULL)
+      return NULL;
+   i = BP_MAPX(bp);
+   if (i >= eh_hvp[hn]->bpmapn || (pn = eh_hvp[hn]->bpmap[i] & 0xF) == 0)
+      return NULL;
+   return eh_hvp[hn]->bpcbp + pn - 1;
+}
+#endif
+
+/*===========================================================================*
+*                          BUDDY ARENA SUBROUTINES                           *
+*                            Do Not Call Directly                            *
+*===========================================================================*/
+#if EH_BUDDY
+/*
+*  bd_dq() -- Remove free block fp of order o from its free list, clear its 
+*  free bit, and clear the free list map bit if the list becomes empty.
+*/
+static void bd_dq(EHBF_PTR fp, u32 o, u32 hn)
+{
+   EHBF_PTR* lp = eh_hvp[hn]->bdflp + o - EH_BUDDY_MIN_AN;
+
+   if (fp->bl == NULL)
+      *lp = fp->fl;
+   else
+      fp->bl->fl = fp->fl;
+   if (fp->fl != NULL)
+      fp->fl->bl = fp->bl;
+   if (*lp == NULL)
+      eh_hvp[hn]->bdbmap &= ~(1 << (o - EH_BUDDY_MIN_AN));
+   BD_CLR(eh_hvp[hn]->bdfmap, BD_NODE((u8*)fp - eh_hvp[hn]->bdap, o));
+}
+
+/*
+*  bd_nq() -- Put free block fp of order o at the front of its free list, and
+*  set its free bit and the free list map bit.
+*/
+static void bd_nq(EHBF_PTR fp, u32 o, u32 hn)
+{
+   EHBF_PTR* lp = eh_hvp[hn]->bdflp + o - EH_BUDDY_MIN_AN;
+
+   fp->fl = *lp;
+   fp->bl = NULL;
+   if (*lp != NULL)
+      (*lp)->bl = fp;
+   *lp = fp;
+   eh_hvp[hn]->bdbmap |= 1 << (o - EH_BUDDY_MIN_AN);
+   BD_SET(eh_hvp[hn]->bdfmap, BD_NODE((u8*)fp - eh_hvp[hn]->bdap, o));
+}
 #endif
 
 /*===========================================================================*
@@ -2533,14 +3764,46 @@ static void bin_dq(CCB_PTR cp, u32 hn)
    #endif
 }
 
+#if EH_TLSF
+/*
+*  bin_ff() -- Find first large-enough chunk in the upper bin for csz and 
+*  remove it from the bin. Returns NULL if there is none.
+*/
+static CCB_PTR bin_ff(u32 csz, u32 hn)
+{
+   CCB_PTR cp;
+   u32     i = bin_find(csz, hn);
+
+   for (cp = eh_hvp[hn]->binp[i].ffl; cp != NULL && csz > cp->sz; cp = cp->ffl){}
+   if (cp != NULL)
+      bin_dq(cp, hn);
+   return cp;
+}
+#endif
+
 /*
-*  bin_find() -- Does binary search of upper bins based upon chunk size.
+*  bin_find() -- Finds upper bin based upon chunk size. Uses CLZ if the upper
+*  bins have TLSF layout <6>. Otherwise, does binary search.
 */
 static u32 bin_find(u32 csz, u32 hn)
 {
    u32 i  = eh_hvp[hn]->top_bin;
    u32 hi = eh_hvp[hn]->top_bin;
    u32 lo = eh_hvp[hn]->sba_top;
+   #if EH_TLSF
+   u32 f;   /* first-level index = log2(csz) */
+
+   if (eh_hvp[hn]->ubf0 != 0 && csz < eh_hvp[hn]->bszap[hi])
+   {
+      #if USE_CLZ
+      f = 31 - __CLZ(csz);
+      #else
+      for (f = 31; !(csz & (1 << f)); f--) {}
+      #endif
+      return lo + 1 + ((f - eh_hvp[hn]->ubf0) << EH_TLSF_SLI) +
+                    ((csz >> (f - EH_TLSF_SLI)) & ((1 << EH_TLSF_SLI) - 1));
+   }
+   #endif
 
    if (csz < eh_hvp[hn]->bszap[hi])
    {
@@ -2562,6 +3825,37 @@ static u32 bin_find(u32 csz, u32 hn)
    return i;
 }
 
+#if EH_TLSF
+/*
+*  bin_tlsf() -- Check if upper bin sizes have TLSF layout <6>. Returns f0 =
+*  log2 of first upper bin size, if so, or 0, if not.
+*/
+static u32 bin_tlsf(u32 hn)
+{
+   u32* bszap = eh_hvp[hn]->bszap;
+   u32  f, f0;   /* first-level indices */
+   u32  i, n;
+   u32  s;       /* second-level index */
+   u32  sz;      /* first upper bin size */
+
+   sz = eh_hvp[hn]->sba_top_sz + 8;
+   if (eh_hvp[hn]->sba_top_sz == 0 || (sz & (sz - 1)) != 0)
+      return 0;
+   for (f0 = 0; (1 << f0) < sz; f0++) {}
+   if (f0 < EH_TLSF_SLI + 3)
+      return 0;
+
+   for (i = eh_hvp[hn]->sba_top + 1, n = 0; i <= eh_hvp[hn]->top_bin; i++, n++)
+   {
+      f = f0 + (n >> EH_TLSF_SLI);
+      s = n & ((1 << EH_TLSF_SLI) - 1);
+      if (f > 31 || bszap[i] != (1 << f) + (s << (f - EH_TLSF_SLI)))
+         return 0;
+   }
+   return f0;
+}
+#endif
+
 /*
 *  bin_nq() -- If bin is empty, link chunk to its ffl and fbl and set its 
 *  bmap bit. Otherwise, link the chunk to the start of free list, if smaller
@@ -2664,6 +3958,116 @@ static void chunk_merge_up(CCB_PTR cp, u32 hn)
       eh_hvp[hn]->hsp = cp;
    if (eh_hvp[hn]->hfp == ncp)
       eh_hvp[hn]->hfp = cp;
+   #if EH_HANDLES
+   if (eh_hvp[hn]->cmp == ncp)
+      eh_hvp[hn]->cmp = cp;
+   #endif
+}
+
+/*
+*  chunk_chk() -- Return the chunk pointer of block bp, if bp is the block of
+*  an inuse chunk that eh_Free() would accept, else NULL. Block pool and buddy
+*  arena blocks return NULL.
+*/
+static CCB_PTR chunk_chk(void* bp, u32 hn)
+{
+   CCB_PTR  cp;      /* chunk pointer */
+   CCB_PTR  pcp;     /* previous chunk pointer */
+   CCB_PTR  pi = (CCB_PTR)eh_hvp[hn]->pi;
+   CCB_PTR  px = (CCB_PTR)eh_hvp[hn]->px;
+
+   if ((CCB_PTR)bp <= pi || (CCB_PTR)bp >= px)
+      return NULL;
+   #if EH_BP
+   if (bp_slab(bp, hn) != NULL)
+      return NULL;
+   #endif
+   #if EH_BUDDY
+   if (BD_IN(bp))
+      return NULL;
+   #endif
+   if ((*((u32*)bp-1)&EH_INUSE) == 0)
+      return NULL;
+   if (DEBUG_CHK(bp))
+      cp = (CCB_PTR)((u32)bp - (sizeof(CDCB) + 4*EH_NUM_FENCES));
+   else
+      cp = (CCB_PTR)((u32)bp - 8);
+   pcp = BK_LNK(cp);
+   if (cp->fl <= pi || cp->fl > px || pcp < pi || pcp >= px)
+      return NULL;
+   return cp;
+}
+
+/*
+*  chunk_grow() -- Internal subroutine used by eh_Realloc(). Grows inuse chunk
+*  cp to at least csz by merging the next chunk into it, if that chunk is free
+*  and big enough. If the next chunk is dc or tc, only the needed space is
+*  calved from it <8>. Otherwise, the whole chunk is merged and eh_Realloc()
+*  splits off the excess. Updates hused. Returns false if cp cannot be grown.
+*/
+static bool chunk_grow(CCB_PTR cp, u32 csz, u32 hn)
+{
+   u32      ccsz;    /* current chunk size */
+   u32      flags;
+   CCB_PTR  ncp;     /* next chunk pointer */
+   CCB_PTR  nfl;     /* next chunk forward link */
+   u32      nsz;     /* next chunk size */
+   CCB_PTR  rcp;     /* remaining dc or tc pointer */
+
+   ccsz = (u32)cp->fl - (u32)cp;
+   ncp  = cp->fl;
+   if (ncp >= (CCB_PTR)eh_hvp[hn]->px || !EH_IS_FREE(ncp))
+      return false;
+   nfl = ncp->fl;
+   nsz = (u32)nfl - (u32)ncp;
+
+   if (ncp == eh_hvp[hn]->dcp || ncp == eh_hvp[hn]->tcp)
+   {
+      if (ccsz + nsz < csz + sizeof(CCB) || 
+         (ncp == eh_hvp[hn]->dcp && !eh_hvp[hn]->mode.fl.use_dc))
+         return false;
+
+      /* move dc or tc up to end of cp. ncp CCB may be overwritten. */
+      rcp = (CCB_PTR)((u8*)cp + csz);
+      rcp->fl  = nfl;
+      rcp->blf = cp;
+      rcp->sz  = ccsz + nsz - csz;
+      rcp->ffl = rcp->fbl = NULL;
+      rcp->binx8 = 0;
+      flags = (u32)nfl->blf & EH_FLAGS;
+      nfl->blf = (CCB_PTR)((u32)rcp | flags);
+      cp->fl = rcp;
+      if (ncp == eh_hvp[hn]->dcp)
+         eh_hvp[hn]->dcp = rcp;
+      else
+         eh_hvp[hn]->tcp = rcp;
+      eh_hvp[hn]->hused += csz - ccsz;
+   }
+   else
+   {
+      if (ccsz + nsz < csz)
+         return false;
+
+      /* remove ncp from its bin and merge it into cp */
+      bin_dq(ncp, hn);
+      flags = (u32)nfl->blf & EH_FLAGS;
+      cp->fl = nfl;
+      nfl->blf = (CCB_PTR)((u32)cp | flags);
+      eh_hvp[hn]->hused += nsz;
+   }
+   if (eh_hvp[hn]->hused > eh_hvp[hn]->hhwm)
+      eh_hvp[hn]->hhwm = eh_hvp[hn]->hused;
+
+   /* adjust scan and fix pointers, if necessary */
+   if (eh_hvp[hn]->hsp == ncp)
+      eh_hvp[hn]->hsp = cp;
+   if (eh_hvp[hn]->hfp == ncp)
+      eh_hvp[hn]->hfp = cp;
+   #if EH_HANDLES
+   if (eh_hvp[hn]->cmp == ncp)
+      eh_hvp[hn]->cmp = cp;
+   #endif
+   return true;
 }
 
 /*
@@ -2784,6 +4188,10 @@ static void debug_load(CCB_PTR cp)
    dcbp->time = eh_time();
    dcbp->onr  = eh_onr();
    dcbp->fence = EH_FENCE_FILL;
+   #if EH_OSTATS
+   dcbp->site = eh_site();
+   dcbp->pad  = EH_FENCE_FILL;
+   #endif
 
    /* load upper fence fill */
    if ((u32)cp->blf & EH_SSP)
@@ -2803,6 +4211,31 @@ static void debug_load(CCB_PTR cp)
       *fp = EH_FENCE_FILL;
 }
 
+/*
+*  fence_chk() -- Return true if the CDCB fence and the lower and upper fences
+*  of debug chunk cp are intact.
+*/
+static bool fence_chk(CCB_PTR cp)
+{
+   u32*  fp;   /* fence pointer */
+   u32   j;
+
+   if (((CDCB_PTR)cp)->fence != EH_FENCE_FILL)
+      return false;
+   fp = (u32*)cp + sizeof(CDCB)/4;
+   for (j = EH_NUM_FENCES; j > 0; j--, fp++)
+      if (*fp != EH_FENCE_FILL)
+         return false;
+   if ((u32)cp->blf & EH_SSP)
+      fp = (u32*)(*((u32*)cp->fl - 1)) - EH_NUM_FENCES;
+   else
+      fp = (u32*)cp->fl - EH_NUM_FENCES;
+   for (j = EH_NUM_FENCES; j > 0; j--, fp++)
+      if (*fp != EH_FENCE_FILL)
+         return false;
+   return true;
+}
+
 /*
 *  fix_ffl_bs() -- Fixes broken ffl by scanning backward from bin list end, 
 *  num chunks at a time. Stops when it reaches eh_hvp[hn]->bsp and sets eh_hvp[hn]->mode.fl.bs_fwd 
@@ -2990,6 +4423,188 @@ static CCB_PTR fix_fl_sz(CCB_PTR cp, u32 hn)
    return NULL;
 }
 
+#if EH_HANDLES
+/*
+*  hdl_chk() -- Returns true if hp is an allocated handle of heap hn. 
+*  Otherwise, reports EH_INV_PAR and returns false.
+*/
+static bool hdl_chk(EHH_PTR hp, u32 hn)
+{
+   EHH_PTR hdlp = eh_hvp[hn]->hdlp;
+
+   eh_hvp[hn]->errno = EH_OK;
+   if (hp < hdlp || hp >= hdlp + eh_hvp[hn]->hdln 
+       || ((u32)hp - (u32)hdlp) % sizeof(EHH) != 0 || hp->bp == NULL)
+   {
+      eh_error(EH_INV_PAR, 2, hn);
+      return false;
+   }
+   return true;
+}
+
+/*
+*  hdl_find() -- Returns the handle of inuse chunk cp, if it holds a handle 
+*  block, else NULL. The first word of the block points to its handle, which
+*  must point back to the block. <19>
+*/
+static EHH_PTR hdl_find(CCB_PTR cp, u32 hn)
+{
+   u32*    bp;   /* block pointer */
+   EHH_PTR hp;   /* handle pointer */
+   EHH_PTR hdlp = eh_hvp[hn]->hdlp;
+
+   if (EH_IS_FREE(cp) || hdlp == NULL)
+      return NULL;
+   if ((u32)cp->blf & EH_DEBUG)
+      bp = (u32*)((u32)cp + sizeof(CDCB) + 4*EH_NUM_FENCES);
+   else
+      bp = (u32*)((u32)cp + 8);
+
+   hp = (EHH_PTR)*bp;
+   if (hp < hdlp || hp >= hdlp + eh_hvp[hn]->hdln 
+       || ((u32)hp - (u32)hdlp) % sizeof(EHH) != 0 || hp->bp != (void*)(bp + 2))
+      return NULL;
+   return hp;
+}
+#endif /* EH_HANDLES */
+
+#if EH_OSTATS
+/*
+*  os_add() -- Adds dsz bytes and dnum chunks to the entry for id in EHOS 
+*  array tp of n entries. If there is no entry for id, a new chunk gets the 
+*  first free entry. If none is free, or if the chunk was counted before its
+*  id had an entry, the last entry is used. Returns the entry used, or NULL.
+*/
+static EHOS_PTR os_add(EHOS_PTR tp, u32 n, u32 id, s32 dsz, s32 dnum)
+{
+   EHOS_PTR fp = NULL;  /* first free entry pointer */
+   EHOS_PTR ep;         /* entry pointer */
+
+   if (tp == NULL || n == 0)
+      return NULL;
+
+   /* search all but the last entry for id and for a free entry */
+   for (ep = tp; ep < tp + n - 1; ep++)
+   {
+      if (ep->num == 0)
+      {
+         if (fp == NULL)
+            fp = ep;
+      }
+      else if (ep->id == id)
+         break;
+   }
+
+   if (ep == tp + n - 1)
+   {
+      if (fp != NULL && dnum > 0)
+      {
+         /* start new entry */
+         ep = fp;
+         ep->id = id;
+         ep->space = 0;
+         ep->maxspace = 0;
+      }
+      else
+         ep->id = 0; /* overflow entry */
+   }
+
+   ep->num += dnum;
+   ep->space += dsz;
+   if (ep->space > ep->maxspace)
+      ep->maxspace = ep->space;
+   return ep;
+}
+
+#if EH_BP
+/*
+*  os_bpcount() -- Counts (dnum = 1) or uncounts (dnum = -1) block pool block 
+*  bp of size bsz for its owner and call site. The owner and site entry 
+*  indices + 1 are saved in the index pair for bp at the start of its slab, 
+*  and are 0 if bp is not counted. <8>
+*/
+static void os_bpcount(void* bp, u32 bsz, s32 dnum, u32 hn)
+{
+   EHOS_PTR ep;
+   u8*      xp = BP_OSX(bp, bsz);  /* index pair pointer */
+
+   if (dnum < 0)
+   {
+      if (xp[0] != 0)
+      {
+         ep = eh_hvp[hn]->osp + xp[0] - 1;
+         ep->num--;
+         ep->space -= bsz;
+      }
+      if (xp[1] != 0)
+      {
+         ep = eh_hvp[hn]->ssp + xp[1] - 1;
+         ep->num--;
+         ep->space -= bsz;
+      }
+      xp[0] = xp[1] = 0;
+   }
+   else if (eh_hvp[hn]->mode.fl.debug)
+   {
+      if (eh_hvp[hn]->osn <= 255)
+      {
+         ep = os_add(eh_hvp[hn]->osp, eh_hvp[hn]->osn, eh_onr(), bsz, 1);
+         xp[0] = (u8)(ep == NULL ? 0 : ep - eh_hvp[hn]->osp + 1);
+      }
+      if (eh_hvp[hn]->ssn <= 255)
+      {
+         ep = os_add(eh_hvp[hn]->ssp, eh_hvp[hn]->ssn, eh_site(), bsz, 1);
+         xp[1] = (u8)(ep == NULL ? 0 : ep - eh_hvp[hn]->ssp + 1);
+      }
+   }
+}
+#endif
+
+/*
+*  os_count() -- Adds dsz bytes and dnum chunks to the owner and call site
+*  statistics of debug chunk dcp.
+*/
+static void os_count(CDCB_PTR dcp, s32 dsz, s32 dnum, u32 hn)
+{
+   os_add(eh_hvp[hn]->osp, eh_hvp[hn]->osn, dcp->onr, dsz, dnum);
+   os_add(eh_hvp[hn]->ssp, eh_hvp[hn]->ssn, dcp->site, dsz, dnum);
+}
+
+/*
+*  os_peek() -- Returns par for the entry for id in EHOS array tp of n
+*  entries, or 0 if there is none. Used by eh_OwnerPeek() and eh_SitePeek().
+*/
+static u32 os_peek(EHOS_PTR tp, u32 n, u32 id, EH_PK_PAR par, u32 hn)
+{
+   EHOS_PTR ep;   /* entry pointer */
+
+   eh_hvp[hn]->errno = EH_OK;
+
+   if (par != EH_PK_COUNT && par != EH_PK_SPACE && par != EH_PK_MAXUSE)
+   {
+      eh_error(EH_INV_PAR, 1, hn);
+      return -1;
+   }
+
+   for (ep = tp; tp != NULL && ep < tp + n; ep++)
+   {
+      if (ep->num != 0 && ep->id == id)
+      {
+         switch (par)
+         {
+            case EH_PK_COUNT:
+               return ep->num;
+            case EH_PK_SPACE:
+               return ep->space;
+            default:
+               return ep->maxspace;
+         }
+      }
+   }
+   return 0;
+}
+#endif /* EH_OSTATS */
+
 /*
 *  eh_error() -- Report error.
 */
@@ -3040,4 +4655,61 @@ static void eh_error(EH_ERRNO errnum, u32 level, u32 hn)
    13. Necessary only if prior chunk is not free. However that will usually be
        the case and testing this requires several instructions, so better to
        not test.
+   14. The block pool block copy is done by bp_realloc(). The eh_Malloc() copy
+       for eh_Realloc() works only for chunks.
+   15. Slab map entries hold the pool number + 1 in bits 0-3. eh_PoolTrim() 
+       uses bits 4-15 to count free blocks in each slab. A slab can be freed
+       only if all of its blocks are in the detached free list, so no block of
+       it can be in use or be released while it is being freed. Blocks 
+       released during a trim go into the new free list. On a single-core 
+       Cortex-M, any exception between LDREX and STREX clears the exclusive 
+       monitor, so the STREX fails and the pop or push is retried. This also 
+       prevents ABA, without a tag.
+   16. Growing in place avoids the copy of a moved block, which makes repeated
+       growth of a buffer, such as a vector or string, much cheaper when it is
+       next to tc. eh_hvp[hn]->rinpl counts reallocs that kept the block in 
+       place and eh_hvp[hn]->rmove counts those that moved it. See eh_Peek().
+   17. A record is reserved before it is filled, so a record that is read
+       while a preempted task is filling it may be incomplete. Stop tracing
+       with eh_TraceInit(NULL, 0) before reading the ring.
+   18. Owner and call site statistics cost two short table searches per 
+       debug chunk allocated, freed, or resized in place, all done under the
+       heap access control. A chunk that eh_Realloc() moves is counted to the
+       new owner and site; one resized in place is too, because debug_load()
+       reloads onr. See eheap.h note 8.
+   19. A handle block is a chunk block whose first 8 bytes hold a pointer to
+       its handle (and a pad word for 8-byte alignment), followed by the 
+       user block. This identifies movable chunks during compaction without
+       a new chunk flag. A move is a memmove() of the whole chunk, including
+       its CDCB, if any, so debug information and statistics go with it. If 
+       the chunk has spare space, its spare space pointer is adjusted. A move
+       costs a copy of the chunk, so eh_Compact(num) is bounded by num chunks
+       examined, but not by bytes copied. eh_hvp[hn]->cmp is kept valid 
+       where chunks are merged, as for hsp. See eheap.h note 9.
+   20. Buddy arena nodes are numbered as in a binary heap: the arena is node 
+       0, and the two halves of node x are nodes 2x+1 and 2x+2. So a block of
+       order o at offset off is node 2^(bdan-o) - 1 + off/2^o. bdfmap has a 
+       bit per node that is a free block. bdsmap has a bit per node that is 
+       split. The size of a block being freed is found by descending split 
+       nodes from the root, so it need not be stored in the block, and a 
+       block has no overhead. The free list of each order is doubly linked, 
+       so a free buddy can be removed in constant time. The bit maps take 
+       2^(bdan-EH_BUDDY_MIN_AN-2) bytes each. See eheap.h note 10.
+   21. A run of adjacent inuse chunks is merged into its first chunk, which
+       is then freed by eh_Free(), so the run is merged with its free 
+       neighbors and put into a bin once, rather than once per chunk. Since 
+       the merged chunks are no longer visible to eh_Scan(), their fences are
+       checked first. Under EH_OSTATS, each merged debug chunk is uncounted 
+       from its owner and site and its space is moved to the first chunk, if
+       debug, so eh_Free() uncounts it. eh_Free() resets errno, so the first
+       error is kept and reported at the end. See eheap.h note 11.
+   22. The batch chunk is allocated by eh_Malloc() with block pools off, so 
+       hused, hhwm, fill, auto-recovery, and spare space are handled as for 
+       any chunk. It is then split into n inuse chunks; only the last keeps 
+       the EH_SSP flag. The sum of their sizes equals the batch chunk size, 
+       so hused is still correct. Debug information is loaded into each 
+       chunk and under EH_OSTATS, the batch chunk is uncounted and each 
+       chunk is counted. If the batch chunk cannot be found, the blocks may
+       still fit in smaller free chunks, so they are allocated one at a time.
+       See eheap.h note 11.
 */
@@ -38,19 +38,30 @@
 *===========================================================================*/
 
 #define EH_ALIGN        1  /* enable aligned allocations */
-#define EH_BP           1  /* 8- and 12-byte block pool enable */
+#define EH_BP           1  /* small block pools enable <5> */
+#define EH_BP_MAX       15 /* maximum number of block pools */
+#define EH_BP_SLAB_AN   10 /* block pool slab size = 2^EH_BP_SLAB_AN */
+#define EH_BUDDY        0  /* enable buddy region arena <10> */
+#define EH_BUDDY_MIN_AN 5  /* minimum buddy block = 32 bytes (min MPU region) */
+#define EH_HANDLES      0  /* enable movable handle blocks and compaction <9> */
 #define EH_MAX_AN       12 /* maximum alignment = 4096 */
 #define EH_NUM_FENCES   2  /* fence words above and below data block. <4> */
 #define EH_NUM_HEAPS    6  /* number of heaps supported */
+#define EH_OSTATS       0  /* enable owner and call site statistics <8> */
 #define EH_SAFE         1  /* enable safety checks */
 #define EH_SS_MERGE     1  /* enable spare space merge */
 #define EH_STATS        0  /* enable statistics */
+#define EH_TLSF         0  /* enable TLSF-style upper bins <6> */
+#define EH_TRACE        0  /* enable heap trace capture <7> */
+#define EH_TLSF_SLI     2  /* TLSF second-level index bits */
 
 #if defined(__IAR_SYSTEMS_ICC__)
 #define USE_CLZ 1
+#define USE_LDREX 1
 #include <intrinsics.h>
 #else
 #define USE_CLZ 0
+#define USE_LDREX 0
 #endif
 
 /*===========================================================================*
@@ -83,6 +94,7 @@ typedef  uint32_t    u32;
 #define EH_FLAGS        0x7      /* ~ used to clear above flags */
 #define EH_MIN_FRAG (32 + EH_CHK_OVH)  /* Minimum fragment size after splitting. <8> */
 #define EH_R            0x100    /* MPU region flag */
+#define EH_BP_SLAB      (1 << EH_BP_SLAB_AN)  /* block pool slab size */
 
 /* Heap Fill Patterns */
 #define EH_DATA_FILL    0xDDDDDDDD
@@ -104,20 +116,35 @@ typedef enum {
    EH_PK_FIRST,
    EH_PK_HS_FWD,
    EH_PK_INIT,
+   EH_PK_INUSE,
+   EH_PK_LARGEST,
    EH_PK_LAST,
+   EH_PK_MAXUSE,
    EH_PK_MERGE,
    EH_PK_NEXT,
    EH_PK_NEXT_FREE,
    EH_PK_ONR,
    EH_PK_PREV,
    EH_PK_PREV_FREE,
+   EH_PK_REALLOC_IP,
+   EH_PK_REALLOC_MV,
    EH_PK_SIZE,
+   EH_PK_SLABS,
    EH_PK_SPACE,
    EH_PK_TIME,
    EH_PK_TYPE,
    EH_PK_USE_DC
 } EH_PK_PAR;
 
+/* Trace Operations */
+typedef enum {
+   EH_TR_NONE,
+   EH_TR_CALLOC,
+   EH_TR_FREE,
+   EH_TR_MALLOC,
+   EH_TR_REALLOC
+} EH_TR_OP;
+
 /* Set Parameters */
 typedef enum {
    EH_ST_AUTO,
@@ -154,14 +181,18 @@ typedef enum {
 typedef struct CCB*  CCB_PTR;
 
 typedef struct BPCB {  /* BLOCK POOL CONTROL BLOCK */
-   u32      num_blks;      /* number of blocks in pool */
+   u32      bsz;           /* block size (set by user) */
    u32      inuse;         /* blocks in use of this size */
    u32      maxuse;        /* maximum blocks in use of this size */
-   void*    pi;            /* pointer to pool start block */
+   u32      num_slabs;     /* number of slabs in pool */
    void*    pn;            /* pointer to next free block = NULL if none */
-   void*    px;            /* pointer to pool end block */
 } BPCB, *BPCB_PTR;
 
+typedef struct EHBF {   /* EHEAP BUDDY FREE BLOCK <10> */
+   struct EHBF* fl;        /* forward link */
+   struct EHBF* bl;        /* backward link */
+} EHBF, *EHBF_PTR;
+
 typedef struct CCB {    /* CHUNK FREE CONTROL BLOCK */
    CCB_PTR  fl;            /* forward link */
    CCB_PTR  blf;           /* backward link | flags */
@@ -178,6 +209,10 @@ typedef struct CDCB {   /* CHUNK DEBUG CONTROL BLOCK */
    u32      time;          /* time of allocation (etime) */
    u32      onr;           /* task or LSR that allocated chunk */
    u32      fence;         /* = EH_FENCE_FILL */
+#if EH_OSTATS
+   u32      site;          /* call site that allocated chunk <8> */
+   u32      pad;           /* keeps CDCB a multiple of 8 bytes */
+#endif
 } CDCB, *CDCB_PTR;
 
 typedef struct CICB {   /* CHUNK INUSE CONTROL BLOCK */
@@ -185,6 +220,29 @@ typedef struct CICB {   /* CHUNK INUSE CONTROL BLOCK */
    CCB_PTR  blf;           /* backward link | flags */
 } CICB, *CICB_PTR;
 
+typedef struct EHH {    /* EHEAP HANDLE <9> */
+   void*    bp;            /* block pointer, NULL if handle is free */
+   u32      lock;          /* lock count. Block cannot move if > 0 */
+} EHH, *EHH_PTR;
+
+typedef struct EHOS {   /* EHEAP OWNER OR SITE STATISTICS <8> */
+   u32      id;            /* owner or call site, 0 for overflow entry */
+   u32      num;           /* number of chunks held; 0 = entry is free */
+   u32      space;         /* bytes held (chunk sizes) */
+   u32      maxspace;      /* maximum bytes held */
+} EHOS, *EHOS_PTR;
+
+typedef struct EHTR {   /* EHEAP TRACE RECORD <7> */
+   u32      time;          /* eh_time() at end of operation */
+   u32      bp;            /* block pointer returned or freed = block id */
+   u32      cbp;           /* current block pointer for realloc, else 0 */
+   u32      sz;            /* requested size (num*sz for calloc) */
+   u8       op;            /* operation (EH_TR_OP) */
+   u8       an;            /* alignment exponent */
+   u8       hn;            /* heap number */
+   u8       pad;
+} EHTR, *EHTR_PTR;
+
 typedef struct HBCB {   /* HEAP BIN CONTROL BLOCK */
    CCB_PTR  ffl;           /* free forward link */
    CCB_PTR  fbl;           /* free backward link */
@@ -227,6 +285,7 @@ typedef union HMODE { /* HEAP MODE FLAGS */
                                     3  all */
       u32      em_en    : 1;  /* enable error manager */
       u32      pre      : 1;  /* preemption protection present */
+      u32      nobp     : 1;  /* do not use block pools */
       } fl;
    u32 wd;                    /* to load or clear */
 } HMODE;
@@ -263,19 +322,47 @@ typedef struct EHV {    /* EHEAP VARIABLES */
    CICB_PTR  pi;           /* pointer to heap start chunk, sc */
    CICB_PTR  px;           /* pointer to heap end chunk, ec */
    u32       retries;      /* recovery retries */
+   u32       rinpl;        /* reallocs done in place */
+   u32       rmove;        /* reallocs that moved the block */
    u32       sba_top;      /* small bin array top bin number */
    u32       sba_top_sz;   /* small bin array top bin size */
    u32       tbsz;         /* top bin size (sum of chunks) */
    CCB_PTR   tcp;          /* top chunk pointer */
    u32       top_bin;      /* bin array top bin number */
+#if EH_TLSF
+   u32       ubf0;         /* log2 of first upper bin size, 0 if not TLSF <6> */
+#endif
 #if EH_BP || defined(SMXAWARE)
-   void*     fhcp;         /* first heap chunk pointer */
-   BPCB_PTR  bpcbp;        /* block pool control block array pointer */
+   BPCB_PTR  bpcbp;        /* block pool control block array pointer <5> */
+   u16*      bpmap;        /* slab map pointer */
+   u32       bpmapn;       /* number of slab map entries */
+   u32       bpnum;        /* number of block pools <5> */
+#endif
+#if EH_BUDDY
+   u8*       bdap;         /* buddy arena pointer, NULL if none <10> */
+   u32       bdan;         /* buddy arena size = 2^bdan */
+   u32       bdbmap;       /* buddy free list map, bit n = 2^(n+EH_BUDDY_MIN_AN) */
+   EHBF_PTR* bdflp;        /* buddy free list array pointer */
+   u8*       bdfmap;       /* buddy free node bit map */
+   u32       bdhwm;        /* buddy high water mark */
+   u8*       bdsmap;       /* buddy split node bit map */
+   u32       bdused;       /* buddy bytes in use */
 #endif
 #if EH_STATS || defined(SMXAWARE)
    u32*      bnump;        /* bin number pointer */
    u32*      bsump;        /* bin sum pointer */
 #endif
+#if EH_HANDLES
+   CCB_PTR   cmp;          /* compaction pointer <9> */
+   EHH_PTR   hdlp;         /* handle array pointer <9> */
+   u32       hdln;         /* number of handles */
+#endif
+#if EH_OSTATS
+   EHOS_PTR  osp;          /* owner statistics array pointer <8> */
+   u32       osn;          /* number of owner statistics entries */
+   EHOS_PTR  ssp;          /* call site statistics array pointer <8> */
+   u32       ssn;          /* number of call site statistics entries */
+#endif
 } EHV, *EHV_PTR;
 
 /*===========================================================================*
@@ -284,6 +371,11 @@ typedef struct EHV {    /* EHEAP VARIABLES */
 
 extern EHV_PTR eh_hvp[EH_NUM_HEAPS]; /* pointers to eh variable structures */
 extern u32     eh_hvpn;              /* next available eh_hvp slot */
+#if EH_TRACE
+extern EHTR_PTR eh_trp;              /* trace ring pointer, NULL if off */
+extern u32      eh_tri;              /* trace record index (total records) */
+extern u32      eh_trn;              /* trace ring size in records */
+#endif
 
 /*===========================================================================*
                                  MACROS
@@ -305,18 +397,51 @@ u32      eh_BinPeek(u32 binno, EH_PK_PAR par, u32 hn=0);
 bool     eh_BinScan(u32 binno, u32 fnum, u32 bnum, u32 hn=0);
 bool     eh_BinSeed(u32 num, u32 bsz, u32 hn=0);
 bool     eh_BinSort(u32 binno, u32 fnum, u32 hn=0);
+#if EH_BUDDY
+void*    eh_BuddyGet(u32 sz, u32 hn=0);
+bool     eh_BuddyInit(u32 an, u8* ap, u32 hn=0);
+u32      eh_BuddyPeek(EH_PK_PAR par, u32 hn=0);
+bool     eh_BuddyRel(void* bp, u32 hn=0);
+#endif
 void*    eh_Calloc(u32 num, u32 sz, u32 an=0, u32 hn=0);
 u32      eh_ChunkPeek(void* vp, EH_PK_PAR par, u32 hn=0);
+#if EH_HANDLES
+bool     eh_Compact(u32 num, u32 hn=0);
+#endif
 bool     eh_Extend(u32 xsz, u8* xp, u32 hn=0);
 bool     eh_Free(void* bp, u32 hn=0);
+bool     eh_FreeM(void** bpp, u32 n, u32 hn=0);
+#if EH_HANDLES
+EHH_PTR  eh_HandleAlloc(u32 sz, u32 hn=0);
+bool     eh_HandleFree(EHH_PTR hp, u32 hn=0);
+void*    eh_HandleLock(EHH_PTR hp, u32 hn=0);
+bool     eh_HandleUnlock(EHH_PTR hp, u32 hn=0);
+#endif
 u32      eh_Init(u32 sz, u32 dcsz, u8* hp, EHV_PTR vp, u32* bszap, HBCB* binp, 
                                              u32 mode, const char* name=NULL);
 void*    eh_Malloc(u32 sz, u32 an=0, u32 hn=0);
+bool     eh_MallocM(const u32* szp, u32 n, void** bpp, u32 hn=0);
+#if EH_OSTATS
+u32      eh_OwnerPeek(u32 onr, EH_PK_PAR par, u32 hn=0);
+#endif
 u32      eh_Peek(EH_PK_PAR par, u32 hn=0);
+#if EH_BP
+void*    eh_PoolGet(u32 sz, u32 an=0, u32 hn=0);
+u32      eh_PoolPeek(u32 pn, EH_PK_PAR par, u32 hn=0);
+bool     eh_PoolRel(void* bp, u32 hn=0);
+bool     eh_PoolTrim(u32 hn=0);
+#endif
 void*    eh_Realloc(void* cbp, u32 sz, u32 an=0, u32 hn=0);
 bool     eh_Recover(u32 sz, u32 num, u32 an=0, u32 hn=0);
 bool     eh_Scan(CCB_PTR cp, u32 fnum, u32 bnum, u32 hn=0);
 bool     eh_Set(EH_ST_PAR par, u32 val, u32 hn=0);
+#if EH_OSTATS
+u32      eh_SitePeek(u32 site, EH_PK_PAR par, u32 hn=0);
+#endif
+#if EH_TRACE
+void     eh_Trace(EH_TR_OP op, void* bp, void* cbp, u32 sz, u32 an, u32 hn);
+void     eh_TraceInit(EHTR_PTR trp, u32 num);
+#endif
 
 #else  /*--------------- for C without default parameters -------------------*/
 
@@ -324,18 +449,51 @@ u32      eh_BinPeek(u32 binno, EH_PK_PAR par, u32 hn);
 bool     eh_BinScan(u32 binno, u32 fnum, u32 bnum, u32 hn);
 bool     eh_BinSeed(u32 num, u32 bsz, u32 hn);
 bool     eh_BinSort(u32 binno, u32 fnum, u32 hn);
+#if EH_BUDDY
+void*    eh_BuddyGet(u32 sz, u32 hn);
+bool     eh_BuddyInit(u32 an, u8* ap, u32 hn);
+u32      eh_BuddyPeek(EH_PK_PAR par, u32 hn);
+bool     eh_BuddyRel(void* bp, u32 hn);
+#endif
 void*    eh_Calloc(u32 num, u32 sz, u32 an, u32 hn);
 u32      eh_ChunkPeek(void* vp, EH_PK_PAR par, u32 hn);
+#if EH_HANDLES
+bool     eh_Compact(u32 num, u32 hn);
+#endif
 bool     eh_Extend(u32 xsz, u8* xp, u32 hn);
 bool     eh_Free(void* bp, u32 hn);
+bool     eh_FreeM(void** bpp, u32 n, u32 hn);
+#if EH_HANDLES
+EHH_PTR  eh_HandleAlloc(u32 sz, u32 hn);
+bool     eh_HandleFree(EHH_PTR hp, u32 hn);
+void*    eh_HandleLock(EHH_PTR hp, u32 hn);
+bool     eh_HandleUnlock(EHH_PTR hp, u32 hn);
+#endif
 u32      eh_Init(u32 sz, u32 dcsz, u8* hp, EHV_PTR vp, u32* bszap, HBCB* binp, 
                                                   u32 mode, const char* name);
 void*    eh_Malloc(u32 sz, u32 an, u32 hn);
+bool     eh_MallocM(const u32* szp, u32 n, void** bpp, u32 hn);
+#if EH_OSTATS
+u32      eh_OwnerPeek(u32 onr, EH_PK_PAR par, u32 hn);
+#endif
 u32      eh_Peek(EH_PK_PAR par, u32 hn);
+#if EH_BP
+void*    eh_PoolGet(u32 sz, u32 an, u32 hn);
+u32      eh_PoolPeek(u32 pn, EH_PK_PAR par, u32 hn);
+bool     eh_PoolRel(void* bp, u32 hn);
+bool     eh_PoolTrim(u32 hn);
+#endif
 void*    eh_Realloc(void* cbp, u32 sz, u32 an, u32 hn);
 bool     eh_Recover(u32 sz, u32 num, u32 an, u32 hn);
 bool     eh_Scan(CCB_PTR cp, u32 fnum, u32 bnum, u32 hn);
 bool     eh_Set(EH_ST_PAR par, u32 val, u32 hn);
+#if EH_OSTATS
+u32      eh_SitePeek(u32 site, EH_PK_PAR par, u32 hn);
+#endif
+#if EH_TRACE
+void     eh_Trace(EH_TR_OP op, void* bp, void* cbp, u32 sz, u32 an, u32 hn);
+void     eh_TraceInit(EHTR_PTR trp, u32 num);
+#endif
 #endif /* __cplusplus */
 
 /*===========================================================================*
@@ -348,6 +506,9 @@ bool     eh_HeapsInit(void);  /* app callback to init heaps */
 
 extern u32 eh_onr(void);
 extern u32 eh_time(void);
+#if EH_OSTATS
+extern u32 eh_site(void);
+#endif
 
 /* Notes:
    1. eh_hvp[hn]->bszap points at an array, such as binsz[], which stores
@@ -358,5 +519,73 @@ extern u32 eh_time(void);
    3. Includes fences after the block in a debug chunk.
    4. EH_NUM_FENCES must be a multiples of 2 to preserve 8-byte alignment of 
       all chunks and blocks.
+   5. Block pools serve small blocks from fixed-size pools. To use them, load
+      bpcbp with a BPCB array and bpnum with its size before calling 
+      eh_Init(). bsz fields must be increasing, and are rounded up to multiples
+      of 8. Each bsz must be <= EH_BP_SLAB/4. Only bsz needs to be loaded. A
+      pool grows by slabs of EH_BP_SLAB bytes, which are allocated from the 
+      heap on demand, aligned on EH_BP_SLAB. eh_PoolTrim() returns slabs with 
+      no blocks in use to the heap. A slab map, allocated by eh_Init(), maps 
+      slabs to pools. If USE_LDREX, eh_PoolGet() and eh_PoolRel() are 
+      lock-free, and they may be called without heap access control.
+   6. If EH_TLSF, eh_Malloc() takes the first chunk of the next larger upper
+      bin, which is always big enough, instead of searching the bin for a 
+      first fit. Then finding a chunk takes constant time for sizes below the
+      top bin size. If the upper bin sizes follow the TLSF layout, the bin
+      number is also found with CLZ, instead of by binary search. The layout
+      is: the first upper bin size is a power of 2, 2^f0, which is 8 more
+      than the SBA top bin size, and each power of 2 >= 2^f0 is divided into
+      2^EH_TLSF_SLI bins of equal spacing, up through the top bin. f0 must be
+      >= EH_TLSF_SLI + 3. For example, for EH_TLSF_SLI == 2 and f0 == 7: 128,
+      160, 192, 224, 256, 320, 384, 448, 512, ... eh_Init() checks the layout
+      and sets ubf0 = f0, if it is correct, or 0, if it is not.
+   7. If EH_TRACE, eh_TraceInit() starts capture of allocation operations 
+      into a ring of EHTR records. num is rounded down to a power of 2. The 
+      operations are recorded by the heap API layer above eheap (e.g. 
+      smx_HeapMalloc()), so that internal eh_Malloc() and eh_Free() calls 
+      are not recorded. eh_tri counts all records; the oldest record is at 
+      eh_tri - eh_trn, if eh_tri > eh_trn. Records use u32 for pointers, so
+      a saved ring can be read by a host tool. See ehreplay.c.
+   8. If EH_OSTATS, each debug chunk is counted in two user-provided EHOS
+      arrays: one by owner (CDCB onr, the task or LSR) and one by call site 
+      (CDCB site, from eh_site(), which is the caller of the heap API or of
+      its wrapper). Load osp, osn, ssp, and ssn before eh_Init() and enable
+      debug mode, since only debug chunks carry the owner and site. Block 
+      pool blocks from eh_Malloc() in debug mode are counted, too, but not 
+      blocks from eh_PoolGet(). The first blocks of each slab hold a pair of
+      u8 owner and site entry indices per block, so slabs have fewer blocks,
+      and osn and ssn must be <= 255 for blocks to be counted. Slabs are not
+      debug chunks. Counts are not atomic, so eh_PoolRel() needs heap access
+      control. An entry is freed when its num reaches 0. If an array is 
+      full, its last entry (id = 0) collects the rest, so it should be sized
+      for the expected number of owners or sites. Use eh_OwnerPeek() and 
+      eh_SitePeek() to read an entry by its id.
+   9. If EH_HANDLES, eh_HandleAlloc() allocates a movable block and returns
+      a handle to it, from a user-provided EHH array. Load hdlp and hdln 
+      before eh_Init(). The block pointer is obtained with eh_HandleLock(), 
+      and it is valid only until the matching eh_HandleUnlock(). eh_Compact()
+      slides unlocked handle blocks down over free chunks, so that free 
+      space collects above them, normally in tc. It is intended to be run in
+      small increments by a heap manager during idle time. Other blocks are
+      not moved, so free space collects between fixed blocks.
+  10. If EH_BUDDY, eh_BuddyInit() sets up a buddy arena of 2^an bytes, for
+      MPU regions, which must be powers of 2 and aligned on their sizes for 
+      ARMv7-M. The arena is taken from heap hn, if ap is NULL; otherwise ap 
+      must be aligned on 2^an. Its free lists and bit maps are allocated 
+      from heap hn. eh_BuddyGet() returns a block of the smallest power of 2
+      >= sz, >= 2^EH_BUDDY_MIN_AN, aligned on its size, by splitting a larger
+      free block, if necessary. eh_BuddyRel() merges a freed block with its 
+      free buddy, repeatedly. Both take O(an) steps. eh_Free() passes arena
+      blocks to eh_BuddyRel(), so a region can be freed either way. Arena
+      blocks cannot be reallocated. Unlike region_srch(), the arena does not
+      leave odd-sized pieces in the heap, but a block wastes up to half its 
+      size, so it suits regions whose sizes are near powers of 2.
+  11. eh_MallocM() and eh_FreeM() allocate and free batches of blocks, such
+      as the nodes of a message tree, in one heap call. eh_MallocM() gets
+      one chunk for the batch and splits it, so the blocks are contiguous
+      and are likely to be freed together by eh_FreeM(), which frees each run
+      of adjacent chunks as one chunk. Blocks of a batch may also be freed
+      singly, and eh_FreeM() accepts any blocks of heap hn. 8-byte alignment
+      only. Batch blocks do not come from block pools.
 */
 #endif /* EHEAP_H */
\ No newline at end of file
@@ -0,0 +1,1076 @@
+/*
+* ehreplay.c                                                Version 6.2.0
+*
+* eheap Trace Replay Tool
+*
+* Copyright (c) 1989-2026 Micro Digital Inc.
+* All rights reserved. www.smxrtos.com
+*
+* SPDX-License-Identifier: GPL-2.0-only OR LicenseRef-MDI-Commercial
+*
+* This software, documentation, and accompanying materials are made available
+* under a dual license, either GPLv2 or Commercial. You may not use this file
+* except in compliance with either License. GPLv2 is at www.gnu.org/licenses.
+* It does not permit the incorporation of this code into proprietary programs.
+*
+* Commercial license and support services are available from Micro Digital.
+* Inquire at support@smxrtos.com.
+*
+* This Work embodies patents listed here. A patent license is hereby granted
+* to use these patents in this Work and Derivative Works, except in another
+* RTOS or OS.
+* US Patents 10,318,198, 11,010,070, and one or more patents pending.
+*
+* This entire comment block must be preserved in all copies of this file.
+*
+*****************************************************************************/
+
+/*
+*  Host tool that replays a heap trace, captured on the target with EH_TRACE,
+*  against eheap.c compiled for the host. Reports the latency distribution of
+*  each operation, peak fragmentation, and the largest free chunk over time,
+*  so that bin sizes (bszap), block pools, merge control, and heap manager
+*  policy can be compared off-target. <1>
+*
+*  Build on Linux (eheap keeps pointers in u32, so build for 32 bits). This
+*  needs the 32-bit C and C++ libraries, which a stock host does not have
+*  (on Debian or Ubuntu: apt install gcc-multilib g++-multilib
+*  libc6-dev-i386):
+*
+*     g++ -m32 -O2 -x c++ -I../XBASE -o ehreplay ehreplay.c eheap.c
+*
+*  Usage: ehreplay [options] trace_file
+*
+*     -a        automatic merge control, as in smx_HeapManager()
+*     -b file   bin sizes, as in bszap, ending with 0xFFFFFFFF or end of file
+*     -c n      maximum dynamic chunk size for -a (default 4136)
+*     -d n      donor chunk size (default 0)
+*     -e        MPU regions: round each block up to a power of 2 >= 32 and 
+*               align it on its size, as mp_RegionGetHeap() does <8>
+*     -g        debug mode (debug chunks, and owner and site statistics <5>)
+*     -h n      heap size (default 65536)
+*     -i n      eh_tri when the ring was saved (default: no wrap)
+*     -k n      movable blocks: allocate handle blocks and compact n chunks
+*               per heap manager run (needs EH_HANDLES and -x) <6>
+*     -l n      soak test reallocs: n% of operations reallocate a live 
+*               short-lived block to a new size <10>
+*     -m        no chunk merging
+*     -n n      heap number to replay (default 0)
+*     -o file   write samples to file as CSV
+*     -p list   block pool sizes, separated by commas (e.g. 16,24,32)
+*     -r n      soak test: replay n synthetic operations with mixed block
+*               lifetimes, instead of a trace file <7>
+*     -s n      sample heap every n operations (default 100)
+*     -t n      batches: replay each run of up to n malloc records or free 
+*               records with one eh_MallocM() or eh_FreeM(), and make soak 
+*               test blocks in groups of up to n, allocated and freed 
+*               together (max 32) <9>
+*     -u n      with -e, get regions from a 2^n byte buddy arena in the heap,
+*               then from the heap, if the arena has no block (needs EH_BUDDY)
+*     -x n      run heap manager every n operations (default 0 = never)
+*     -z        with -t, replay batches one block at a time, for comparison
+*
+*  trace_file is the EHTR ring, saved from target memory (e.g. eh_trp[0]
+*  thru eh_trp[eh_trn - 1]). It is omitted for -r. For example, to compare
+*  the largest free chunk over time without and with compaction:
+*
+*     ehreplay -r 1000000 -x 100 -s 1000 -o fixed.csv
+*     ehreplay -r 1000000 -x 100 -s 1000 -k 8 -o movable.csv
+*
+*  or to compare MPU region allocation from the heap and from a buddy arena:
+*
+*     ehreplay -r 100000 -e -h 300000 -o aligned.csv
+*     ehreplay -r 100000 -e -u 17 -h 300000 -o buddy.csv
+*
+*  or to compare realloc with and without growing in place (see Note 10):
+*
+*     ehreplay -r 1000000 -l 10
+*
+*  or to compare batch allocation with one block at a time:
+*
+*     ehreplay -r 1000000 -t 8 -z
+*     ehreplay -r 1000000 -t 8
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "eheap.h"
+
+/*============================================================================
+                                 VARIABLES
+============================================================================*/
+
+/* default bin sizes = mheap_binsz[] in sys.c */
+#if EH_TLSF
+u32 def_binsz[] = {24, 32, 40, 48, 56, 64, 72, 80, 88, 96, 104, 112, 120,
+                   128, 160, 192, 224, 256, 320, 384, 448, 512, 640, 768,
+                   896, 1024, 1280, 1536, 1792, 2048, 0xFFFFFFFF};
+#else
+u32 def_binsz[] = {24, 32, 40, 48, 56, 64, 72, 80, 88, 96, 104, 112, 120,
+                   128, 256, 384, 512, 640, 768, 896, 1024, 1152, 1280, 1408,
+                   1536, 1664, 1792, 1920, 2048, 0xFFFFFFFF};
+#endif
+
+u32         binsz[33];     /* bin sizes */
+HBCB        bins[32];      /* heap bins */
+BPCB        pools[EH_BP_MAX]; /* block pools */
+u32         npools;        /* number of block pools */
+EHV         hv;            /* heap variables */
+u32         hn;            /* host heap number */
+u32         trhn;          /* trace heap number */
+u32         opn;           /* current operation number */
+#if EH_OSTATS
+EHOS        ostab[8];      /* owner statistics */
+EHOS        sstab[64];     /* call site statistics */
+u32         site;          /* pseudo call site = requested size <5> */
+#endif
+
+/* options */
+bool        amerge;        /* automatic merge control */
+u32         cszmax = 4136; /* maximum dynamic chunk size */
+u32         dcsz;          /* donor chunk size */
+bool        debug;         /* debug mode */
+u32         hsz = 65536;   /* heap size */
+u32         cmpn;          /* compact cmpn chunks per heap manager run */
+bool        movable;       /* allocate handle blocks */
+bool        nomerge;       /* no chunk merging */
+bool        region;        /* allocate MPU regions */
+u32         smpn = 100;    /* sample every smpn operations */
+u32         soakn;         /* synthetic operations for soak test */
+u32         rlcpct;        /* soak test realloc percentage */
+u32         mgrn;          /* run heap manager every mgrn operations */
+u32         bdan;          /* buddy arena size = 2^bdan, 0 = none */
+u32         batchn;        /* batch up to batchn records, 0 = none */
+bool        nobatch;       /* replay batches one block at a time */
+
+/* target to host block map <2> */
+typedef struct BMAP {
+   u32      tbp;           /* target block pointer, 0 = empty, 1 = deleted */
+   void*    hbp;           /* host block pointer */
+} BMAP;
+
+BMAP*       bmap;          /* block map */
+u32         bmapn;         /* block map size = power of 2 */
+
+/* latency samples, in ns, per operation */
+typedef struct LAT {
+   const char* name;
+   u32*     ns;            /* samples */
+   u32      n;             /* number of samples */
+   u32      fails;         /* host operation failed, target did not */
+   u32      blks;          /* blocks, for batch operations */
+} LAT;
+
+#define BATCH_MAX    32
+#define LAT_MALLOCM  (EH_TR_REALLOC + 1)
+#define LAT_FREEM    (EH_TR_REALLOC + 2)
+
+LAT         lat[LAT_FREEM + 1];
+
+FILE*       csv;           /* sample file */
+
+/* statistics */
+double      bfrag_peak;    /* peak buddy arena fragmentation */
+u32         bfrag_peak_op; /* operation number of peak buddy fragmentation */
+u32         bhits;         /* regions from buddy arena */
+double      frag_peak;     /* peak fragmentation */
+u32         frag_peak_op;  /* operation number of peak fragmentation */
+u32         lfc_min = 0xFFFFFFFF; /* minimum largest free chunk */
+u32         lfc_min_op;    /* operation number of minimum largest free chunk */
+u32         unmatched;     /* frees and reallocs of unknown blocks */
+u32         used_peak;     /* peak heap used */
+
+/*============================================================================
+                           SUBROUTINE PROTOTYPES
+============================================================================*/
+
+static u32    batch(EHTR_PTR trp);
+static void*  blk_alloc(EHTR_PTR trp);
+static bool   blk_free(void* bp);
+static void*  blk_realloc(void* cbp, EHTR_PTR trp);
+static BMAP*  bmap_find(u32 tbp, bool add);
+static void   heap_mgr(void);
+static void   heap_sample(u32 time);
+static void   lat_add(u32 op, u32 ns);
+static void   lat_report(LAT* lp);
+static int    lat_cmp(const void* a, const void* b);
+static u32    now_ns(void);
+static bool   read_bins(const char* fname);
+static void   replay(EHTR_PTR trp);
+static EHTR_PTR soak(u32 n);
+
+/*============================================================================
+                              EHEAP CALLBACKS
+============================================================================*/
+
+u32 eh_onr(void)
+{
+   return 0;
+}
+
+u32 eh_time(void)
+{
+   return opn;
+}
+
+#if EH_OSTATS
+u32 eh_site(void)
+{
+   return site;
+}
+#endif
+
+/*============================================================================
+                                   MAIN
+============================================================================*/
+
+int main(int argc, char* argv[])
+{
+   FILE*    fp;            /* trace file */
+   u32      i;
+   u32      n;             /* number of trace records */
+   char*    p;
+   long     fsz;           /* trace file size */
+   u32      start;         /* index of oldest record */
+   u32      tri = 0;       /* eh_tri when ring was saved */
+   EHTR_PTR tmp;
+   EHTR_PTR trp;           /* trace records */
+  #if EH_OSTATS
+   EHOS     sst;           /* site statistics totals: id = entries in use */
+  #endif
+
+   memcpy(binsz, def_binsz, sizeof(def_binsz));
+
+   /* process options */
+   for (i = 1; i < (u32)argc && argv[i][0] == '-'; i++)
+   {
+      switch (argv[i][1])
+      {
+         case 'a':
+            amerge = true;
+            break;
+         case 'b':
+            if (!read_bins(argv[++i]))
+               return 1;
+            break;
+         case 'c':
+            cszmax = strtoul(argv[++i], NULL, 0);
+            break;
+         case 'd':
+            dcsz = strtoul(argv[++i], NULL, 0);
+            break;
+         case 'e':
+            region = true;
+            break;
+         case 'g':
+            debug = true;
+            break;
+         case 'h':
+            hsz = strtoul(argv[++i], NULL, 0);
+            break;
+         case 'i':
+            tri = strtoul(argv[++i], NULL, 0);
+            break;
+         case 'k':
+           #if EH_HANDLES
+            movable = true;
+            cmpn = strtoul(argv[++i], NULL, 0);
+            break;
+           #else
+            printf("-k needs EH_HANDLES\n");
+            return 1;
+           #endif
+         case 'l':
+            rlcpct = strtoul(argv[++i], NULL, 0);
+            break;
+         case 'm':
+            nomerge = true;
+            break;
+         case 'n':
+            trhn = strtoul(argv[++i], NULL, 0);
+            break;
+         case 'o':
+            if ((csv = fopen(argv[++i], "w")) == NULL)
+            {
+               printf("cannot open %s\n", argv[i]);
+               return 1;
+            }
+            fprintf(csv, "op,time,used,free,largest,frag\n");
+            break;
+         case 'p':
+            for (p = argv[++i]; *p != 0 && npools < EH_BP_MAX; npools++)
+            {
+               pools[npools].bsz = strtoul(p, &p, 0);
+               if (*p == ',')
+                  p++;
+            }
+            break;
+         case 'r':
+            soakn = strtoul(argv[++i], NULL, 0);
+            break;
+         case 's':
+            smpn = strtoul(argv[++i], NULL, 0);
+            break;
+         case 't':
+            batchn = strtoul(argv[++i], NULL, 0);
+            if (batchn > BATCH_MAX)
+               batchn = BATCH_MAX;
+            break;
+         case 'u':
+           #if EH_BUDDY
+            bdan = strtoul(argv[++i], NULL, 0);
+            break;
+           #else
+            printf("-u needs EH_BUDDY\n");
+            return 1;
+           #endif
+         case 'x':
+            mgrn = strtoul(argv[++i], NULL, 0);
+            break;
+         case 'z':
+            nobatch = true;
+            break;
+         default:
+            printf("unknown option %s\n", argv[i]);
+            return 1;
+      }
+   }
+   if (i != (u32)argc - (soakn > 0 ? 0 : 1))
+   {
+      printf("usage: ehreplay [options] trace_file\n");
+      printf("       ehreplay -r n [options]\n");
+      return 1;
+   }
+
+   if (soakn > 0)
+   {
+      /* make synthetic trace */
+      n = soakn;
+      trp = soak(n);
+   }
+   else
+   {
+      /* read trace ring */
+      if ((fp = fopen(argv[i], "rb")) == NULL)
+      {
+         printf("cannot open %s\n", argv[i]);
+         return 1;
+      }
+      fseek(fp, 0, SEEK_END);
+      fsz = ftell(fp);
+      fseek(fp, 0, SEEK_SET);
+      n = (u32)(fsz/sizeof(EHTR));
+      trp = (EHTR_PTR)malloc((n + 1)*sizeof(EHTR));
+      if (trp == NULL || fread(trp, sizeof(EHTR), n, fp) != n)
+      {
+         printf("cannot read %s\n", argv[i]);
+         return 1;
+      }
+      fclose(fp);
+
+      /* rotate ring so that the oldest record is first <3> */
+      if (tri > n)
+      {
+         start = tri % n;
+         tmp = (EHTR_PTR)malloc((n + 1)*sizeof(EHTR));
+         memcpy(tmp, trp + start, (n - start)*sizeof(EHTR));
+         memcpy(tmp + n - start, trp, start*sizeof(EHTR));
+         free(trp);
+         trp = tmp;
+      }
+      else if (tri > 0)
+         n = tri;
+   }
+   trp[n].op = EH_TR_NONE;
+
+   /* initialize host heap */
+   for (bmapn = 64; bmapn < 2*n; bmapn <<= 1) {}
+   bmap = (BMAP*)calloc(bmapn, sizeof(BMAP));
+   if (npools > 0)
+   {
+      hv.bpcbp = pools;
+      hv.bpnum = npools;
+   }
+  #if EH_HANDLES
+   if (movable)
+   {
+      hv.hdlp = (EHH_PTR)calloc(n, sizeof(EHH));
+      hv.hdln = n;
+   }
+  #endif
+  #if EH_OSTATS
+   hv.osp = ostab;
+   hv.osn = sizeof(ostab)/sizeof(EHOS);
+   hv.ssp = sstab;
+   hv.ssn = sizeof(sstab)/sizeof(EHOS);
+  #endif
+   hn = eh_Init(hsz, dcsz, (u8*)malloc(hsz), &hv, binsz, bins, EH_NORM, "replay");
+   if (hn == (u32)-1)
+   {
+      printf("eh_Init() failed, errno = %d\n", hv.errno);
+      return 1;
+   }
+   hv.mode.fl.cmerge = !nomerge;
+   hv.mode.fl.debug = debug;
+  #if EH_BUDDY
+   if (bdan > 0 && (!region || !eh_BuddyInit(bdan, NULL, hn)))
+   {
+      printf("eh_BuddyInit() failed or no -e, errno = %d\n", hv.errno);
+      return 1;
+   }
+  #endif
+
+   lat[EH_TR_CALLOC].name  = "calloc";
+   lat[EH_TR_FREE].name    = "free";
+   lat[EH_TR_MALLOC].name  = "malloc";
+   lat[EH_TR_REALLOC].name = "realloc";
+   lat[LAT_MALLOCM].name   = "mallocm";
+   lat[LAT_FREEM].name     = "freem";
+   for (i = EH_TR_CALLOC; i <= LAT_FREEM; i++)
+      lat[i].ns = (u32*)malloc(n*sizeof(u32));
+
+   replay(trp);
+   heap_sample(trp[n - 1].time);
+
+   /* report results */
+   printf("%u operations replayed for heap %u, %u unmatched\n", opn, trhn, unmatched);
+   printf("%-8s %8s %8s %8s %8s %8s %8s %6s\n", "op", "count", "min",
+                                   "median", "p99", "max", "mean", "fails");
+   for (i = EH_TR_CALLOC; i <= LAT_FREEM; i++)
+      lat_report(&lat[i]);
+   printf("times in ns, per batch for mallocm and freem\n");
+   printf("peak used:        %u bytes\n", used_peak);
+   printf("peak frag:        %.3f at op %u\n", frag_peak, frag_peak_op);
+   printf("min largest free: %u bytes at op %u\n", lfc_min, lfc_min_op);
+   printf("reallocs:         %u in place, %u moved\n",
+                  eh_Peek(EH_PK_REALLOC_IP, hn), eh_Peek(EH_PK_REALLOC_MV, hn));
+  #if EH_OSTATS
+   if (debug)
+   {
+      /* pool blocks in use should be among the blocks held by sites */
+      for (i = 0, sst.num = sst.space = sst.id = 0; i < sizeof(sstab)/sizeof(EHOS); i++)
+      {
+         sst.id    += (sstab[i].num != 0);
+         sst.num   += sstab[i].num;
+         sst.space += sstab[i].space;
+      }
+      for (i = 0, n = 0; i < npools; i++)
+         n += eh_PoolPeek(i, EH_PK_INUSE, hn);
+      printf("sites held:       %u blocks, %u bytes, in %u entries; %u pool blocks\n",
+                                                   sst.num, sst.space, sst.id, n);
+   }
+  #endif
+  #if EH_BUDDY
+   if (bdan > 0)
+   {
+      printf("buddy regions:    %u, peak used %u of %u bytes\n", bhits,
+                  eh_BuddyPeek(EH_PK_MAXUSE, hn), eh_BuddyPeek(EH_PK_SIZE, hn));
+      printf("buddy peak frag:  %.3f at op %u\n", bfrag_peak, bfrag_peak_op);
+   }
+  #endif
+   if (csv != NULL)
+      fclose(csv);
+   return 0;
+}
+
+/*============================================================================
+                                SUBROUTINES
+============================================================================*/
+
+/*
+*  batch() -- If -t, replays the run of 2 to batchn malloc records or free
+*  records that starts at trp with one eh_MallocM() or eh_FreeM(). Returns
+*  the number of records replayed, or 1 if trp is to be replayed singly. <9>
+*/
+static u32 batch(EHTR_PTR trp)
+{
+   void*    bp[BATCH_MAX];    /* host block pointers */
+   u32      i, k;
+   BMAP*    mp[BATCH_MAX];    /* block map entries */
+   bool     pass;
+   u32      sz[BATCH_MAX];    /* block sizes */
+   u32      t0;      /* start time */
+
+   if (batchn < 2 || nobatch || movable || region ||
+                        (trp->op != EH_TR_MALLOC && trp->op != EH_TR_FREE))
+      return 1;
+
+   /* find run of records */
+   for (k = 0; k < batchn && trp[k].op == trp->op && trp[k].hn == trhn; k++)
+   {
+      if (trp->op == EH_TR_MALLOC)
+      {
+         if (trp[k].sz == 0 || trp[k].an > 3)
+            break;
+         sz[k] = trp[k].sz;
+      }
+      else if ((mp[k] = bmap_find(trp[k].bp, false)) == NULL)
+         break;
+   }
+   if (k < 2)
+      return 1;
+
+   if (trp->op == EH_TR_MALLOC)
+   {
+      t0 = now_ns();
+      pass = eh_MallocM(sz, k, bp, hn);
+      lat_add(LAT_MALLOCM, now_ns() - t0);
+      for (i = 0; i < k; i++)
+      {
+         if (trp[i].bp == 0)
+         {
+            if (pass)
+               eh_Free(bp[i], hn);  /* failed on target */
+         }
+         else if (!pass)
+            lat[LAT_MALLOCM].fails++;
+         else
+            bmap_find(trp[i].bp, true)->hbp = bp[i];
+      }
+      lat[LAT_MALLOCM].blks += k;
+   }
+   else
+   {
+      for (i = 0; i < k; i++)
+      {
+         bp[i] = mp[i]->hbp;
+         mp[i]->tbp = 1;
+      }
+      t0 = now_ns();
+      if (!eh_FreeM(bp, k, hn))
+         lat[LAT_FREEM].fails++;
+      lat_add(LAT_FREEM, now_ns() - t0);
+      lat[LAT_FREEM].blks += k;
+   }
+   return k;
+}
+
+/*
+*  blk_alloc() -- Allocates a block for a malloc or calloc record, a handle
+*  block, if -k, or a region, if -e. Returns the host block pointer or handle.
+*/
+static void* blk_alloc(EHTR_PTR trp)
+{
+  #if EH_BUDDY
+   void* bp;
+  #endif
+   u32   rn;      /* region size = 2^rn */
+
+  #if EH_HANDLES
+   if (movable)
+      return eh_HandleAlloc(trp->sz, hn);
+  #endif
+   if (region)
+   {
+      for (rn = 5; ((u32)1 << rn) < trp->sz; rn++) {}
+     #if EH_BUDDY
+      if (bdan > 0 && (bp = eh_BuddyGet((u32)1 << rn, hn)) != NULL)
+      {
+         bhits++;
+         return bp;
+      }
+     #endif
+      return eh_Malloc((u32)1 << rn, rn, hn);
+   }
+   if (trp->op == EH_TR_CALLOC)
+      return eh_Calloc(trp->sz, 1, trp->an, hn);
+   return eh_Malloc(trp->sz, trp->an, hn);
+}
+
+/*
+*  blk_free() -- Frees a host block or handle block.
+*/
+static bool blk_free(void* bp)
+{
+  #if EH_HANDLES
+   if (movable)
+      return eh_HandleFree((EHH_PTR)bp, hn);
+  #endif
+   return eh_Free(bp, hn);
+}
+
+/*
+*  blk_realloc() -- Reallocates host block cbp for a realloc record. If -k or
+*  -e, gets a new block and frees the old one. <6>
+*/
+static void* blk_realloc(void* cbp, EHTR_PTR trp)
+{
+   void* bp;
+   if (movable || region)
+   {
+      if (trp->sz == 0)
+      {
+         if (cbp != NULL)
+            blk_free(cbp);
+         return NULL;
+      }
+      if ((bp = blk_alloc(trp)) != NULL && cbp != NULL)
+         blk_free(cbp);
+      return bp;
+   }
+   return eh_Realloc(cbp, trp->sz, trp->an, hn);
+}
+
+/*
+*  bmap_find() -- Find target block pointer in block map. If not found and
+*  add is true, adds it. Returns NULL if not found and not added.
+*/
+static BMAP* bmap_find(u32 tbp, bool add)
+{
+   BMAP* del = NULL;  /* first deleted entry */
+   u32   i;
+
+   for (i = (tbp >> 3) & (bmapn - 1); bmap[i].tbp != 0; i = (i + 1) & (bmapn - 1))
+   {
+      if (bmap[i].tbp == tbp)
+         return &bmap[i];
+      if (bmap[i].tbp == 1 && del == NULL)
+         del = &bmap[i];
+   }
+   if (!add)
+      return NULL;
+   if (del == NULL)
+      del = &bmap[i];
+   del->tbp = tbp;
+   del->hbp = NULL;
+   return del;
+}
+
+/*
+*  heap_mgr() -- Heap management, as done by smx_HeapManager() in sys.c.
+*/
+static void heap_mgr(void)
+{
+   static u32  bin = 0;
+   static u32  scan = 5;
+   CCB_PTR     tblcp;   /* top bin last chunk pointer */
+   u32         tblcsz;  /* top bin last chunk size */
+   u32         tcsz;    /* top chunk size */
+
+   eh_BinSort(100, 2, hn);
+   if (--scan == 0)
+   {
+      eh_Scan(NULL, 4, 4, hn);
+      scan = 5;
+   }
+   if (eh_BinScan(bin, 2, 10, hn))
+      bin = (bin == hv.top_bin ? 0 : bin + 1);
+  #if EH_HANDLES
+   if (movable)
+      eh_Compact(cmpn, hn);
+  #endif
+
+   if (amerge)
+   {
+      tcsz = hv.tcp->sz;
+      if (hv.tbsz + tcsz < hsz/4)
+         hv.mode.fl.cmerge = ON;
+      else
+      {
+         tblcp  = bins[hv.top_bin].fbl;
+         tblcsz = (tblcp == NULL ? 0 : tblcp->sz);
+         hv.mode.fl.cmerge = (tblcsz < cszmax && tcsz < cszmax);
+      }
+   }
+}
+
+/*
+*  heap_sample() -- Walk the heap and record free space, largest free chunk,
+*  and fragmentation = 1 - largest free chunk/free space.
+*/
+static void heap_sample(u32 time)
+{
+   CCB_PTR  cp;
+   double   frag;
+   u32      csz;
+   u32      fsp = 0;    /* free space */
+   u32      lfc = 0;    /* largest free chunk */
+
+   for (cp = (CCB_PTR)hv.pi; cp != NULL && cp < (CCB_PTR)hv.px; cp = cp->fl)
+   {
+      if (EH_IS_FREE(cp))
+      {
+         csz = (u32)cp->fl - (u32)cp;
+         fsp += csz;
+         if (csz > lfc)
+            lfc = csz;
+      }
+   }
+   frag = (fsp == 0 ? 0.0 : 1.0 - (double)lfc/fsp);
+   if (frag > frag_peak)
+   {
+      frag_peak = frag;
+      frag_peak_op = opn;
+   }
+   if (lfc < lfc_min)
+   {
+      lfc_min = lfc;
+      lfc_min_op = opn;
+   }
+   if (csv != NULL)
+      fprintf(csv, "%u,%u,%u,%u,%u,%.4f\n", opn, time, hv.hused, fsp, lfc, frag);
+
+  #if EH_BUDDY
+   /* buddy arena fragmentation */
+   if (bdan > 0)
+   {
+      fsp = eh_BuddyPeek(EH_PK_SPACE, hn);
+      frag = (fsp == 0 ? 0.0 : 1.0 - (double)eh_BuddyPeek(EH_PK_LARGEST, hn)/fsp);
+      if (frag > bfrag_peak)
+      {
+         bfrag_peak = frag;
+         bfrag_peak_op = opn;
+      }
+   }
+  #endif
+}
+
+/*
+*  lat_add() -- Add latency sample for operation.
+*/
+static void lat_add(u32 op, u32 ns)
+{
+   lat[op].ns[lat[op].n++] = ns;
+}
+
+static int lat_cmp(const void* a, const void* b)
+{
+   u32 x = *(const u32*)a;
+   u32 y = *(const u32*)b;
+   return (x > y) - (x < y);
+}
+
+/*
+*  lat_report() -- Print latency distribution of an operation.
+*/
+static void lat_report(LAT* lp)
+{
+   double   sum = 0;
+   u32      i;
+
+   if (lp->n == 0)
+      return;
+   qsort(lp->ns, lp->n, sizeof(u32), lat_cmp);
+   for (i = 0; i < lp->n; i++)
+      sum += lp->ns[i];
+   printf("%-8s %8u %8u %8u %8u %8u %8.0f %6u\n", lp->name, lp->n, lp->ns[0],
+          lp->ns[lp->n/2], lp->ns[(u32)(lp->n*0.99)], lp->ns[lp->n - 1],
+          sum/lp->n, lp->fails);
+   if (lp->blks > 0)
+      printf("%-8s %8u blocks, %.0f ns per block\n", "", lp->blks, sum/lp->blks);
+}
+
+/*
+*  now_ns() -- Host monotonic time in ns (wraps).
+*/
+static u32 now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (u32)(ts.tv_sec*1000000000ULL + ts.tv_nsec);
+}
+
+/*
+*  read_bins() -- Read bin sizes from a text file.
+*/
+static bool read_bins(const char* fname)
+{
+   char  buf[1024];
+   char* e;
+   FILE* fp;
+   u32   i;
+   char* p;
+   u32   sz;
+
+   if ((fp = fopen(fname, "r")) == NULL)
+   {
+      printf("cannot open %s\n", fname);
+      return false;
+   }
+   buf[fread(buf, 1, sizeof(buf) - 1, fp)] = 0;
+   fclose(fp);
+
+   for (i = 0, p = buf; i < 32; i++)
+   {
+      sz = strtoul(p, &e, 0);
+      if (e == p || sz == 0xFFFFFFFF)
+         break;
+      binsz[i] = sz;
+      for (p = e; *p == ',' || *p == ' '; p++) {}
+   }
+   binsz[i] = 0xFFFFFFFF;
+   return true;
+}
+
+/*
+*  replay() -- Replay trace records for heap hn, in order. <4>
+*/
+static void replay(EHTR_PTR trp)
+{
+   void*    bp;      /* host block pointer */
+   BMAP*    mp;      /* block map entry */
+   void*    cbp;     /* host current block pointer */
+   u32      k;       /* records replayed */
+   u32      t0;      /* start time */
+
+   for (; trp->op != EH_TR_NONE; trp++)
+   {
+      if (trp->hn != trhn)
+         continue;
+      k = 1;
+
+     #if EH_OSTATS
+      site = trp->sz;
+     #endif
+      switch (trp->op)
+      {
+         case EH_TR_CALLOC:
+         case EH_TR_MALLOC:
+            if ((k = batch(trp)) > 1)
+            {
+               trp += k - 1;
+               break;
+            }
+            t0 = now_ns();
+            bp = blk_alloc(trp);
+            lat_add(trp->op, now_ns() - t0);
+            if (trp->bp != 0)
+            {
+               if (bp == NULL)
+                  lat[trp->op].fails++;
+               else
+                  bmap_find(trp->bp, true)->hbp = bp;
+            }
+            else if (bp != NULL)
+               blk_free(bp);  /* failed on target */
+            break;
+
+         case EH_TR_FREE:
+            if ((k = batch(trp)) > 1)
+            {
+               trp += k - 1;
+               break;
+            }
+            if ((mp = bmap_find(trp->bp, false)) == NULL)
+            {
+               unmatched++;
+               continue;
+            }
+            t0 = now_ns();
+            if (!blk_free(mp->hbp))
+               lat[trp->op].fails++;
+            lat_add(trp->op, now_ns() - t0);
+            mp->tbp = 1;
+            break;
+
+         case EH_TR_REALLOC:
+            mp  = NULL;
+            cbp = NULL;
+            if (trp->cbp != 0)
+            {
+               if ((mp = bmap_find(trp->cbp, false)) == NULL)
+               {
+                  unmatched++;
+                  continue;
+               }
+               cbp = mp->hbp;
+            }
+            t0 = now_ns();
+            bp = blk_realloc(cbp, trp);
+            lat_add(trp->op, now_ns() - t0);
+            if (trp->sz == 0 && mp != NULL)  /* block freed */
+               mp->tbp = 1;
+            else if (bp == NULL)             /* old block is unchanged */
+            {
+               if (trp->bp != 0)
+                  lat[trp->op].fails++;
+            }
+            else if (trp->bp == 0)           /* failed on target */
+            {
+               if (mp != NULL)
+                  mp->hbp = bp;
+               else
+                  blk_free(bp);
+            }
+            else
+            {
+               if (mp != NULL)
+                  mp->tbp = 1;
+               bmap_find(trp->bp, true)->hbp = bp;
+            }
+            break;
+
+         default:
+            continue;
+      }
+
+      for (; k > 0; k--)
+      {
+         opn++;
+         if (hv.hused > used_peak)
+            used_peak = hv.hused;
+         if (mgrn != 0 && opn % mgrn == 0)
+            heap_mgr();
+         if (smpn != 0 && opn % smpn == 0)
+            heap_sample(trp->time);
+      }
+   }
+}
+
+/*
+*  soak() -- Makes a synthetic trace of n operations. Short-lived blocks are
+*  freed soon, in random order, and long-lived blocks are freed rarely, so 
+*  long-lived blocks pin free space between them, as in a long-running 
+*  system. With -t, short-lived blocks are allocated and freed in groups of
+*  1 to batchn small blocks. With -l, some short-lived blocks are 
+*  reallocated before they are freed. Uses a fixed seed, so runs are 
+*  repeatable. <7>
+*/
+#define SOAK_NS   32    /* maximum live short-lived blocks */
+#define SOAK_NL   16    /* maximum live long-lived blocks */
+
+static EHTR_PTR soak(u32 n)
+{
+   u32      g;               /* group size */
+   u32      i, j, k, r;
+   u32      id = 0;          /* target block id */
+   u32      lb[SOAK_NL];     /* live long-lived block ids */
+   u32      nl = 0;          /* number of live long-lived blocks */
+   u32      ns = 0;          /* number of live short-lived blocks */
+   u32      sb[SOAK_NS];     /* live short-lived block or group ids */
+   u32      sg[SOAK_NS];     /* live short-lived group sizes */
+   EHTR_PTR trp;
+
+   trp = (EHTR_PTR)calloc(n + 1, sizeof(EHTR));
+   srand(1);
+
+   for (i = 0; i < n; i++)
+   {
+      trp[i].time = i;
+      trp[i].hn = (u8)trhn;
+      /* reallocate a short-lived block, not in a group, to a new size */
+      if (rlcpct > 0 && ns > 0 && (u32)(rand() % 100) < rlcpct)
+      {
+         j = rand() % ns;
+         if (sg[j] == 1)
+         {
+            trp[i].op = EH_TR_REALLOC;
+            trp[i].cbp = sb[j];
+            trp[i].sz = 16 + rand() % 496;
+            trp[i].bp = sb[j] = (id += 8);
+            continue;
+         }
+      }
+      r = rand() % 100;
+
+      if (ns == SOAK_NS || (ns > 0 && r < 45))
+      {
+         /* free a short-lived block or group */
+         j = rand() % ns;
+         for (k = 0; k < sg[j] && i < n; k++, i++)
+         {
+            trp[i].time = i;
+            trp[i].hn = (u8)trhn;
+            trp[i].op = EH_TR_FREE;
+            trp[i].bp = sb[j] + 8*k;
+         }
+         i--;
+         ns--;
+         sb[j] = sb[ns];
+         sg[j] = sg[ns];
+      }
+      else if (nl == SOAK_NL || (nl > 0 && r < 47))
+      {
+         /* free a long-lived block */
+         j = rand() % nl;
+         trp[i].op = EH_TR_FREE;
+         trp[i].bp = lb[j];
+         lb[j] = lb[--nl];
+      }
+      else
+      {
+         /* allocate a small, medium, or large block */
+         r = rand() % 100;
+         if (r < 70)
+            trp[i].sz = 16 + rand() % 240;
+         else if (r < 95)
+            trp[i].sz = 256 + rand() % 1792;
+         else
+            trp[i].sz = 2048 + rand() % 6144;
+         trp[i].op = EH_TR_MALLOC;
+         trp[i].bp = (id += 8);
+         if (rand() % 10 == 0)
+            lb[nl++] = id;
+         else
+         {
+            /* add small blocks to make a group */
+            g = (batchn > 1 ? 1 + rand() % batchn : 1);
+            sb[ns] = id;
+            for (k = 1; k < g && i + 1 < n; k++)
+            {
+               i++;
+               trp[i].time = i;
+               trp[i].hn = (u8)trhn;
+               trp[i].sz = 16 + rand() % 240;
+               trp[i].op = EH_TR_MALLOC;
+               trp[i].bp = (id += 8);
+            }
+            sg[ns++] = k;
+         }
+      }
+   }
+   return trp;
+}
+
+/* Notes:
+   1. The host heap has the configuration in eheap.h, except for the options.
+      eh_time() returns the operation number, so debug chunks show when they
+      were allocated, in operations. Latencies are host times, which show the
+      relative cost of operations and configurations, but not target times.
+   2. Blocks are identified by their target block pointers, which are mapped
+      to host block pointers by an open-addressed hash table. An operation on
+      a block that was allocated before the oldest record, is unmatched and
+      skipped.
+   3. If the ring has wrapped, eh_tri must be given with -i to find the oldest
+      record. If eh_tri < ring size, it limits the records replayed.
+   4. A host operation that fails when the target operation succeeded is
+      counted as a failure. A block that the target failed to allocate is
+      freed, if the host allocated it.
+   5. The trace does not record call sites, so with EH_OSTATS the requested
+      size is used as the site, which fills the site array about as a real
+      application would. To measure the cost of EH_OSTATS, replay the same
+      trace with -g, with EH_OSTATS 0 and 1, and compare the latencies. With
+      -g, the blocks held by all sites at the end are reported; they include
+      the pool blocks in use.
+   6. With -k, every block is a handle block, which is unlocked between 
+      operations, so any block can be moved by eh_Compact(). This shows the
+      best case for compaction. A realloc gets a new handle block and frees
+      the old one, without copying, since block contents are not replayed.
+   7. A soak test run without and with -k shows the effect of compaction on
+      the largest free chunk over time (-o), on the minimum largest free 
+      chunk, and on failed allocations. Soak allocations are all from heap 
+      -n. Use -h to change heap pressure.
+   8. With -e, every block is allocated as an ARMv7-M MPU region without 
+      subregions, i.e. eh_Malloc(2^rn, rn), where 2^rn >= the block size. A 
+      realloc gets a new region and frees the old one. With -u, the buddy
+      arena is taken from the heap first, so the heap peak frag and largest
+      free chunk are for the rest of the heap, and buddy peak frag is 
+      1 - largest free arena block/free arena space. Comparing the latencies
+      and failures with and without -u shows the cost of aligned chunk 
+      searches against buddy splits and merges. See eheap.h note 10.
+   9. With -t, a run of consecutive malloc records for heap -n, or of free 
+      records, is replayed with one eh_MallocM() or eh_FreeM(), whose time 
+      is a mallocm or freem sample, per batch. ns per block is comparable 
+      with the malloc and free means of the same trace replayed with -z. A 
+      soak test makes runs of both, since each group is allocated together
+      and freed together. The host time does not include a heap mutex, which
+      a batch also takes once on the target. Callocs, aligned mallocs, and 
+      unmatched frees end a run. See eheap.h note 11.
+  10. With -l, a realloc in the soak test gets a random size from 16 to 511
+      bytes, so about half grow and half shrink. The reallocs line reports
+      how many kept their block. To see what growing in place saves, 
+      compare with a build in which eh_Realloc() does not call 
+      chunk_grow().
+*/
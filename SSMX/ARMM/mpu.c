@@ -1005,6 +1005,19 @@ u8* mp_RegionGetHeap(u32 sz, u32 hn, u32* psrd)
       rs <<= 1;
    }
 
+  #if EH_BUDDY
+   /* get whole region from buddy arena, if it has a big enough block <14> */
+   if (hn < eh_hvpn && eh_hvp[hn]->bdap != NULL && 
+                                 smx_HeapBuddyPeek(EH_PK_LARGEST, hn) >= rs)
+   {
+      if ((bp = (u8*)smx_HeapBuddyGet(rs, hn)) != NULL)
+      {
+         *psrd = 0;
+         return bp;
+      }
+   }
+  #endif
+
    if (rs <= 128) /* region has no subregions */
    {
       bp = (u8*)smx_HeapMalloc(rs, rn, hn);
@@ -1099,5 +1112,11 @@ u8* mp_RegionGetHeap(u32 sz, u32 hn, u32* psrd)
   13. *ARMM_MPU_CTRL = 1; cannot be used here if MP_MPA_DEV = 0 because the
       intervening assembly code changes the register storing the ARMM_MPU_CTRL
       address.
+  14. If heap hn has a buddy arena (see eheap.h note 10), a region is a whole
+      2^rn block from it, with no subregions disabled, so it leaves no odd-
+      sized pieces in the heap. If the arena has no block big enough, the 
+      region comes from the heap, as before. Either kind is freed by 
+      smx_HeapFree(). Task stacks and pmsg and pblock regions all come 
+      through here, via mp_RegionGetHeapT() or mp_RegionGetHeapR().
 */
 #endif /* SMX_CFG_SSMX */
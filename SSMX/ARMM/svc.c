@@ -59,19 +59,24 @@ u8 sbu_BSP_SD_Init(void);
 
 /* main system service table indices */
 enum ssndx {LIM, AS, ASL, BG, BM, BP, BR, BRA, BU, BPC, BPD, BPP, 
+            CVB, CVCR, CVD, CVS, CVW, 
             EFP, EFS, EFT, EFTS, EGC, EGCR, EGD, EGP, EQCL, 
             EQC, EQCT, EQCR, EQD, EQP, EQS, HBP, HBS, HBSR, 
             HC, HCP, HF, HM, HP, HR,
            #if defined(SMX_DEBUG)
             HTA, HTD, HTGH, HTGN,
            #endif
-            MB, MG, MM, MP, MR, MRS, MRL, MRLA, MS, MU, MXC, MXCR, MXD, MXP, 
+            MB, MG, MGS, MM, MP, MR,
+           #if SMX_SIZE_XSEL
+            MRA,
+           #endif
+            MRM, MRS, MRL, MRLA, MRLM, MS, MU, MXC, MXCR, MXD, MXP, 
             MUC, MUCR, MUD, MUF, MUG, MUGS, MUP, MUR, 
             PBGH, PBGP, PBM, PBRH, PBRP, 
             PIC, PICR, PID, PIG8, PIG8M, PIGP, PIGPW, PIGPWS, PIP8, PIP8M, PIPP, 
-            PIPPW, PIPPWS, PIP, PIR, 
+            PIPPW, PIPPWS, PIP, PIPW, PIR, 
             PMGH, PMGP, PMM, PMR, PMRS, PMRL, PMRP, PMS, PMSB, 
-            SC, SCR, SD, SP, SS, ST, STS, SPK, SPHC, SYT, SWI, 
+            SC, SCR, SD, SP, SS, SSN, ST, STS, STW, SPK, SPHC, SYT, SWI, 
             TB, TC, TCR, TD, TL, TLK, TLKC, TP, TR, TSET, TSL, TSLS, TS, TSN, 
             TSO, TSU, TU, TUQ, TY, 
             TMRD, TMRP, TMRR, TMRSP, TMRS, TMRSA, TMRSO,
@@ -111,6 +116,11 @@ u32 smx_sst[] = {
    (u32)smx_BlockPoolCreate,
    (u32)smx_BlockPoolDelete,
    (u32)smx_BlockPoolPeek,
+   (u32)smx_CondVarBroadcast,
+   (u32)smx_CondVarCreate,
+   (u32)smx_CondVarDelete,
+   (u32)smx_CondVarSignal,
+   (u32)smx_CondVarWait,
    (u32)smx_EventFlagsPulse,
    (u32)smx_EventFlagsSet,
    (u32)smx_EventFlagsTest,
@@ -143,12 +153,18 @@ u32 smx_sst[] = {
   #endif
    (u32)smx_MsgBump,
    (u32)smx_MsgGet,
+   (u32)smx_MsgGetSz,
    (u32)smx_MsgMake,
    (u32)smx_MsgPeek,
    (u32)smx_MsgReceive,
+  #if SMX_SIZE_XSEL
+   (u32)smx_MsgReceiveAny,
+  #endif
+   (u32)smx_MsgReceiveM,
    (u32)smx_MsgReceiveStop,
    (u32)smx_MsgRel,
    (u32)smx_MsgRelAll,
+   (u32)smx_MsgRelM,
    (u32)smx_MsgSend,
    (u32)smx_MsgUnmake,
    (u32)smx_MsgXchgClear,
@@ -182,6 +198,7 @@ u32 smx_sst[] = {
    (u32)smx_PipePutPktWait,
    (u32)smx_PipePutPktWaitStop,
    (u32)smx_PipePeek,
+   (u32)smx_PipePeekWait,
    (u32)smx_PipeResume,
    (u32)smx_PMsgGetHeap,
    (u32)smx_PMsgGetPool,
@@ -197,8 +214,10 @@ u32 smx_sst[] = {
    (u32)smx_SemDelete,
    (u32)smx_SemPeek,
    (u32)smx_SemSignal,
+   (u32)smx_SemSignalN,
    (u32)smx_SemTest,
    (u32)smx_SemTestStop,
+   (u32)smx_SemTestWrtr,
    (u32)smx_SysPeek,  
    (u32)smx_SysPseudoHandleCreate,
    (u32)smx_SysTest,
@@ -332,6 +351,31 @@ NI u32 smxu_BlockPoolPeek(PCB_PTR pool, SMX_PK_PAR par)
    sb_SVC(BPP)
 }
 
+NI bool smxu_CondVarBroadcast(CVCB_PTR cv)
+{
+   sb_SVC(CVB)
+}
+
+NI CVCB_PTR smxu_CondVarCreate(const char* name, CVCB_PTR* cvhp)
+{
+   sb_SVC(CVCR)
+}
+
+NI bool smxu_CondVarDelete(CVCB_PTR* cvhp)
+{
+   sb_SVC(CVD)
+}
+
+NI bool smxu_CondVarSignal(CVCB_PTR cv)
+{
+   sb_SVC(CVS)
+}
+
+NI bool smxu_CondVarWait(CVCB_PTR cv, MUCB_PTR mtx, u32 timeout)
+{
+   sb_SVC(CVW)
+}
+
 NI bool smxu_EventFlagsPulse(EGCB_PTR eg, u16 pulse_mask)
 {
    sb_SVC(EFP)
@@ -501,6 +545,11 @@ NI MCB_PTR smxu_MsgGet(PCB_PTR pool, u8 **bpp, u16 clrsz, MCB_PTR* mhp)
    sb_SVC(MG)
 }
 
+NI MCB_PTR smxu_MsgGetSz(MPS_PTR set, u32 sz, u8 **bpp, u16 clrsz, MCB_PTR* mhp)
+{
+   sb_SVCG4(MGS)
+}
+
 NI MCB_PTR smxu_MsgMake(u8 *bp, u32 bs, u8 pri, MCB_PTR* mhp)
 {
    sb_SVC(MM)
@@ -516,6 +565,27 @@ NI MCB_PTR smxu_MsgReceive(XCB_PTR xchg, u8 **bpp, u32 timeout, MCB_PTR* mhp)
    sb_SVC(MR)
 }
 
+#if SMX_SIZE_XSEL
+NI MCB_PTR smxu_MsgReceiveAnyS(XCB_PTR* xl, u32 num, u8 **bpp, u32 timeout, MCB_PTR* mhp, u32* xip)
+{
+   sb_SVCG4(MRA)
+}
+
+/* *xip is loaded here, in umode, since the SSR returns before ct gets msg. */
+MCB_PTR smxu_MsgReceiveAny(XCB_PTR* xl, u32 num, u8 **bpp, u32 timeout, MCB_PTR* mhp, u32* xip)
+{
+   MCB_PTR msg = smxu_MsgReceiveAnyS(xl, num, bpp, timeout, mhp, NULL);
+   if (msg != NULL && xip != NULL)
+      *xip = smxu_TaskPeek(SMX_CT, SMX_PK_XCHG);
+   return msg;
+}
+#endif
+
+NI u32 smxu_MsgReceiveM(XCB_PTR xchg, MCB_PTR* mcba, u32 max, u32 timeout)
+{
+   sb_SVC(MRM)
+}
+
 NI void smxu_MsgReceiveStop(XCB_PTR xchg, u8 **bpp, u32 timeout, MCB_PTR* mhp)
 {
    sb_SVC(MRS)
@@ -531,6 +601,11 @@ NI u32 smxu_MsgRelAll(TCB_PTR task)
    sb_SVC(MRLA)
 }
 
+NI u32 smxu_MsgRelM(MCB_PTR* mcba, u32 n, u16 clrsz)
+{
+   sb_SVC(MRLM)
+}
+
 NI bool smxu_MsgSend(MCB_PTR msg, XCB_PTR xchg, u8 pri, void *reply)
 {
    sb_SVC(MS)
@@ -601,6 +676,35 @@ NI bool smxu_MutexRel(MUCB_PTR mtx)
    sb_SVC(MUR)
 }
 
+/* umode mutex fast path <3> */
+bool smxu_MutexGetU(UMTX_PTR um, u32 timeout)
+{
+   if (__LDREX((unsigned long*)&um->lock) == 0)
+   {
+      if (__STREX((unsigned long)smxu_ct, (unsigned long*)&um->lock) == 0)
+      {
+         __DMB();
+         return true;
+      }
+   }
+   else
+      __CLREX();
+   return smxu_MutexGet(um->mtx, timeout);
+}
+
+bool smxu_MutexRelU(UMTX_PTR um)
+{
+   __DMB();
+   if (__LDREX((unsigned long*)&um->lock) == (unsigned long)smxu_ct)
+   {
+      if (__STREX(0, (unsigned long*)&um->lock) == 0)
+         return true;
+   }
+   else
+      __CLREX();
+   return smxu_MutexRel(um->mtx);
+}
+
 NI u8* smxu_PBlockGetHeap(u32 sz, u8 sn, u32 attr, const char* name, u32 hn)
 {
    sb_SVCHG4(PBGH)
@@ -631,7 +735,7 @@ NI bool smxu_PipeClear(PICB_PTR pipe)
    sb_SVC(PIC)
 }
 
-NI PICB_PTR smxu_PipeCreate(void *ppb, u8 width, u16 length, const char *name, PICB_PTR* php)
+NI PICB_PTR smxu_PipeCreate(void *ppb, u16 width, u16 length, const char *name, PICB_PTR* php)
 {
    sb_SVCG4(PICR)
 }
@@ -696,6 +800,11 @@ NI u32 smxu_PipePeek(PICB_PTR pipe, SMX_PK_PAR par)
    sb_SVC(PIP)
 }
 
+NI bool smxu_PipePeekWait(PICB_PTR pipe, void *pdst, u32 timeout)
+{
+   sb_SVC(PIPW)
+}
+
 NI bool smxu_PipeResume(PICB_PTR pipe)
 {
    sb_SVC(PIR)
@@ -751,7 +860,7 @@ NI bool smxu_SemClear(SCB_PTR sem)
    sb_SVC(SC)
 }
 
-NI SCB_PTR smxu_SemCreate(SMX_SEM_MODE mode, u8 lim, const char *name, SCB_PTR* shp)
+NI SCB_PTR smxu_SemCreate(SMX_SEM_MODE mode, u32 lim, const char *name, SCB_PTR* shp)
 {
    sb_SVC(SCR)
 }
@@ -771,6 +880,11 @@ NI bool smxu_SemSignal(SCB_PTR sem)
    sb_SVC(SS)
 }
 
+NI bool smxu_SemSignalN(SCB_PTR sem, u32 n)
+{
+   sb_SVC(SSN)
+}
+
 NI bool smxu_SemTest(SCB_PTR sem, u32 timeout)
 {
    sb_SVC(ST)
@@ -781,6 +895,11 @@ NI void smxu_SemTestStop(SCB_PTR sem, u32 timeout)
    sb_SVC(STS)
 }
 
+NI bool smxu_SemTestWrtr(SCB_PTR sem, u32 timeout)
+{
+   sb_SVC(STW)
+}
+
 NI u32 smxu_SysPeek(SMX_PK_PAR par)
 {
    sb_SVC(SPK)
@@ -1144,5 +1263,8 @@ NI void LPC313XMCI_SetClk(u32 mode)
       returns 0. If the mutex is gained, -2 is returned and a recall executes 
       and returns. (-2 is used because -1 is a valid return for some heap 
       functions.)
+   3. smxu_MutexGetU() and smxu_MutexRelU() are not SVC shells. They get or
+      release a free mutex by LDREX/STREX on its umode lock word and call
+      the SVC shells only if that fails. See xmtx.c note 7.
 */
 #endif /* SMX_CFG_SSMX */
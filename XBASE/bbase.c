@@ -258,26 +258,40 @@ u8* sb_BlockPoolDelete(PCB_PTR pool)
 *  1. Interrupt safe -- CAN BE USED IN ISRs.
 *  2. Will not clear beyond end of block.
 *  3. Always test that a valid block pointer has been returned before using it.
+*  4. Lock-free -- does not disable interrupts. pool->pn and pool->num_used
+*     are updated with LDREX/STREX. Exception entry and return clear the
+*     exclusive monitor, so if an ISR or task switch gets or releases a block
+*     of this pool between LDREX and STREX, STREX fails and the update is
+*     retried. This also prevents ABA, without a tag (single core only).
+*     See test/tbblock.c for a host stress test.
 */
 u8* sb_BlockGet(PCB_PTR pool, u16 clrsz)
 {
-   u32   is;   /* interrupt state */
    u8   *bp;   /* block pointer */
+   u16   n;
 
    /* check for valid pool */
    if (pool->cbtype != SB_CB_PCB)
       smx_ERROR_RET(SBE_INV_POOL, NULL, 0);
 
-   /* get next block and update pool->pn and pool->num_used, with interrupts 
-      disabled */
-   sb_INT_DISABLE_S(is);
-   bp = pool->pn;
+   /* pop next block from free list <4> */
+   do
+   {
+      bp = (u8*)__LDREX((unsigned long*)&pool->pn);
+      if (bp == NULL)
+      {
+         __CLREX();
+         break;
+      }
+   } while (__STREX((unsigned long)*(u8**)bp, (unsigned long*)&pool->pn));
+
+   /* increment pool->num_used */
    if (bp != NULL)
    {
-      pool->pn = *(u8**)bp;
-      pool->num_used++;
+      do
+         n = __LDREXH(&pool->num_used);
+      while (__STREXH(n + 1, &pool->num_used));
    }
-   sb_INT_ENABLE_R(is);
 
    /* clear clrsz bytes, up to block size */
    if ((clrsz != 0) && (bp != NULL))
@@ -346,11 +360,12 @@ u32 sb_BlockPoolPeek(PCB_PTR pool, SB_PK_PAR par)
 * Notes:
 *  1. Interrupt safe -- CAN BE USED IN ISRs.
 *  2. Will not clear beyond end of block.
+*  3. Lock-free -- does not disable interrupts. See sb_BlockGet() note 4.
 */
 bool sb_BlockRel(PCB_PTR pool, u8* bp, u16 clrsz)
 {
-   u32   is;               /* interrupt state */
    u32   s = pool->size;   /* block space */
+   u16   n;
 
    /* check parameters */
    if (pool->cbtype != SB_CB_PCB)
@@ -361,13 +376,15 @@ bool sb_BlockRel(PCB_PTR pool, u8* bp, u16 clrsz)
    /* set bp to the start of the block */
    bp = bp - (bp - pool->pi)%s;
 
-   /* link the block into the pool free list and decrement num_used with 
-      interrupts disabled */
-   sb_INT_DISABLE_S(is);
-   *(u32*)bp = (u32)pool->pn;
-   pool->pn = bp;
-   pool->num_used = (pool->num_used ? --pool->num_used : 0);
-   sb_INT_ENABLE_R(is);
+   /* push the block onto the pool free list <3> */
+   do
+      *(u32*)bp = __LDREX((unsigned long*)&pool->pn);
+   while (__STREX((unsigned long)bp, (unsigned long*)&pool->pn));
+
+   /* decrement pool->num_used */
+   do
+      n = __LDREXH(&pool->num_used);
+   while (__STREXH((n ? n - 1 : 0), &pool->num_used));
 
    /* clear bytes 4 thru clrsz-1, up to block end */
    if (clrsz > 4)
@@ -0,0 +1,277 @@
+/*
+* tbblock.c                                                 Version 6.0.0
+*
+* Host Stress Test of sb_BlockGet() and sb_BlockRel()
+*
+* Copyright (c) 2026 Micro Digital Inc.
+* All rights reserved. www.smxrtos.com
+*
+* SPDX-License-Identifier: GPL-2.0-only OR LicenseRef-MDI-Commercial
+*
+* This software, documentation, and accompanying materials are made available
+* under a dual license, either GPLv2 or Commercial. You may not use this file
+* except in compliance with either License. GPLv2 is at www.gnu.org/licenses.
+* It does not permit the incorporation of this code into proprietary programs.
+*
+* Commercial license and support services are available from Micro Digital.
+* Inquire at support@smxrtos.com.
+*
+* This Work embodies patents listed in smx.h. A patent license is hereby
+* granted to use these patents in this Work and Derivative Works, except in
+* another RTOS or OS.
+*
+* This entire comment block must be preserved in all copies of this file.
+*
+*****************************************************************************/
+
+/*
+*  Runs the sb_BlockGet() and sb_BlockRel() code from bbase.c in several
+*  host threads on one pool, with an emulated single-core exclusive monitor.
+*  See Notes. The two functions are copied out of bbase.c by sed, so the 
+*  code tested is the code in the tree:
+*
+*     cd XBASE/test
+*     sed -n '/^u8\* sb_BlockGet(/,/^}/p;/^bool sb_BlockRel(/,/^}/p' ../bbase.c > bblock.inc
+*     cc -O2 -pthread -o tbblock tbblock.c && ./tbblock
+*
+*  Usage: tbblock [threads [ops [yield [cas]]]]
+*     threads  number of threads (default 8)
+*     ops      total get or release operations (default 1600000)
+*     yield    yield after LDREX and before STREX, each with odds 1/yield;
+*              0 = never (default 4)
+*     cas      1 = compare-and-swap control instead of the monitor <2>
+*
+*  Returns 0 if no block was handed out twice and the pool is intact at
+*  the end.
+*/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* host model of the bbase.c environment */
+
+typedef uint8_t   u8;
+typedef uint16_t  u16;
+typedef uintptr_t u32;  /* pointer-sized, so *(u32*)bp holds a free link <1> */
+
+typedef enum {SB_CB_NULL, SB_CB_PCB} SB_CBTYPE;
+enum {SBE_INV_POOL = 1, SBE_INV_BP};
+
+typedef struct PCB {    /* fields of PCB used by the block functions */
+   SB_CBTYPE   cbtype;
+   u16         num;
+   u16         num_used;
+   u16         size;
+   u8*         pi;
+   u8*         pn;
+   u8*         px;
+} PCB, *PCB_PTR;
+
+#define smx_ERROR_RET(errnum, rv, sev)  return rv
+
+/* emulated exclusive monitor <1> */
+
+static pthread_mutex_t mon = PTHREAD_MUTEX_INITIALIZER;
+static unsigned long   mepoch;           /* successful STREX count */
+static int             cas;              /* compare-and-swap control <2> */
+static unsigned        yodds;            /* yield odds between LDREX and STREX */
+static unsigned long   retries;          /* failed STREX count */
+
+static __thread bool          armed;     /* monitor set by LDREX */
+static __thread unsigned long tepoch;    /* mepoch at LDREX */
+static __thread unsigned long tval;      /* value at LDREX */
+static __thread u32           seed;      /* random number state */
+
+static u32 Rand(void)
+{
+   seed = seed*1103515245 + 12345;
+   return (u32)(seed >> 8) & 0xFFFFFF;
+}
+
+static unsigned long Ldrex(unsigned long v)
+{
+   armed = true;
+   tepoch = mepoch;
+   tval = v;
+   return v;
+}
+
+static bool StrexFail(unsigned long cur)
+{
+   bool fail = !armed || (cas ? cur != tval : tepoch != mepoch);
+   armed = false;
+   if (fail)
+      retries++;
+   else
+      mepoch++;
+   return fail;
+}
+
+static void Yield(void)
+{
+   if (yodds && Rand()%yodds == 0)
+      sched_yield();
+}
+
+static unsigned long __LDREX(unsigned long* a)
+{
+   unsigned long v;
+   pthread_mutex_lock(&mon);
+   v = Ldrex(*a);
+   pthread_mutex_unlock(&mon);
+   Yield();
+   return v;
+}
+
+static int __STREX(unsigned long v, unsigned long* a)
+{
+   bool fail;
+   Yield();
+   pthread_mutex_lock(&mon);
+   if (!(fail = StrexFail(*a)))
+      *a = v;
+   pthread_mutex_unlock(&mon);
+   return fail;
+}
+
+static u16 __LDREXH(u16* a)
+{
+   u16 v;
+   pthread_mutex_lock(&mon);
+   v = (u16)Ldrex(*a);
+   pthread_mutex_unlock(&mon);
+   Yield();
+   return v;
+}
+
+static int __STREXH(u16 v, u16* a)
+{
+   bool fail;
+   Yield();
+   pthread_mutex_lock(&mon);
+   if (!(fail = StrexFail(*a)))
+      *a = v;
+   pthread_mutex_unlock(&mon);
+   return fail;
+}
+
+static void __CLREX(void)
+{
+   armed = false;
+}
+
+#include "bblock.inc"
+
+/* test */
+
+#define NUM    16       /* blocks in pool */
+#define SIZE   16       /* block size */
+#define HOLD   4        /* maximum blocks held by a thread */
+
+static PCB   pool;
+static u8    blocks[NUM*SIZE];
+static int   owner[NUM];      /* thread holding each block, 0 if none */
+static long  dbl;             /* blocks handed out while held */
+static long  nops;            /* operations per thread */
+
+static void* Thread(void* arg)
+{
+   int   id = (int)(intptr_t)arg;
+   u8*   held[HOLD];
+   int   nh = 0;
+   long  k;
+   int   i;
+
+   seed = (u32)id*7919 + 1;
+   for (k = 0; k < nops; k++)
+   {
+      if (nh < HOLD && (nh == 0 || Rand()%2))
+      {
+         if ((held[nh] = sb_BlockGet(&pool, 0)) != NULL)
+         {
+            i = (int)((held[nh] - pool.pi)/SIZE);
+            if (__atomic_exchange_n(&owner[i], id, __ATOMIC_SEQ_CST) != 0)
+               __atomic_add_fetch(&dbl, 1, __ATOMIC_SEQ_CST);
+            nh++;
+         }
+      }
+      else
+      {
+         nh--;
+         i = (int)((held[nh] - pool.pi)/SIZE);
+         __atomic_store_n(&owner[i], 0, __ATOMIC_SEQ_CST);
+         sb_BlockRel(&pool, held[nh], 0);
+      }
+   }
+   while (nh > 0)
+   {
+      nh--;
+      i = (int)((held[nh] - pool.pi)/SIZE);
+      __atomic_store_n(&owner[i], 0, __ATOMIC_SEQ_CST);
+      sb_BlockRel(&pool, held[nh], 0);
+   }
+   return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+   int        nt   = (argc > 1 ? atoi(argv[1]) : 8);
+   long       ops  = (argc > 2 ? atol(argv[2]) : 1600000);
+   pthread_t* th;
+   u8*        bp;
+   int        links = 0;
+   int        i;
+
+   yodds = (argc > 3 ? (unsigned)atoi(argv[3]) : 4);
+   cas   = (argc > 4 ? atoi(argv[4]) : 0);
+   nops  = ops/nt;
+
+   /* build pool as sb_BlockPoolCreate() does */
+   pool.cbtype = SB_CB_PCB;
+   pool.num  = NUM;
+   pool.size = SIZE;
+   pool.pi = pool.pn = blocks;
+   pool.px = blocks + (NUM - 1)*SIZE;
+   for (bp = blocks; bp < pool.px; bp += SIZE)
+      *(u8**)bp = bp + SIZE;
+   *(u8**)pool.px = NULL;
+
+   th = malloc(nt*sizeof(pthread_t));
+   for (i = 0; i < nt; i++)
+      pthread_create(&th[i], NULL, Thread, (void*)(intptr_t)(i + 1));
+   for (i = 0; i < nt; i++)
+      pthread_join(th[i], NULL);
+
+   /* count free list links, stopping at 4*NUM in case of a cycle */
+   for (bp = pool.pn; bp != NULL && links < 4*NUM; bp = *(u8**)bp)
+      links++;
+
+   printf("%s: threads %d, ops %ld, yield 1/%u: double-alloc %ld, "
+          "free list %d/%d, num_used %u, STREX retries %lu\n",
+          (cas ? "cas" : "monitor"), nt, nops*nt, yodds, dbl, links, NUM,
+          pool.num_used, retries);
+   return !(dbl == 0 && links == NUM && pool.num_used == 0);
+}
+
+/* Notes:
+   1. On single-core Cortex-M, exception entry and return clear the 
+      exclusive monitor, so a STREX fails if any other context ran since the
+      LDREX. Here, a STREX fails if any other thread did a successful STREX 
+      since the LDREX. All updates of pool->pn and pool->num_used go through
+      STREX, so this is the case that matters. One mutex serializes each 
+      LDREX and each STREX. u32 is pointer-sized on the host, so that the 
+      *(u32*)bp link store in sb_BlockRel() holds a whole pointer. Blocks
+      are gotten and released with clrsz = 0, so block contents are only 
+      ever free links. Then a corrupted free list still holds valid block
+      pointers, and the cas control runs to the end.
+   2. With cas = 1, STREX succeeds if the word still holds the value read by
+      LDREX, as a compare-and-swap would. That is open to ABA: another thread
+      can get a block, get the next one, and release the first again between
+      LDREX and STREX. The control shows that this test detects the failure
+      that the monitor prevents.
+*/
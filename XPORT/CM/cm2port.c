@@ -28,6 +28,17 @@
 #pragma section_prefix = ".fs"
 #endif
 
+/* message queue control block */
+typedef struct {
+   XCB_PTR     xchg;          /* exchange -- msgs in priority order */
+   PCB_PTR     pool;          /* msg block pool */
+   SCB_PTR     slots;         /* free msg slots */
+   u8*         bp;            /* pool buffer */
+   u32         msg_count;     /* capacity (msgs) */
+   u32         msg_size;      /* msg size (bytes) */
+   const char* name;          /* name */
+} CM_MQ, *CM_MQ_PTR;
+
 osKernelState_t osKernelGetState(void)
 {
    u32 state = smx_TaskPeek(SMX_CT, SMX_PK_STATE);
@@ -57,16 +68,45 @@ uint32_t osKernelGetTickCount(void )
    return((uint32_t)smx_SysPeek(SMX_PK_ETIME));
 }
 
+osStatus_t osMessageQueueDelete(osMessageQueueId_t mq_id)
+{
+   CM_MQ_PTR mq = (CM_MQ_PTR)mq_id;
+
+   if (mq == NULL)
+      return osErrorParameter;
+   osMessageQueueReset(mq_id);
+   if (!smx_MsgXchgDelete(&mq->xchg) || !smx_SemDelete(&mq->slots) ||
+       !smx_BlockPoolDelete(&mq->pool))
+      return osErrorResource;
+   smx_HeapFree(mq->bp, 0);
+   smx_HeapFree(mq, 0);
+   return osOK;
+}
+
 osStatus_t osMessageQueueGet(osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio, uint32_t timeout)
 {
+   CM_MQ_PTR   mq = (CM_MQ_PTR)mq_id;
    u32         err;
    osStatus_t  ret;
-   bool        status;
+   MCB_PTR     msg;
+   u8*         mbp;
 
-   status = smx_PipeGetPktWait((PICB_PTR)mq_id, msg_ptr, timeout);
+   if (mq == NULL || msg_ptr == NULL)
+      return osErrorParameter;
 
-   if (status == true)
+   msg = smx_MsgReceive(mq->xchg, &mbp, timeout, NULL);
+
+   if (msg != NULL)
+   {
+      memcpy(msg_ptr, mbp, mq->msg_size);
+      if (msg_prio != NULL)
+         *msg_prio = (uint8_t)smx_MsgPeek(msg, SMX_PK_PRI);
+      smx_MsgRel(msg, 0);
+      smx_SemSignal(mq->slots);
       ret = osOK;
+   }
+   else if (timeout == 0)
+      ret = osErrorResource;
    else
    {
       err = smx_TaskPeek(SMX_CT, SMX_PK_ERROR);
@@ -74,7 +114,7 @@ osStatus_t osMessageQueueGet(osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *m
          ret = osErrorTimeout;
       else
       {
-         if (mq_id == NULL || err == SMXE_WAIT_NOT_ALLOWED)
+         if (err == SMXE_WAIT_NOT_ALLOWED)
             ret = osErrorParameter;
          else
             ret = osErrorResource;
@@ -83,24 +123,101 @@ osStatus_t osMessageQueueGet(osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *m
    return ret;
 }
 
+uint32_t osMessageQueueGetCapacity(osMessageQueueId_t mq_id)
+{
+   CM_MQ_PTR mq = (CM_MQ_PTR)mq_id;
+   return (mq ? mq->msg_count : 0);
+}
+
+uint32_t osMessageQueueGetCount(osMessageQueueId_t mq_id)
+{
+   CM_MQ_PTR mq = (CM_MQ_PTR)mq_id;
+   return (mq ? mq->msg_count - smx_SemPeek(mq->slots, SMX_PK_COUNT) : 0);
+}
+
+uint32_t osMessageQueueGetMsgSize(osMessageQueueId_t mq_id)
+{
+   CM_MQ_PTR mq = (CM_MQ_PTR)mq_id;
+   return (mq ? mq->msg_size : 0);
+}
+
+const char *osMessageQueueGetName(osMessageQueueId_t mq_id)
+{
+   CM_MQ_PTR mq = (CM_MQ_PTR)mq_id;
+   return (mq ? mq->name : NULL);
+}
+
+uint32_t osMessageQueueGetSpace(osMessageQueueId_t mq_id)
+{
+   CM_MQ_PTR mq = (CM_MQ_PTR)mq_id;
+   return (mq ? smx_SemPeek(mq->slots, SMX_PK_COUNT) : 0);
+}
+
 osMessageQueueId_t osMessageQueueNew(uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t *attr)
 {
-   PICB_PTR xpipe;
-   void* ppb = smx_HeapMalloc(msg_size*msg_count, NULL, NULL); 
-   xpipe = smx_PipeCreate(ppb, msg_size, msg_count, NULL, NULL);
-   return((osMessageQueueId_t)xpipe);
+   CM_MQ_PTR mq;
+   u32       bsz = (msg_size + 3) & ~3;  /* block size must be a multiple of 4 */
+
+   if (msg_count == 0 || msg_count > 0xFFFF || msg_size == 0 || bsz > 0xFFFF)
+      return NULL;
+   if ((mq = (CM_MQ_PTR)smx_HeapMalloc(sizeof(CM_MQ), 0, 0)) == NULL)
+      return NULL;
+   memset(mq, 0, sizeof(CM_MQ));
+   mq->msg_count = msg_count;
+   mq->msg_size  = msg_size;
+   mq->name = (attr ? attr->name : NULL);
+   mq->bp = (u8*)smx_HeapMalloc(bsz*msg_count, 0, 0);
+   if (mq->bp != NULL)
+      mq->pool = smx_BlockPoolCreate(mq->bp, (u16)msg_count, (u16)bsz, mq->name, NULL);
+   if (mq->pool != NULL)
+      mq->slots = smx_SemCreate(SMX_SEM_RSRC, msg_count, mq->name, NULL);
+   if (mq->slots != NULL)
+      mq->xchg = smx_MsgXchgCreate(SMX_XCHG_NORM, mq->name, NULL);
+   if (mq->xchg == NULL)
+   {
+      if (mq->slots)
+         smx_SemDelete(&mq->slots);
+      if (mq->pool)
+         smx_BlockPoolDelete(&mq->pool);
+      if (mq->bp)
+         smx_HeapFree(mq->bp, 0);
+      smx_HeapFree(mq, 0);
+      return NULL;
+   }
+   return((osMessageQueueId_t)mq);
 }
 
 osStatus_t osMessageQueuePut(osMessageQueueId_t mq_id, const void *msg_ptr, uint8_t msg_prio, uint32_t timeout)
 {
+   CM_MQ_PTR   mq = (CM_MQ_PTR)mq_id;
    u32         err;
    osStatus_t  ret;
-   bool        status;
+   MCB_PTR     msg;
+   u8*         mbp;
 
-   status = smx_PipePutPktWait((PICB_PTR)mq_id, (void*)msg_ptr, timeout, SMX_PUT_TO_FRONT);
+   if (mq == NULL || msg_ptr == NULL)
+      return osErrorParameter;
 
-   if (status == true)
+   /* wait for a free slot, then send in priority order <1> */
+   if (smx_SemTest(mq->slots, timeout))
+   {
+      /* if out of MCBs, give the slot back */
+      if ((msg = smx_MsgGet(mq->pool, &mbp, 0, NULL)) == NULL)
+      {
+         smx_SemSignal(mq->slots);
+         return osErrorResource;
+      }
+      memcpy(mbp, msg_ptr, mq->msg_size);
+      if (!smx_MsgSend(msg, mq->xchg, msg_prio, NULL))
+      {
+         smx_MsgRel(msg, 0);
+         smx_SemSignal(mq->slots);
+         return osErrorResource;
+      }
       ret = osOK;
+   }
+   else if (timeout == 0)
+      ret = osErrorResource;
    else
    {
       err = smx_TaskPeek(SMX_CT, SMX_PK_ERROR);
@@ -108,15 +225,30 @@ osStatus_t osMessageQueuePut(osMessageQueueId_t mq_id, const void *msg_ptr, uint
          ret = osErrorTimeout;
       else
       {
-         if (mq_id == NULL || err == SMXE_WAIT_NOT_ALLOWED)
+         if (err == SMXE_WAIT_NOT_ALLOWED)
             ret = osErrorParameter;
          else
-            ret = osError;
+            ret = osErrorResource;
       }
    }
    return ret;
 }
 
+osStatus_t osMessageQueueReset(osMessageQueueId_t mq_id)
+{
+   CM_MQ_PTR mq = (CM_MQ_PTR)mq_id;
+   MCB_PTR   msg;
+
+   if (mq == NULL)
+      return osErrorParameter;
+   while ((msg = smx_MsgReceive(mq->xchg, NULL, SMX_TMO_NOWAIT, NULL)) != NULL)
+   {
+      smx_MsgRel(msg, 0);
+      smx_SemSignal(mq->slots);
+   }
+   return osOK;
+}
+
 osStatus_t osMutexAcquire (osMutexId_t mutex_id, uint32_t timeout)
 {
    u32         err;
@@ -168,4 +300,15 @@ osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const
    xsem = smx_SemCreate(SMX_SEM_RSRC, max_count, NULL, NULL);
    xsem->count = initial_count;
    return((osSemaphoreId_t)xsem);
-}
\ No newline at end of file
+}
+
+/* Notes:
+   1. A message queue is an smx exchange fed from a block pool, with a resource
+      semaphore counting free slots. smx_MsgSend() enqueues msgs by priority,
+      highest first and FIFO within a priority. A msg with priority 0 goes to
+      the end without a search, so the common single-priority case is O(1).
+      Each queued msg also uses an MCB, so SMX_NUM_MCBS must allow for them.
+      If none is free, osMessageQueuePut() gives the slot back and returns
+      osErrorResource. The message queue functions are tested on a host by
+      test/tcm2mq.c.
+*/
@@ -0,0 +1,100 @@
+/*
+* smx.h (host model)                                        Version 6.0.0
+*
+* Host Model of the smx Services Used by cm2port.c
+*
+* Copyright (c) 2025-2026 Micro Digital Inc.
+* All rights reserved. www.smxrtos.com
+*
+* This software is confidential and proprietary to Micro Digital Inc.
+* It has been furnished under a license and may be used, copied, or
+* disclosed only in accordance with the terms of that license and with
+* the inclusion of this header. No title to nor ownership of this
+* software is hereby transferred.
+*
+*******************************************************************************/
+
+/*
+*  Stands in for smx.h, xsmx.h, and xapiu.h when tcm2mq.c builds cm2port.c
+*  on a host. Only the types, constants, and functions that cm2port.c uses
+*  are defined, with the smx behavior that its message queues depend on.
+*  The functions are in tcm2mq.c.
+*/
+
+#ifndef SMX_H
+#define SMX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef uint8_t  u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+
+#define SMX_CFG_SSMX          0
+#define SMX_NUM_MCBS          8
+#define SMX_TMO_NOWAIT        0
+#define SMX_CT                NULL
+
+typedef enum {SMX_TASK_NULL, SMX_TASK_READY, SMX_TASK_RUN, SMX_TASK_WAIT} SMX_STATE;
+typedef enum {SMX_PK_COUNT, SMX_PK_ERROR, SMX_PK_ETIME, SMX_PK_LOCK, SMX_PK_PRI,
+              SMX_PK_STATE} SMX_PK_PAR;
+typedef enum {SMXE_OK, SMXE_TMO, SMXE_WAIT_NOT_ALLOWED, SMXE_INV_PAR} SMX_ERRNO;
+typedef enum {SMX_SEM_RSRC} SMX_SEM_MODE;
+typedef enum {SMX_XCHG_NORM} SMX_XCHG_MODE;
+typedef enum {SMX_PI} SMX_MTX_MODE;
+
+typedef struct PCB {       /* BLOCK POOL */
+   u8*         pi;            /* first block */
+   u32         used;          /* block in use bits (num <= 32) */
+   u16         num;           /* number of blocks */
+   u16         size;          /* block size */
+} PCB, *PCB_PTR;
+
+typedef struct MCB {       /* MESSAGE */
+   struct MCB* fl;            /* forward link in exchange */
+   u8*         bp;            /* message block */
+   PCB_PTR     pool;          /* pool of block */
+   u8          pri;           /* priority */
+   bool        inuse;
+} MCB, *MCB_PTR;
+
+typedef struct XCB {       /* EXCHANGE */
+   MCB_PTR     fl;            /* first msg */
+} XCB, *XCB_PTR;
+
+typedef struct SCB {       /* SEMAPHORE */
+   u32         count;
+   u32         lim;
+} SCB, *SCB_PTR;
+
+typedef struct MUCB {      /* MUTEX */
+   u32         nest;
+} MUCB, *MUCB_PTR;
+
+typedef struct TCB TCB, *TCB_PTR;
+
+void*    smx_HeapMalloc(u32 sz, u32 an, u32 hn);
+bool     smx_HeapFree(void* bp, u32 hn);
+PCB_PTR  smx_BlockPoolCreate(u8* p, u16 num, u16 size, const char* name, PCB_PTR* php);
+u8*      smx_BlockPoolDelete(PCB_PTR* php);
+SCB_PTR  smx_SemCreate(SMX_SEM_MODE mode, u32 lim, const char* name, SCB_PTR* shp);
+bool     smx_SemDelete(SCB_PTR* shp);
+u32      smx_SemPeek(SCB_PTR sem, SMX_PK_PAR par);
+bool     smx_SemSignal(SCB_PTR sem);
+bool     smx_SemTest(SCB_PTR sem, u32 timeout);
+XCB_PTR  smx_MsgXchgCreate(SMX_XCHG_MODE mode, const char* name, XCB_PTR* xhp);
+bool     smx_MsgXchgDelete(XCB_PTR* xhp);
+MCB_PTR  smx_MsgGet(PCB_PTR pool, u8** bpp, u16 clrsz, MCB_PTR* mhp);
+u32      smx_MsgPeek(MCB_PTR msg, SMX_PK_PAR par);
+MCB_PTR  smx_MsgReceive(XCB_PTR xchg, u8** bpp, u32 timeout, MCB_PTR* mhp);
+bool     smx_MsgRel(MCB_PTR msg, u16 clrsz);
+bool     smx_MsgSend(MCB_PTR msg, XCB_PTR xchg, u8 pri, void* reply);
+MUCB_PTR smx_MutexCreate(SMX_MTX_MODE mode, u8 ceiling, const char* name, MUCB_PTR* muhp);
+bool     smx_MutexDelete(MUCB_PTR* muhp);
+bool     smx_MutexFree(MUCB_PTR mtx);
+bool     smx_MutexGet(MUCB_PTR mtx, u32 timeout);
+u32      smx_SysPeek(SMX_PK_PAR par);
+u32      smx_TaskPeek(TCB_PTR task, SMX_PK_PAR par);
+
+#endif /* SMX_H */
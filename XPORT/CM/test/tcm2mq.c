@@ -0,0 +1,349 @@
+/*
+* tcm2mq.c                                                  Version 6.0.0
+*
+* Host Test of the CMSIS-RTOS2 Message Queue Functions
+*
+* Copyright (c) 2025-2026 Micro Digital Inc.
+* All rights reserved. www.smxrtos.com
+*
+* This software is confidential and proprietary to Micro Digital Inc.
+* It has been furnished under a license and may be used, copied, or
+* disclosed only in accordance with the terms of that license and with
+* the inclusion of this header. No title to nor ownership of this
+* software is hereby transferred.
+*
+*******************************************************************************/
+
+/*
+*  Builds cm2port.c against the host model of smx in smx.h and runs the
+*  osMessageQueue functions through their return codes. See Note 1.
+*
+*     cd XPORT/CM/test
+*     cc -I. -o tcm2mq tcm2mq.c && ./tcm2mq
+*/
+
+#include <stdio.h>
+#include "../cm2port.c"
+
+/* host model of smx */
+
+static u32  ct_err;                 /* current task error */
+static MCB  mcb[SMX_NUM_MCBS];      /* MCB pool */
+static SCB  scb[8];
+static XCB  xcb[8];
+static PCB  pcb[8];
+static MUCB mucb[4];
+
+static u8 scb_use[8], xcb_use[8], pcb_use[8], mucb_use[4];
+
+static int Claim(u8* use, int n)
+{
+   int i;
+   for (i = 0; i < n; i++)
+      if (!use[i])
+      {
+         use[i] = 1;
+         return i;
+      }
+   return -1;
+}
+
+void* smx_HeapMalloc(u32 sz, u32 an, u32 hn)
+{
+   return malloc(sz);
+}
+
+bool smx_HeapFree(void* bp, u32 hn)
+{
+   free(bp);
+   return true;
+}
+
+PCB_PTR smx_BlockPoolCreate(u8* p, u16 num, u16 size, const char* name, PCB_PTR* php)
+{
+   int i = Claim(pcb_use, 8);
+   if (i < 0 || num > 32)
+      return NULL;
+   pcb[i].pi = p;
+   pcb[i].used = 0;
+   pcb[i].num = num;
+   pcb[i].size = size;
+   return &pcb[i];
+}
+
+u8* smx_BlockPoolDelete(PCB_PTR* php)
+{
+   u8* p = (*php)->pi;
+   pcb_use[*php - pcb] = 0;
+   *php = NULL;
+   return p;
+}
+
+SCB_PTR smx_SemCreate(SMX_SEM_MODE mode, u32 lim, const char* name, SCB_PTR* shp)
+{
+   int i = Claim(scb_use, 8);
+   if (i < 0)
+      return NULL;
+   scb[i].count = scb[i].lim = lim;
+   return &scb[i];
+}
+
+bool smx_SemDelete(SCB_PTR* shp)
+{
+   scb_use[*shp - scb] = 0;
+   *shp = NULL;
+   return true;
+}
+
+u32 smx_SemPeek(SCB_PTR sem, SMX_PK_PAR par)
+{
+   return sem->count;
+}
+
+bool smx_SemSignal(SCB_PTR sem)
+{
+   if (sem->count < sem->lim)
+      sem->count++;
+   return true;
+}
+
+/* no other task runs, so a wait with timeout > 0 always times out and a
+   NOWAIT failure leaves ct_err stale, as smx does */
+bool smx_SemTest(SCB_PTR sem, u32 timeout)
+{
+   if (sem->count > 0)
+   {
+      sem->count--;
+      return true;
+   }
+   if (timeout != SMX_TMO_NOWAIT)
+      ct_err = SMXE_TMO;
+   return false;
+}
+
+XCB_PTR smx_MsgXchgCreate(SMX_XCHG_MODE mode, const char* name, XCB_PTR* xhp)
+{
+   int i = Claim(xcb_use, 8);
+   if (i < 0)
+      return NULL;
+   xcb[i].fl = NULL;
+   return &xcb[i];
+}
+
+bool smx_MsgXchgDelete(XCB_PTR* xhp)
+{
+   xcb_use[*xhp - xcb] = 0;
+   *xhp = NULL;
+   return true;
+}
+
+MCB_PTR smx_MsgGet(PCB_PTR pool, u8** bpp, u16 clrsz, MCB_PTR* mhp)
+{
+   MCB_PTR msg;
+   u16     n;
+   for (msg = mcb; msg < mcb + SMX_NUM_MCBS && msg->inuse; msg++) {}
+   for (n = 0; n < pool->num && (pool->used & (1u << n)); n++) {}
+   if (msg == mcb + SMX_NUM_MCBS || n == pool->num)
+      return NULL;
+   pool->used |= 1u << n;
+   msg->inuse = true;
+   msg->pool = pool;
+   msg->bp = pool->pi + n*pool->size;
+   msg->pri = 0;
+   *bpp = msg->bp;
+   return msg;
+}
+
+u32 smx_MsgPeek(MCB_PTR msg, SMX_PK_PAR par)
+{
+   return msg->pri;
+}
+
+MCB_PTR smx_MsgReceive(XCB_PTR xchg, u8** bpp, u32 timeout, MCB_PTR* mhp)
+{
+   MCB_PTR msg = xchg->fl;
+   if (msg == NULL)
+   {
+      if (timeout != SMX_TMO_NOWAIT)
+         ct_err = SMXE_TMO;
+      return NULL;
+   }
+   xchg->fl = msg->fl;
+   if (bpp != NULL)
+      *bpp = msg->bp;
+   return msg;
+}
+
+bool smx_MsgRel(MCB_PTR msg, u16 clrsz)
+{
+   msg->pool->used &= ~(1u << (msg->bp - msg->pool->pi)/msg->pool->size);
+   msg->inuse = false;
+   return true;
+}
+
+/* FIFO only. Priority order is not modeled <1>. */
+bool smx_MsgSend(MCB_PTR msg, XCB_PTR xchg, u8 pri, void* reply)
+{
+   MCB_PTR* pp = &xchg->fl;
+   msg->pri = pri;
+   while (*pp != NULL)
+      pp = &(*pp)->fl;
+   msg->fl = NULL;
+   *pp = msg;
+   return true;
+}
+
+MUCB_PTR smx_MutexCreate(SMX_MTX_MODE mode, u8 ceiling, const char* name, MUCB_PTR* muhp)
+{
+   int i = Claim(mucb_use, 4);
+   return (i < 0 ? NULL : &mucb[i]);
+}
+
+bool smx_MutexDelete(MUCB_PTR* muhp)
+{
+   mucb_use[*muhp - mucb] = 0;
+   return true;
+}
+
+bool smx_MutexFree(MUCB_PTR mtx)
+{
+   return true;
+}
+
+bool smx_MutexGet(MUCB_PTR mtx, u32 timeout)
+{
+   return true;
+}
+
+u32 smx_SysPeek(SMX_PK_PAR par)
+{
+   return 0;
+}
+
+u32 smx_TaskPeek(TCB_PTR task, SMX_PK_PAR par)
+{
+   return (par == SMX_PK_ERROR ? ct_err : 0);
+}
+
+/* tests */
+
+static int fails;
+
+#define CHECK(c)  do { if (!(c)) { printf("FAIL line %d: %s\n", __LINE__, #c); fails++; } } while (0)
+
+static void tm00(void)  /* create, attributes, delete */
+{
+   osMessageQueueAttr_t attr;
+   osMessageQueueId_t   mq;
+
+   memset(&attr, 0, sizeof(attr));
+   attr.name = "mq0";
+   CHECK(osMessageQueueNew(0, 4, NULL) == NULL);
+   CHECK(osMessageQueueNew(4, 0, NULL) == NULL);
+   CHECK(osMessageQueueNew(0x10000, 4, NULL) == NULL);
+   mq = osMessageQueueNew(4, 6, &attr);
+   CHECK(mq != NULL);
+   CHECK(osMessageQueueGetCapacity(mq) == 4);
+   CHECK(osMessageQueueGetMsgSize(mq) == 6);
+   CHECK(strcmp(osMessageQueueGetName(mq), "mq0") == 0);
+   CHECK(osMessageQueueGetCount(mq) == 0);
+   CHECK(osMessageQueueGetSpace(mq) == 4);
+   CHECK(osMessageQueueDelete(mq) == osOK);
+   CHECK(osMessageQueueGetCapacity(NULL) == 0);
+   CHECK(osMessageQueueGetCount(NULL) == 0);
+   CHECK(osMessageQueueGetSpace(NULL) == 0);
+   CHECK(osMessageQueueGetName(NULL) == NULL);
+}
+
+static void tm01(void)  /* priority passed to and from smx, odd msg size <1> */
+{
+   osMessageQueueId_t mq = osMessageQueueNew(4, 3, NULL);
+   char    m[3];
+   uint8_t pri;
+
+   CHECK(osMessageQueuePut(mq, "A1", 0, 0) == osOK);
+   CHECK(osMessageQueuePut(mq, "B1", 5, 0) == osOK);
+   CHECK(osMessageQueuePut(mq, "C1", 0, 0) == osOK);
+   CHECK(osMessageQueuePut(mq, "D1", 255, 0) == osOK);
+   CHECK(osMessageQueueGetCount(mq) == 4);
+   CHECK(osMessageQueueGetSpace(mq) == 0);
+   CHECK(osMessageQueueGet(mq, m, &pri, 0) == osOK && strcmp(m, "A1") == 0 && pri == 0);
+   CHECK(osMessageQueueGet(mq, m, &pri, 0) == osOK && strcmp(m, "B1") == 0 && pri == 5);
+   CHECK(osMessageQueueGet(mq, m, NULL, 0) == osOK && strcmp(m, "C1") == 0);
+   CHECK(osMessageQueueGet(mq, m, &pri, 0) == osOK && strcmp(m, "D1") == 0 && pri == 255);
+   CHECK(osMessageQueueGetCount(mq) == 0);
+   CHECK(osMessageQueueDelete(mq) == osOK);
+}
+
+static void tm02(void)  /* full and empty, with and without timeout */
+{
+   osMessageQueueId_t mq = osMessageQueueNew(2, 4, NULL);
+   u32 m = 0;
+
+   CHECK(osMessageQueuePut(mq, &m, 0, 0) == osOK);
+   CHECK(osMessageQueuePut(mq, &m, 0, 0) == osOK);
+   ct_err = SMXE_OK;
+   CHECK(osMessageQueuePut(mq, &m, 0, 0) == osErrorResource);
+   CHECK(osMessageQueuePut(mq, &m, 0, 10) == osErrorTimeout);
+   CHECK(osMessageQueuePut(mq, &m, 0, 0) == osErrorResource);   /* stale SMXE_TMO */
+   CHECK(osMessageQueueReset(mq) == osOK);
+   CHECK(osMessageQueueGetCount(mq) == 0 && osMessageQueueGetSpace(mq) == 2);
+   ct_err = SMXE_OK;
+   CHECK(osMessageQueueGet(mq, &m, NULL, 0) == osErrorResource);
+   CHECK(osMessageQueueGet(mq, &m, NULL, 10) == osErrorTimeout);
+   CHECK(osMessageQueueGet(mq, &m, NULL, 0) == osErrorResource);
+   CHECK(osMessageQueueDelete(mq) == osOK);
+}
+
+static void tm03(void)  /* out of MCBs */
+{
+   osMessageQueueId_t mq = osMessageQueueNew(2, 4, NULL);
+   osMessageQueueId_t mqx = osMessageQueueNew(SMX_NUM_MCBS, 4, NULL);
+   u32 m = 0x12345678, r = 0;
+   int i;
+
+   for (i = 0; i < SMX_NUM_MCBS; i++)
+      CHECK(osMessageQueuePut(mqx, &m, 0, 0) == osOK);
+   CHECK(osMessageQueuePut(mq, &m, 0, 0) == osErrorResource);
+   CHECK(osMessageQueueGetSpace(mq) == 2);
+   CHECK(osMessageQueueGet(mqx, &r, NULL, 0) == osOK && r == m);
+   CHECK(osMessageQueuePut(mq, &m, 0, 0) == osOK);
+   CHECK(osMessageQueueGetSpace(mq) == 1);
+   CHECK(osMessageQueueDelete(mqx) == osOK);
+   CHECK(osMessageQueueDelete(mq) == osOK);
+   for (i = 0; i < SMX_NUM_MCBS; i++)
+      CHECK(!mcb[i].inuse);
+}
+
+static void tm04(void)  /* invalid parameters */
+{
+   osMessageQueueId_t mq = osMessageQueueNew(2, 4, NULL);
+   u32 m = 0;
+
+   CHECK(osMessageQueuePut(NULL, &m, 0, 0) == osErrorParameter);
+   CHECK(osMessageQueuePut(mq, NULL, 0, 0) == osErrorParameter);
+   CHECK(osMessageQueueGet(NULL, &m, NULL, 0) == osErrorParameter);
+   CHECK(osMessageQueueGet(mq, NULL, NULL, 0) == osErrorParameter);
+   CHECK(osMessageQueueReset(NULL) == osErrorParameter);
+   CHECK(osMessageQueueDelete(NULL) == osErrorParameter);
+   CHECK(osMessageQueueDelete(mq) == osOK);
+}
+
+int main(void)
+{
+   tm00();
+   tm01();
+   tm02();
+   tm03();
+   tm04();
+   printf(fails ? "tcm2mq: %d failed\n" : "tcm2mq: passed\n", fails);
+   return (fails != 0);
+}
+
+/* Notes:
+   1. The smx functions here are a host model, not the kernel. In smx, 
+      smx_MsgSend() orders msgs by priority with smx_PNQMsg() in xsmx.c, 
+      which does not build on a host. The model keeps msgs in FIFO order, so
+      this test checks only that cm2port.c passes priorities to and from smx.
+      It does not test priority order.
+*/
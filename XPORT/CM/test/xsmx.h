@@ -0,0 +1 @@
+/* Host model: see smx.h in this directory. */
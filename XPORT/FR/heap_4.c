@@ -55,6 +55,7 @@ typedef struct A_BLOCK_LINK
 
 void * pvPortMalloc( size_t xWantedSize )
 {
+    smx_HEAP_SITE_SET();
     return (smx_HeapMalloc((u32)xWantedSize));
 }
 
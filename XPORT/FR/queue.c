@@ -34,6 +34,27 @@
 #include "task.h"
 #include "queue.h"
 
+#if ( configUSE_QUEUE_SETS == 1 )
+#ifndef configQUEUE_SET_MEMBERS
+#define configQUEUE_SET_MEMBERS  16   /* max queues and semaphores in all sets */
+#endif
+
+/* Queue set membership table <1> */
+static struct {
+    QueueSetMemberHandle_t member;
+    QueueSetHandle_t       set;
+} xQueueSetMembers[configQUEUE_SET_MEMBERS];
+
+static BaseType_t prvQueueIsEmpty( QueueSetMemberHandle_t xQueueOrSemaphore );
+static void       prvQueueNotifySet( QueueSetMemberHandle_t xQueueOrSemaphore );
+static void       prvQueueSetUnlink( void* handle );
+#define queueNOTIFY_SET(q, pass)  { if (pass) prvQueueNotifySet(q); }
+#else
+#define queueNOTIFY_SET(q, pass)
+#endif
+
+static BaseType_t prvQueueOverwrite( PICB_PTR pipe, const void * pvItemToQueue );
+
 /* Mutex Functions */
 
 QueueHandle_t xQueueCreateMutex( const uint8_t ucQueueType )
@@ -78,16 +99,38 @@ void vQueueAddToRegistry( QueueHandle_t xQueue,
 }
 
 
+#if ( configUSE_QUEUE_SETS == 1 )
 BaseType_t xQueueAddToSet( QueueSetMemberHandle_t xQueueOrSemaphore,
                            QueueSetHandle_t xQueueSet )
 {
-    return pdFAIL;
+    BaseType_t pass = pdFAIL;
+    u32 i, free = configQUEUE_SET_MEMBERS;
+
+    smx_LSRsOff();
+    for (i = 0; i < configQUEUE_SET_MEMBERS; i++)
+    {
+        if (xQueueSetMembers[i].member == xQueueOrSemaphore)
+            break;   /* already in a set */
+        if (xQueueSetMembers[i].member == NULL && free == configQUEUE_SET_MEMBERS)
+            free = i;
+    }
+    if (i == configQUEUE_SET_MEMBERS && free < configQUEUE_SET_MEMBERS &&
+        prvQueueIsEmpty(xQueueOrSemaphore))
+    {
+        xQueueSetMembers[free].member = xQueueOrSemaphore;
+        xQueueSetMembers[free].set = xQueueSet;
+        pass = pdPASS;
+    }
+    smx_LSRsOn();
+    return pass;
 }
 
 QueueSetHandle_t xQueueCreateSet( const UBaseType_t uxEventQueueLength )
 {
-    return NULL;
+    return (QueueSetHandle_t)xQueueGenericCreate(uxEventQueueLength, 
+                           sizeof(QueueSetMemberHandle_t), queueQUEUE_TYPE_SET);
 }
+#endif /* configUSE_QUEUE_SETS */
 
 BaseType_t xQueueCRReceive( QueueHandle_t xQueue,
                             void * pvBuffer,
@@ -120,6 +163,9 @@ BaseType_t xQueueCRSendFromISR( QueueHandle_t xQueue,
 void vQueueDelete( QueueHandle_t xQueue )
 {
     smx_LSRsOff();
+   #if ( configUSE_QUEUE_SETS == 1 )
+    prvQueueSetUnlink((void*)xQueue);
+   #endif
     switch (((CB_PTR)xQueue)->cbtype)
     {
         case SMX_CB_SEM:
@@ -144,10 +190,13 @@ QueueHandle_t xQueueGenericCreate( const UBaseType_t uxQueueLength,
     {
         PICB_PTR pipe;
         void* ppb;
+        if (uxItemSize == 0 || uxItemSize > 0xFFFF || uxQueueLength == 0 || uxQueueLength > 0xFFFF)
+            return NULL;
         smx_LSRsOff();
-        u16 len = (u16)uxQueueLength;
-        ppb = smx_HeapMalloc((u32)(uxItemSize*len));
-        pipe = smx_PipeCreate(ppb, (u8)uxItemSize, len);
+        ppb = smx_HeapMalloc((u32)(uxItemSize*uxQueueLength));
+        pipe = smx_PipeCreate(ppb, (u16)uxItemSize, (u16)uxQueueLength);
+        if (pipe == NULL && ppb != NULL)
+            smx_HeapFree(ppb);
         smx_LSRsOn();
         return (QueueHandle_t)pipe;
     }
@@ -164,8 +213,9 @@ QueueHandle_t xQueueGenericCreateStatic( const UBaseType_t uxQueueLength,
     else
     {
         PICB_PTR pipe;
-        u16 len = (u16)uxQueueLength;
-        pipe = smx_PipeCreate((void*)pucQueueStorage, (u8)uxItemSize, len);
+        if (uxItemSize == 0 || uxItemSize > 0xFFFF || uxQueueLength == 0 || uxQueueLength > 0xFFFF)
+            return NULL;
+        pipe = smx_PipeCreate((void*)pucQueueStorage, (u16)uxItemSize, (u16)uxQueueLength);
         return (QueueHandle_t)pipe;
     }
 }
@@ -182,21 +232,29 @@ BaseType_t xQueueGenericSend( QueueHandle_t xQueue,
                               TickType_t xTicksToWait,
                               const BaseType_t xCopyPosition)
 {
+    BaseType_t pass;
+
     switch (((CB_PTR)xQueue)->cbtype)
     {
         case SMX_CB_SEM:
-            return (BaseType_t)smx_SemSignal((SCB_PTR)xQueue);
+            pass = (BaseType_t)smx_SemSignal((SCB_PTR)xQueue);
+            queueNOTIFY_SET(xQueue, pass)
+            return pass;
             break;
         case SMX_CB_MTX:
             return (BaseType_t)smx_MutexRel((MUCB_PTR)xQueue);
             break;
         case SMX_CB_PIPE:
-            if (xCopyPosition == queueSEND_TO_FRONT || xCopyPosition == queueOVERWRITE)
-                return (BaseType_t)smx_PipePutPktWait((PICB_PTR)xQueue, 
+            if (xCopyPosition == queueOVERWRITE)
+                pass = prvQueueOverwrite((PICB_PTR)xQueue, pvItemToQueue);
+            else if (xCopyPosition == queueSEND_TO_FRONT)
+                pass = (BaseType_t)smx_PipePutPktWait((PICB_PTR)xQueue, 
                         (void*)pvItemToQueue, (u32)xTicksToWait, SMX_PUT_TO_FRONT);
             else
-                return (BaseType_t)smx_PipePutPktWait((PICB_PTR)xQueue, 
+                pass = (BaseType_t)smx_PipePutPktWait((PICB_PTR)xQueue, 
                         (void*)pvItemToQueue, (u32)xTicksToWait, SMX_PUT_TO_BACK);
+            queueNOTIFY_SET(xQueue, pass)
+            return pass;
             break;
         default:
             return pdFALSE;
@@ -208,12 +266,18 @@ BaseType_t xQueueGenericSendFromISR( QueueHandle_t xQueue,
                                      BaseType_t * const pxHigherPriorityTaskWoken,
                                      const BaseType_t xCopyPosition )
 {
-    if (xCopyPosition == queueSEND_TO_FRONT || xCopyPosition == queueOVERWRITE)
-        return (BaseType_t)smx_PipePutPktWait((PICB_PTR)xQueue, 
+    BaseType_t pass;
+
+    if (xCopyPosition == queueOVERWRITE)
+        pass = prvQueueOverwrite((PICB_PTR)xQueue, pvItemToQueue);
+    else if (xCopyPosition == queueSEND_TO_FRONT)
+        pass = (BaseType_t)smx_PipePutPktWait((PICB_PTR)xQueue, 
                            (void*)pvItemToQueue, SMX_TMO_NOWAIT, SMX_PUT_TO_FRONT);
     else
-        return (BaseType_t)smx_PipePutPktWait((PICB_PTR)xQueue, 
+        pass = (BaseType_t)smx_PipePutPktWait((PICB_PTR)xQueue, 
                            (void*)pvItemToQueue, SMX_TMO_NOWAIT, SMX_PUT_TO_BACK);
+    queueNOTIFY_SET(xQueue, pass)
+    return pass;
 }
 
 const char * pcQueueGetName( QueueHandle_t xQueue )
@@ -238,7 +302,9 @@ uint8_t ucQueueGetQueueType( QueueHandle_t xQueue )
 BaseType_t xQueueGiveFromISR( QueueHandle_t xQueue,
                               BaseType_t * const pxHigherPriorityTaskWoken )
 {
-    return((BaseType_t)smx_SemSignal((SCB_PTR)xQueue));
+    BaseType_t pass = (BaseType_t)smx_SemSignal((SCB_PTR)xQueue);
+    queueNOTIFY_SET(xQueue, pass)
+    return pass;
 }
 
 BaseType_t xQueueIsQueueEmptyFromISR( const QueueHandle_t xQueue )
@@ -275,13 +341,25 @@ BaseType_t xQueuePeek( QueueHandle_t xQueue,
                        void * const pvBuffer,
                        TickType_t xTicksToWait )
 {
-    return errQUEUE_EMPTY; 
+    if (((CB_PTR)xQueue)->cbtype != SMX_CB_PIPE)
+        return errQUEUE_EMPTY;
+
+    /* copy oldest item, waiting for one if empty, without removing it <2> */
+    if (smx_PipePeekWait((PICB_PTR)xQueue, pvBuffer, (u32)xTicksToWait))
+        return pdPASS;
+    else
+        return errQUEUE_EMPTY;
 }
 
 BaseType_t xQueuePeekFromISR( QueueHandle_t xQueue,
                               void * const pvBuffer )
 {
-    return errQUEUE_EMPTY;
+    PICB_PTR pipe = (PICB_PTR)xQueue;
+
+    if (((CB_PTR)xQueue)->cbtype != SMX_CB_PIPE || smx_PIPE_EMPTY(pipe, pipe->rp))
+        return errQUEUE_EMPTY;
+    memcpy(pvBuffer, pipe->rp, pipe->width);
+    return pdPASS;
 }
 
 BaseType_t xQueueReceive( QueueHandle_t xQueue,
@@ -312,22 +390,46 @@ BaseType_t xQueueReceiveFromISR( QueueHandle_t xQueue,
     }
 }
 
+#if ( configUSE_QUEUE_SETS == 1 )
 BaseType_t xQueueRemoveFromSet( QueueSetMemberHandle_t xQueueOrSemaphore,
                                 QueueSetHandle_t xQueueSet )
 {
-    return pdFAIL;
+    BaseType_t pass = pdFAIL;
+    u32 i;
+
+    smx_LSRsOff();
+    for (i = 0; i < configQUEUE_SET_MEMBERS; i++)
+    {
+        if (xQueueSetMembers[i].member == xQueueOrSemaphore)
+        {
+            if (xQueueSetMembers[i].set == xQueueSet && prvQueueIsEmpty(xQueueOrSemaphore))
+            {
+                xQueueSetMembers[i].member = NULL;
+                xQueueSetMembers[i].set = NULL;
+                pass = pdPASS;
+            }
+            break;
+        }
+    }
+    smx_LSRsOn();
+    return pass;
 }
 
 QueueSetMemberHandle_t xQueueSelectFromSet( QueueSetHandle_t xQueueSet,
                                             TickType_t const xTicksToWait )
 {
-    return NULL;
+    QueueSetMemberHandle_t member = NULL;
+    smx_PipeGetPktWait((PICB_PTR)xQueueSet, (void*)&member, (u32)xTicksToWait);
+    return member;
 }
 
 QueueSetMemberHandle_t xQueueSelectFromSetFromISR( QueueSetHandle_t xQueueSet )
 {
-    return NULL;
+    QueueSetMemberHandle_t member = NULL;
+    smx_PipeGetPktWait((PICB_PTR)xQueueSet, (void*)&member, SMX_TMO_NOWAIT);
+    return member;
 }
+#endif /* configUSE_QUEUE_SETS */
 
 void vQueueSetQueueNumber( QueueHandle_t xQueue,
                            UBaseType_t uxQueueNumber )
@@ -360,11 +462,11 @@ QueueHandle_t xQueueCreateCountingSemaphore( const UBaseType_t uxMaxCount,
     SCB_PTR sem;
     if (uxInitialCount == 0)
     {
-        u8 lim = (uxMaxCount == 1 ? 1 : 0);
+        u32 lim = (uxMaxCount == 1 ? 1 : 0);
         sem = smx_SemCreate(SMX_SEM_EVENT, lim);
     }
     else
-        sem = smx_SemCreate(SMX_SEM_RSRC, (u8)uxMaxCount);
+        sem = smx_SemCreate(SMX_SEM_RSRC, (u32)uxMaxCount);
     return (QueueHandle_t)sem;
 }
 
@@ -375,11 +477,11 @@ QueueHandle_t xQueueCreateCountingSemaphoreStatic( const UBaseType_t uxMaxCount,
     SCB_PTR sem;
     if (uxInitialCount == 0)
     {
-        u8 lim = (uxMaxCount == 1 ? 1 : 0);
+        u32 lim = (uxMaxCount == 1 ? 1 : 0);
         sem = smx_SemCreate(SMX_SEM_EVENT, lim);
     }
     else
-        sem = smx_SemCreate(SMX_SEM_RSRC, (u8)uxMaxCount);
+        sem = smx_SemCreate(SMX_SEM_RSRC, (u32)uxMaxCount);
     return (QueueHandle_t)sem;
 }
 
@@ -392,3 +494,92 @@ BaseType_t xQueueSemaphoreTake( QueueHandle_t xQueue,
         return (BaseType_t)smx_SemTest((SCB_PTR)xQueue, xTicksToWait);
 }
 
+/* Queue Helper Functions */
+
+/* Puts item into queue. If the queue is full, first discards its oldest item,
+   so for a length 1 mailbox, the item is replaced. Never waits. */
+static BaseType_t prvQueueOverwrite( PICB_PTR pipe, const void * pvItemToQueue )
+{
+    BaseType_t pass;
+    u8* rp;
+
+    smx_LSRsOff();
+    if (smx_PIPE_FULL(pipe, pipe->wp))
+    {
+        sb_INT_DISABLE();
+        rp = pipe->rp + pipe->width;
+        pipe->rp = (rp > pipe->bx ? pipe->bi : rp);
+        pipe->flags.full = 0;
+        sb_INT_ENABLE();
+    }
+    pass = (BaseType_t)smx_PipePutPktWait(pipe, (void*)pvItemToQueue, SMX_TMO_NOWAIT, 
+                                                                  SMX_PUT_TO_BACK);
+    smx_LSRsOn();
+    return pass;
+}
+
+/* Queue Set Helper Functions */
+
+#if ( configUSE_QUEUE_SETS == 1 )
+/* Returns pdTRUE if the queue or semaphore has nothing to receive. A member
+   must be empty when added to or removed from a set, as in FreeRTOS. */
+static BaseType_t prvQueueIsEmpty( QueueSetMemberHandle_t xQueueOrSemaphore )
+{
+    switch (((CB_PTR)xQueueOrSemaphore)->cbtype)
+    {
+        case SMX_CB_SEM:
+            return (((SCB_PTR)xQueueOrSemaphore)->count == 0 ? pdTRUE : pdFALSE);
+        case SMX_CB_PIPE:
+            return (smx_PipePeek((PICB_PTR)xQueueOrSemaphore, SMX_PK_NUMPKTS) == 0 ? 
+                                                                     pdTRUE : pdFALSE);
+        default:
+            return pdFALSE;
+    }
+}
+
+/* Posts the member handle to its set, if any, after a successful send or
+   give. The set pipe is FIFO, so xQueueSelectFromSet() returns members in
+   the order they were sent to. */
+static void prvQueueNotifySet( QueueSetMemberHandle_t xQueueOrSemaphore )
+{
+    u32 i;
+    for (i = 0; i < configQUEUE_SET_MEMBERS; i++)
+    {
+        if (xQueueSetMembers[i].member == xQueueOrSemaphore)
+        {
+            smx_PipePutPktWait((PICB_PTR)xQueueSetMembers[i].set, 
+                  (void*)&xQueueOrSemaphore, SMX_TMO_NOWAIT, SMX_PUT_TO_BACK);
+            break;
+        }
+    }
+}
+
+/* Removes a deleted queue or semaphore from its set, or all members from a
+   deleted set. Called with LSRs off. */
+static void prvQueueSetUnlink( void* handle )
+{
+    u32 i;
+    for (i = 0; i < configQUEUE_SET_MEMBERS; i++)
+    {
+        if (xQueueSetMembers[i].member == handle || xQueueSetMembers[i].set == handle)
+        {
+            xQueueSetMembers[i].member = NULL;
+            xQueueSetMembers[i].set = NULL;
+        }
+    }
+}
+#endif /* configUSE_QUEUE_SETS */
+
+/* Notes:
+   1. A queue set is a pipe of member handles. Each successful send to a
+      member queue, or give of a member semaphore, also puts the member handle
+      into the set pipe, so xQueueSelectFromSet() is one smx_PipeGetPktWait().
+      Membership is kept in a small table, rather than in the PICB and SCB.
+      The set length must be at least the sum of member queue lengths and
+      semaphore counts, else notifications are lost, as in FreeRTOS.
+   2. xQueuePeek() uses smx_PipePeekWait(), which copies the oldest item in
+      place. If the queue is empty, it waits in the pipe wait queue as a peek.
+      The next send gives it a copy and still delivers the item to a waiting
+      receiver or to the queue. So a peek never removes an item, even while
+      it waits.
+*/
@@ -40,6 +40,27 @@
 
 void* pvTaskTags[SMX_NUM_TASKS];
 
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+/* Task notification states */
+#define taskNOT_WAITING_NOTIFICATION    ( ( uint8_t ) 0 )
+#define taskWAITING_NOTIFICATION        ( ( uint8_t ) 1 )
+#define taskNOTIFICATION_RECEIVED       ( ( uint8_t ) 2 )
+
+/* Task notification values and states, indexed by task->indx <1> */
+static volatile uint32_t ulTaskNotifyValue[SMX_NUM_TASKS][configTASK_NOTIFICATION_ARRAY_ENTRIES];
+static volatile uint8_t  ucTaskNotifyState[SMX_NUM_TASKS][configTASK_NOTIFICATION_ARRAY_ENTRIES];
+
+/* Per-task event semaphores that waiting tasks block on <2> */
+static SCB_PTR xTaskNotifySem[SMX_NUM_TASKS];
+
+static BaseType_t prvTaskNotify( TCB_PTR task, UBaseType_t uxIndexToNotify,
+                                 uint32_t ulValue, eNotifyAction eAction,
+                                 uint32_t * pulPreviousNotificationValue,
+                                 BaseType_t * pxHigherPriorityTaskWoken );
+static void prvTaskNotifyReset( TCB_PTR task );
+static SCB_PTR prvTaskNotifySem( TCB_PTR task );
+#endif
+
 /* Task mapping functions */
 BaseType_t xTaskAbortDelay( TaskHandle_t xTask )
 {
@@ -87,6 +108,9 @@ BaseType_t xTaskCreate( TaskFunction_t pxTaskCode,
     if (smx_TaskCreate((FUN_PTR)pxTaskCode, uxPriority, usStackDepth*4, 0, pcName, 
                                                      NULL, (TCB**)pxCreatedTask));
     {
+       #if ( configUSE_TASK_NOTIFICATIONS == 1 )
+        prvTaskNotifyReset((TCB_PTR)*pxCreatedTask);
+       #endif
         if (smx_TaskStart((TCB*)*pxCreatedTask, (u32)pvParameters))
             return pdPASS;
     }
@@ -104,6 +128,9 @@ TaskHandle_t xTaskCreateStatic( TaskFunction_t pxTaskCode,
     TCB_PTR task = smx_TaskCreate((FUN_PTR)pxTaskCode, uxPriority, ulStackDepth*4, 0, pcName);
     if (task != NULL)
     {
+       #if ( configUSE_TASK_NOTIFICATIONS == 1 )
+        prvTaskNotifyReset(task);
+       #endif
         if (smx_TaskStart(task, (u32)pvParameters))
             return (TaskHandle_t)task;
     }
@@ -146,6 +173,9 @@ void vTaskDelete( TaskHandle_t xTaskToDelete )
 {
     TCB_PTR task = (xTaskToDelete == NULL ? smx_ct : (TCB_PTR)xTaskToDelete);
     pvTaskTags[task->indx] = NULL;
+   #if ( configUSE_TASK_NOTIFICATIONS == 1 )
+    prvTaskNotifyReset(task);
+   #endif
     smx_TaskDelete(&task);
 }
 
@@ -161,13 +191,15 @@ void vTaskExitCritical( void )
 {
 }
 
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
 BaseType_t xTaskGenericNotify( TaskHandle_t xTaskToNotify,
                                UBaseType_t uxIndexToNotify,
                                uint32_t ulValue,
                                eNotifyAction eAction,
                                uint32_t * pulPreviousNotificationValue )
 {
-    return pdFAIL;
+    return prvTaskNotify((TCB_PTR)xTaskToNotify, uxIndexToNotify, ulValue, eAction,
+                                             pulPreviousNotificationValue, NULL);
 }
 
 BaseType_t xTaskGenericNotifyFromISR( TaskHandle_t xTaskToNotify,
@@ -177,33 +209,80 @@ BaseType_t xTaskGenericNotifyFromISR( TaskHandle_t xTaskToNotify,
                                       uint32_t * pulPreviousNotificationValue,
                                       BaseType_t * pxHigherPriorityTaskWoken )
 {
-    return pdFAIL;
+    return prvTaskNotify((TCB_PTR)xTaskToNotify, uxIndexToNotify, ulValue, eAction,
+                         pulPreviousNotificationValue, pxHigherPriorityTaskWoken);
 }
 
 void vTaskGenericNotifyGiveFromISR( TaskHandle_t xTaskToNotify,
                                     UBaseType_t uxIndexToNotify,
                                     BaseType_t * pxHigherPriorityTaskWoken )
 {
+    prvTaskNotify((TCB_PTR)xTaskToNotify, uxIndexToNotify, 0, eIncrement, NULL,
+                                                   pxHigherPriorityTaskWoken);
 }
 
 BaseType_t xTaskGenericNotifyStateClear( TaskHandle_t xTask,
                                          UBaseType_t uxIndexToClear )
 {
-    return pdFAIL;
+    BaseType_t pass = pdFAIL;
+    TCB_PTR task = (xTask == NULL ? smx_ct : (TCB_PTR)xTask);
+
+    if (uxIndexToClear >= configTASK_NOTIFICATION_ARRAY_ENTRIES)
+        return pdFAIL;
+    smx_LSRsOff();
+    if (ucTaskNotifyState[task->indx][uxIndexToClear] == taskNOTIFICATION_RECEIVED)
+    {
+        ucTaskNotifyState[task->indx][uxIndexToClear] = taskNOT_WAITING_NOTIFICATION;
+        pass = pdPASS;
+    }
+    smx_LSRsOn();
+    return pass;
 }
 
 uint32_t ulTaskGenericNotifyTake( UBaseType_t uxIndexToWait,
                                   BaseType_t xClearCountOnExit,
                                   TickType_t xTicksToWait )
 {
-    return pdFAIL;
+    TCB_PTR  ct = smx_ct;
+    SCB_PTR  sem = NULL;
+    uint32_t val;
+
+    if (uxIndexToWait >= configTASK_NOTIFICATION_ARRAY_ENTRIES)
+        return 0;
+    if (xTicksToWait > 0)
+        sem = prvTaskNotifySem(ct);
+    smx_LSRsOff();
+    if (ulTaskNotifyValue[ct->indx][uxIndexToWait] == 0 && sem != NULL)
+    {
+        /* mark waiting with LSRs off, then block with LSRs on <2> */
+        ucTaskNotifyState[ct->indx][uxIndexToWait] = taskWAITING_NOTIFICATION;
+        smx_SemClear(sem);
+        smx_LSRsOn();
+        smx_SemTest(sem, (u32)xTicksToWait);
+        smx_LSRsOff();
+    }
+    val = ulTaskNotifyValue[ct->indx][uxIndexToWait];
+    if (val != 0)
+        ulTaskNotifyValue[ct->indx][uxIndexToWait] = (xClearCountOnExit ? 0 : val - 1);
+    ucTaskNotifyState[ct->indx][uxIndexToWait] = taskNOT_WAITING_NOTIFICATION;
+    smx_LSRsOn();
+    return val;
 }
 
 uint32_t ulTaskGenericNotifyValueClear( TaskHandle_t xTask,
                                         UBaseType_t uxIndexToClear,
                                         uint32_t ulBitsToClear )
 {
-    return pdFAIL;;
+    uint32_t val;
+    TCB_PTR task = (xTask == NULL ? smx_ct : (TCB_PTR)xTask);
+
+    if (uxIndexToClear >= configTASK_NOTIFICATION_ARRAY_ENTRIES)
+        return 0;
+    smx_LSRsOff();
+    val = ulTaskNotifyValue[task->indx][uxIndexToClear];
+    ulTaskNotifyValue[task->indx][uxIndexToClear] = val & ~ulBitsToClear;
+    smx_LSRsOn();
+    return val;
 }
 
 BaseType_t xTaskGenericNotifyWait( UBaseType_t uxIndexToWait,
@@ -212,8 +291,125 @@ BaseType_t xTaskGenericNotifyWait( UBaseType_t uxIndexToWait,
                                    uint32_t * pulNotificationValue,
                                    TickType_t xTicksToWait )
 {
-    return pdFAIL;
+    BaseType_t pass = pdFALSE;
+    TCB_PTR    ct = smx_ct;
+    SCB_PTR    sem = NULL;
+
+    if (uxIndexToWait >= configTASK_NOTIFICATION_ARRAY_ENTRIES)
+        return pdFALSE;
+    if (xTicksToWait > 0)
+        sem = prvTaskNotifySem(ct);
+    smx_LSRsOff();
+    if (ucTaskNotifyState[ct->indx][uxIndexToWait] != taskNOTIFICATION_RECEIVED)
+    {
+        ulTaskNotifyValue[ct->indx][uxIndexToWait] &= ~ulBitsToClearOnEntry;
+        if (sem != NULL)
+        {
+            /* mark waiting with LSRs off, then block with LSRs on <2> */
+            ucTaskNotifyState[ct->indx][uxIndexToWait] = taskWAITING_NOTIFICATION;
+            smx_SemClear(sem);
+            smx_LSRsOn();
+            smx_SemTest(sem, (u32)xTicksToWait);
+            smx_LSRsOff();
+        }
+    }
+    if (pulNotificationValue != NULL)
+        *pulNotificationValue = ulTaskNotifyValue[ct->indx][uxIndexToWait];
+    if (ucTaskNotifyState[ct->indx][uxIndexToWait] == taskNOTIFICATION_RECEIVED)
+    {
+        ulTaskNotifyValue[ct->indx][uxIndexToWait] &= ~ulBitsToClearOnExit;
+        pass = pdTRUE;
+    }
+    ucTaskNotifyState[ct->indx][uxIndexToWait] = taskNOT_WAITING_NOTIFICATION;
+    smx_LSRsOn();
+    return pass;
+}
+
+/* Task notification helper functions */
+
+/* Updates the notification value of task per eAction, marks it received, and
+   resumes task if it is waiting for it. Used by task and FromISR versions.
+   FromISR versions run in LSRs, which cannot be preempted by tasks or other
+   LSRs, so LSRs are turned off only when called from a task. */
+static BaseType_t prvTaskNotify( TCB_PTR task, UBaseType_t uxIndexToNotify,
+                                 uint32_t ulValue, eNotifyAction eAction,
+                                 uint32_t * pulPreviousNotificationValue,
+                                 BaseType_t * pxHigherPriorityTaskWoken )
+{
+    BaseType_t pass = pdPASS;
+    bool       in_lsr = (smx_clsr != NULL);
+    uint8_t    prev_state;
+    volatile uint32_t* pval;
+
+    if (task == NULL || uxIndexToNotify >= configTASK_NOTIFICATION_ARRAY_ENTRIES)
+        return pdFAIL;
+    if (!in_lsr)
+        smx_LSRsOff();
+    pval = &ulTaskNotifyValue[task->indx][uxIndexToNotify];
+    if (pulPreviousNotificationValue != NULL)
+        *pulPreviousNotificationValue = *pval;
+    prev_state = ucTaskNotifyState[task->indx][uxIndexToNotify];
+    ucTaskNotifyState[task->indx][uxIndexToNotify] = taskNOTIFICATION_RECEIVED;
+
+    switch (eAction)
+    {
+        case eSetBits:
+            *pval |= ulValue;
+            break;
+        case eIncrement:
+            (*pval)++;
+            break;
+        case eSetValueWithOverwrite:
+            *pval = ulValue;
+            break;
+        case eSetValueWithoutOverwrite:
+            if (prev_state != taskNOTIFICATION_RECEIVED)
+                *pval = ulValue;
+            else
+                pass = pdFAIL;
+            break;
+        case eNoAction:
+        default:
+            break;
+    }
+
+    if (prev_state == taskWAITING_NOTIFICATION)
+    {
+        smx_SemSignal(xTaskNotifySem[task->indx]);
+        if (pxHigherPriorityTaskWoken != NULL && task->pri > smx_ct->pri)
+            *pxHigherPriorityTaskWoken = pdTRUE;
+    }
+    if (!in_lsr)
+        smx_LSRsOn();
+    return pass;
+}
+
+/* Clears all notification values and states of task and deletes its event
+   semaphore. Called when task is created or deleted, since task indices are
+   reused. */
+static void prvTaskNotifyReset( TCB_PTR task )
+{
+    UBaseType_t i;
+    if (task == NULL)
+        return;
+    for (i = 0; i < configTASK_NOTIFICATION_ARRAY_ENTRIES; i++)
+    {
+        ulTaskNotifyValue[task->indx][i] = 0;
+        ucTaskNotifyState[task->indx][i] = taskNOT_WAITING_NOTIFICATION;
+    }
+    if (xTaskNotifySem[task->indx] != NULL)
+        smx_SemDelete(&xTaskNotifySem[task->indx]);
+}
+
+/* Returns the event semaphore of task, creating it on first wait. Returns
+   NULL if no semaphore is available. */
+static SCB_PTR prvTaskNotifySem( TCB_PTR task )
+{
+    if (xTaskNotifySem[task->indx] == NULL)
+        smx_SemCreate(SMX_SEM_EVENT, 1, "notify", &xTaskNotifySem[task->indx]);
+    return xTaskNotifySem[task->indx];
 }
+#endif /* configUSE_TASK_NOTIFICATIONS */
 
 TaskHookFunction_t xTaskGetApplicationTaskTag( TaskHandle_t xTask )
 {
@@ -526,4 +722,18 @@ void vTaskSuspendAll( void )
 void vTaskSwitchContext( void )
 {
     smx_TaskSuspend(smx_ct, SMX_TMO_INF);
-}
\ No newline at end of file
+}
+
+/* Notes:
+   1. Notification values and states are kept in arrays indexed by task->indx,
+      like pvTaskTags[], rather than in the smx TCB. A notify is a few stores
+      plus smx_SemSignal() if the task is waiting.
+   2. A task cannot block with LSRs off: the scheduler does not run, so the
+      wait returns at once. So the state test and the waiting mark are done
+      with LSRs off, and the task then waits on its own event semaphore with
+      LSRs on. A notify that comes between smx_LSRsOn() and smx_SemTest() is
+      not lost, because the semaphore counts it. The semaphore is cleared
+      before each wait, so a signal that raced with a timeout cannot end the
+      next wait early. The semaphore is created on the first wait, so tasks
+      that never wait use none.
+*/
@@ -45,6 +45,7 @@ void test_semaphores(void);
 void test_tasks(void);
 void test_timers(void);
 void test_event_groups(void);
+void test_notifications(void);
 void tfail(void);
 void tfrp_main(u32);
 void t2a_main(void* pp);
@@ -77,6 +78,7 @@ void tfrp_main(u32)
    test_queues();
    test_timers();
    test_event_groups();
+   test_notifications();
    sb_MsgOut(SB_MSG_INFO, "TESTS DONE");
    sb_MsgDisplay();
 }
@@ -696,6 +698,10 @@ void tq00(void);
 void tq01(void);
 void tq02(void);
 void tq03(void);
+void tq04(void);
+void tq05(void);
+void tq06(void);
+void tq07(void);
 QueueHandle_t q1;
 QueueHandle_t q2;
 BaseType_t q2buf[6]; /* one item larger than max capacity */
@@ -708,6 +714,10 @@ void test_queues(void)
    tq01();
    tq02();
 //   tq03();
+   tq04();
+   tq05();
+   tq06();
+   tq07();
 
    if(ts_pass)
       sb_MsgOut(SB_MSG_INFO, "QUEUES PASSED");
@@ -1009,6 +1019,315 @@ void tq02_LSR_main(u32 par)
       tfail();
 }
 
+/* tq04 Test queue set create, add, select, and remove */
+void tq04_t2a(void*);
+QueueSetHandle_t qs1;
+
+void tq04(void)
+{
+   char c = 'a';
+
+   /* create test task */
+   t2a = xTaskCreateStatic(tq04_t2a, "t2a", 100, (void*)0x66, TP1, NULL, NULL);
+
+   /* create set, queue, and empty binary semaphore */
+   qs1 = xQueueCreateSet(3);
+   q1 = xQueueCreate(2, 1);
+   sem1 = xSemaphoreCreateBinary();
+   xSemaphoreTake(sem1, 0);
+   if (qs1 == NULL || q1 == NULL || sem1 == NULL)
+      tfail();
+
+   /* add q1 and sem1 to set. Adding q1 again fails. */
+   if (!xQueueAddToSet(q1, qs1) || !xQueueAddToSet(sem1, qs1))
+      tfail();
+   if (xQueueAddToSet(q1, qs1))
+      tfail();
+
+   /* start t2a. It waits on the set. */
+   vTaskPrioritySet(t2a, 2);
+
+   /* send to q1 and give sem1. t2a preempts each time. */
+   if (!xQueueSend(q1, &c, 0) || !xSemaphoreGive(sem1))
+      tfail();
+
+   /* wait for t2a to time out */
+   vTaskDelay(5);
+
+   /* test select order: q1, sem1, q1 */
+   xQueueSend(q1, &c, 0);
+   xSemaphoreGive(sem1);
+   xQueueSend(q1, &c, 0);
+   if (xQueueSelectFromSet(qs1, 0) != q1 || xQueueSelectFromSet(qs1, 0) != sem1 ||
+       xQueueSelectFromSetFromISR(qs1) != q1 || xQueueSelectFromSet(qs1, 0) != NULL)
+      tfail();
+
+   /* remove q1 fails while q1 is not empty */
+   if (xQueueRemoveFromSet(q1, qs1))
+      tfail();
+   xQueueReceive(q1, &c, 0);
+   xQueueReceive(q1, &c, 0);
+   xSemaphoreTake(sem1, 0);
+   if (!xQueueRemoveFromSet(q1, qs1) || xQueueRemoveFromSet(q1, qs1))
+      tfail();
+
+   /* cleanup */
+   vQueueDelete(qs1);
+   vQueueDelete(q1);
+   vSemaphoreDelete(sem1);
+   qs1 = NULL;
+   q1 = NULL;
+   sem1 = NULL;
+   vTaskDelete(t2a);
+   t2a = NULL;
+}
+
+void tq04_t2a(void*)
+{
+   QueueSetMemberHandle_t m;
+   char c;
+
+   /* wait for q1 */
+   m = xQueueSelectFromSet(qs1, 10);
+   if (m != q1 || !xQueueReceive(q1, &c, 0) || c != 'a')
+      tfail();
+
+   /* wait for sem1 */
+   m = xQueueSelectFromSet(qs1, 10);
+   if (m != sem1 || !xSemaphoreTake(sem1, 0))
+      tfail();
+
+   /* wait for nothing -- timeout */
+   if (xQueueSelectFromSet(qs1, 2) != NULL)
+      tfail();
+}
+
+/* tq05 Test large items, mailbox overwrite, and peek */
+void tq05_t2a(void*);
+u8 tq05_buf[300];
+
+void tq05(void)
+{
+   u32 i, v;
+
+   /* create test task */
+   t2a = xTaskCreateStatic(tq05_t2a, "t2a", 100, (void*)0x66, TP1, NULL, NULL);
+
+   /* create queue of 300-byte items and mailbox */
+   q1 = xQueueCreate(3, sizeof(tq05_buf));
+   q2 = xQueueCreate(1, sizeof(u32));
+   if (q1 == NULL || q2 == NULL || smx_PipePeek((PICB_PTR)q1, SMX_PK_WIDTH) != 300 ||
+       smx_PipePeek((PICB_PTR)q1, SMX_PK_LENGTH) != 3)
+      tfail();
+
+   /* send and peek large item -- still waiting */
+   for (i = 0; i < sizeof(tq05_buf); i++)
+      tq05_buf[i] = (u8)i;
+   if (!xQueueSend(q1, tq05_buf, 0))
+      tfail();
+   memset(tq05_buf, 0, sizeof(tq05_buf));
+   if (!xQueuePeek(q1, tq05_buf, 0) || tq05_buf[299] != (u8)299 || 
+        uxQueueMessagesWaiting(q1) != 1)
+      tfail();
+   if (!xQueueReceive(q1, tq05_buf, 0) || tq05_buf[256] != 0)
+      tfail();
+
+   /* overwrite mailbox twice -- second replaces first */
+   v = 1;
+   xQueueOverwrite(q2, &v);
+   v = 2;
+   if (!xQueueOverwrite(q2, &v) || uxQueueMessagesWaiting(q2) != 1)
+      tfail();
+   if (!xQueuePeekFromISR(q2, &v) || v != 2)
+      tfail();
+   xQueueReceive(q2, &v, 0);
+
+   /* start t2a. It peeks with wait, then receives. */
+   vTaskPrioritySet(t2a, 2);
+   v = 3;
+   xQueueOverwrite(q2, &v);
+
+   /* cleanup */
+   vQueueDelete(q1);
+   vQueueDelete(q2);
+   q1 = q2 = NULL;
+   vTaskDelete(t2a);
+   t2a = NULL;
+}
+
+void tq05_t2a(void*)
+{
+   u32 v = 0;
+
+   /* wait for item from tfrp. It stays in mailbox. */
+   if (!xQueuePeek(q2, &v, 10) || v != 3 || uxQueueMessagesWaiting(q2) != 1)
+      tfail();
+   if (!xQueueReceive(q2, &v, 0) || v != 3)
+      tfail();
+}
+
+/* tq06 Compare wakeup latency of a queue set with a relay task per queue */
+void tq06_t2a(void*);
+void tq06_t2b(void*);
+QueueHandle_t q3;
+u32 tq06_ts;      /* start time of current send */
+u32 tq06_set;     /* total wakeup time with queue set */
+u32 tq06_relay;   /* total wakeup time with relay task */
+#define TQ06_N 8
+
+void tq06(void)
+{
+  #if SB_CFG_TM
+   u32  i;
+   char c = 'a';
+
+   /* create set, member queue, and relay queue */
+   qs1 = xQueueCreateSet(2);
+   q1 = xQueueCreate(2, 1);
+   q3 = xQueueCreate(2, sizeof(QueueHandle_t));
+   if (qs1 == NULL || q1 == NULL || q3 == NULL || !xQueueAddToSet(q1, qs1))
+      tfail();
+
+   /* queue set: t2a waits on qs1 and preempts each send */
+   tq06_set = 0;
+   t2a = xTaskCreateStatic(tq06_t2a, "t2a", 100, (void*)0, TP1, NULL, NULL);
+   vTaskPrioritySet(t2a, 2);
+   for (i = 0; i < TQ06_N; i++)
+   {
+      sb_TM_START(&tq06_ts);
+      xQueueSend(q1, &c, 0);
+   }
+   vTaskDelete(t2a);
+   if (!xQueueRemoveFromSet(q1, qs1))
+      tfail();
+
+   /* relay: t2b forwards q1 handle to q3, and t2a waits on q3 */
+   tq06_relay = 0;
+   t2a = xTaskCreateStatic(tq06_t2a, "t2a", 100, (void*)1, TP1, NULL, NULL);
+   t2b = xTaskCreateStatic(tq06_t2b, "t2b", 100, (void*)0, TP1, NULL, NULL);
+   vTaskPrioritySet(t2a, 2);
+   vTaskPrioritySet(t2b, 3);
+   for (i = 0; i < TQ06_N; i++)
+   {
+      sb_TM_START(&tq06_ts);
+      xQueueSend(q1, &c, 0);
+   }
+
+   /* set wakes in one hop, relay in two */
+   if (tq06_set == 0 || tq06_set >= tq06_relay)
+      tfail();
+
+   /* cleanup */
+   vTaskDelete(t2a);
+   vTaskDelete(t2b);
+   t2a = t2b = NULL;
+   vQueueDelete(qs1);
+   vQueueDelete(q1);
+   vQueueDelete(q3);
+   qs1 = NULL;
+   q1 = q3 = NULL;
+  #endif
+}
+
+void tq06_t2a(void* pp)
+{
+   QueueHandle_t m;
+   u32  tm;
+   char c;
+
+   for (;;)
+   {
+      if (pp == 0)
+         m = xQueueSelectFromSet(qs1, 10);
+      else if (!xQueueReceive(q3, &m, 10))
+         m = NULL;
+      sb_TM_END(tq06_ts, &tm);
+      if (m != q1)
+         continue;
+      if (pp == 0)
+      {
+         tq06_set += tm;
+         xQueueReceive(q1, &c, 0);
+      }
+      else
+         tq06_relay += tm;
+   }
+}
+
+void tq06_t2b(void*)
+{
+   char c;
+
+   for (;;)
+   {
+      if (xQueueReceive(q1, &c, 10))
+         xQueueSend(q3, &q1, 0);
+   }
+}
+
+/* tq07 Stress large items and peek with wait, as the queue fills and empties */
+void tq07_t2a(void*);
+u8  tq07_buf[300];
+u32 tq07_rcv;     /* number of items received by t2a */
+#define TQ07_N 100
+
+void tq07(void)
+{
+   u32 i, k;
+
+   /* create queue and test task. t2a runs when tfrp waits. */
+   q1 = xQueueCreate(3, sizeof(tq05_buf));
+   if (q1 == NULL)
+      tfail();
+   tq07_rcv = 0;
+   t2a = xTaskCreateStatic(tq07_t2a, "t2a", 100, (void*)0x66, TP1, NULL, NULL);
+
+   /* send numbered items. When full, delay so t2a empties the queue. */
+   for (k = 0; k < TQ07_N; )
+   {
+      *(u32*)tq05_buf = k;
+      for (i = 4; i < sizeof(tq05_buf); i++)
+         tq05_buf[i] = (u8)(k + i);
+      if (xQueueSend(q1, tq05_buf, 0))
+         k++;
+      else
+         vTaskDelay(1);
+   }
+   vTaskDelay(2);
+   if (tq07_rcv != TQ07_N || uxQueueMessagesWaiting(q1) != 0)
+      tfail();
+
+   /* cleanup */
+   vTaskDelete(t2a);
+   t2a = NULL;
+   vQueueDelete(q1);
+   q1 = NULL;
+}
+
+void tq07_t2a(void*)
+{
+   u32 i;
+
+   for (;;)
+   {
+      /* peek, waiting if empty, then receive the same item */
+      if (!xQueuePeek(q1, tq07_buf, 10))
+         continue;
+      if (*(u32*)tq07_buf != tq07_rcv)
+         tfail();
+      memset(tq07_buf, 0, sizeof(tq07_buf));
+      if (!xQueueReceive(q1, tq07_buf, 0) || *(u32*)tq07_buf != tq07_rcv)
+         tfail();
+      for (i = 4; i < sizeof(tq07_buf); i++)
+         if (tq07_buf[i] != (u8)(tq07_rcv + i))
+         {
+            tfail();
+            break;
+         }
+      tq07_rcv++;
+   }
+}
+
 /******************************************************************************
 *                                                                             *
 *                            TIMER FUNCTION TESTS                             *
@@ -1343,4 +1662,194 @@ void tg01_LSR_main(u32 par)
       tfail();
    xEventGroupSetBitsFromISR(g1, 0x10, 0);
    wait = false;
-}
\ No newline at end of file
+}
+
+/******************************************************************************
+*                                                                             *
+*                       TASK NOTIFICATION FUNCTION TESTS                      *
+*                                                                             *
+******************************************************************************/
+
+void tn00(void);
+void tn01(void);
+void tn02(void);
+
+void test_notifications(void)
+{
+   ts_pass   = true;
+   smx_errno = SMXE_OK;
+   tn00();
+   tn01();
+   tn02();
+
+   if(ts_pass)
+      sb_MsgOut(SB_MSG_INFO, "NOTIFICATIONS PASSED");
+   else
+      sb_MsgOut(SB_MSG_WARN, "NOTIFICATIONS FAILED");
+   sb_MsgDisplay();
+}
+
+/* tn00 Test notify give and take between tasks */
+void tn00_t2a(void*);
+
+void tn00(void)
+{
+   /* create test task */
+   t2a = xTaskCreateStatic(tn00_t2a, "t2a", 100, (void*)0x66, TP1, NULL, NULL);
+   t2ax = (TCB*)t2a;
+
+   /* give twice before t2a starts */
+   xTaskNotifyGive(t2a);
+   xTaskNotifyGive(t2a);
+
+   /* start t2a. It takes count and waits. */
+   vTaskPrioritySet(t2a, 2);
+
+   /* give, t2a preempts, then times out */
+   if (!xTaskNotifyGive(t2a))
+      tfail();
+   vTaskDelay(10);
+
+   /* cleanup */
+   vTaskDelete(t2a);
+   t2a = NULL;
+}
+
+void tn00_t2a(void*)
+{
+   TickType_t time;
+
+   /* take count of 2 one at a time, then fail */
+   if (ulTaskNotifyTake(pdFALSE, 0) != 2 || ulTaskNotifyTake(pdTRUE, 0) != 1)
+      tfail();
+   if (ulTaskNotifyTake(pdFALSE, 0) != 0)
+      tfail();
+
+   /* wait for give by tfrp */
+   if (ulTaskNotifyTake(pdFALSE, 10) != 1)
+      tfail();
+
+   /* wait with nothing pending -- blocks until timeout */
+   time = xTaskGetTickCount();
+   if (ulTaskNotifyTake(pdTRUE, 2) != 0 || xTaskGetTickCount() - time < 2)
+      tfail();
+}
+
+/* tn01 Test notify actions, wait, and indexed notifications */
+void tn01_t2a(void*);
+
+void tn01(void)
+{
+   uint32_t val;
+
+   /* create test task */
+   t2a = xTaskCreateStatic(tn01_t2a, "t2a", 100, (void*)0x66, TP1, NULL, NULL);
+   t2ax = (TCB*)t2a;
+
+   /* notify before t2a starts. Second without overwrite must fail. */
+   if (!xTaskNotify(t2a, 0x11, eSetValueWithOverwrite))
+      tfail();
+   if (xTaskNotify(t2a, 0x22, eSetValueWithoutOverwrite))
+      tfail();
+   if (!xTaskNotifyAndQuery(t2a, 0x100, eSetBits, &val) || val != 0x11)
+      tfail();
+
+   /* set index 1 and test value clear */
+   if (!xTaskNotifyIndexed(t2a, 1, 0x5A, eSetValueWithOverwrite))
+      tfail();
+   if (ulTaskNotifyValueClearIndexed(t2a, 1, 0x0F) != 0x5A)
+      tfail();
+
+   /* invalid index */
+   if (xTaskNotifyIndexed(t2a, configTASK_NOTIFICATION_ARRAY_ENTRIES, 0, eNoAction))
+      tfail();
+
+   /* start t2a */
+   vTaskPrioritySet(t2a, 2);
+
+   /* after t2a times out on index 0 and waits on index 1, wake it */
+   vTaskDelay(5);
+   if (!xTaskNotifyIndexed(t2a, 1, 0x03, eSetBits))
+      tfail();
+
+   /* cleanup */
+   vTaskDelete(t2a);
+   t2a = NULL;
+}
+
+void tn01_t2a(void*)
+{
+   uint32_t   val;
+   TickType_t time;
+
+   /* index 0 is pending with value 0x111. Clear 0x100 on exit. */
+   if (!xTaskNotifyWait(0, 0x100, &val, 0) || val != 0x111)
+      tfail();
+   if (ulTaskNotifyValueClear(NULL, 0) != 0x011)
+      tfail();
+
+   /* index 0 is no longer pending -- blocks until timeout */
+   time = xTaskGetTickCount();
+   if (xTaskNotifyWait(0, 0, &val, 2) || xTaskGetTickCount() - time < 2)
+      tfail();
+
+   /* clear index 1 state, then wait on it. Clear 0x10 on entry. */
+   if (!xTaskNotifyStateClearIndexed(NULL, 1) || xTaskNotifyStateClearIndexed(NULL, 1))
+      tfail();
+   if (!xTaskNotifyWaitIndexed(1, 0x10, 0xFFFFFFFF, &val, 10) || val != 0x43)
+      tfail();
+   if (ulTaskNotifyValueClearIndexed(NULL, 1, 0) != 0)
+      tfail();
+}
+
+/* tn02 Test FromISR functions from LSR */
+void tn02_ISR(void);
+void tn02_LSR_main(u32 par);
+LCB_PTR    tn02_LSR;
+BaseType_t tn02_woken;
+
+void tn02(void)
+{
+   uint32_t val;
+
+   /* create LSR */
+   tn02_LSR = smx_LSRCreate((FUN_PTR)tn02_LSR_main, SMX_FL_TRUST, "tn02_LSR");
+
+   /* enable interrupt to invoke LSR */
+   tick_cbptr = tn02_ISR;
+   tick_cben = true;
+
+   /* wait for give from LSR. tfrp was waiting, so woken is set. */
+   if (ulTaskNotifyTake(pdTRUE, 10) != 1 || tn02_woken != pdTRUE)
+      tfail();
+
+   /* wait for set bits from LSR on next tick */
+   tick_cben = true;
+   if (!xTaskNotifyWait(0, 0xFFFFFFFF, &val, 10) || val != 0x80)
+      tfail();
+
+   /* set bits from LSR while tfrp is not waiting. woken stays clear. */
+   smx_LSRInvoke(tn02_LSR, 0);
+   if (tn02_woken != pdFALSE || ulTaskNotifyTake(pdTRUE, 0) != 0x80)
+      tfail();
+
+   /* cleanup */
+   smx_LSRDelete(&tn02_LSR);
+}
+
+void tn02_ISR(void)
+{
+   smx_LSR_INVOKE(tn02_LSR, 0);
+}
+
+void tn02_LSR_main(u32 par)
+{
+   static u32 pass = 0;
+   BaseType_t woken = pdFALSE;
+
+   if (pass++ == 0)
+      vTaskNotifyGiveFromISR((TaskHandle_t)tfrp, &woken);
+   else
+      xTaskNotifyFromISR((TaskHandle_t)tfrp, 0x80, eSetBits, &woken);
+   tn02_woken = woken;
+}
@@ -32,10 +32,20 @@
 #include "tx_api.h"
   
 extern u32*     hbin[];
-extern SCB_PTR  hsem[];
 
 #define BK_LNK(cp)   (CCB_PTR)((u32)cp->blf & (u32)~EH_FLAGS)
 
+/* byte pool waiter <2> */
+typedef struct BPW {
+   struct BPW* next;          /* next waiter */
+   TCB_PTR     task;          /* waiting task */
+   u32         sz;            /* requested size, including heap number word */
+   u32*        bp;            /* block allocated for waiter, NULL if none */
+   bool        del;           /* pool was deleted */
+} BPW;
+
+static BPW* bpwq[EH_NUM_HEAPS];  /* byte pool waiter queues */
+
 UINT  tx_byte_pool_create(TX_BYTE_POOL *pool_ptr, CHAR *name_ptr, VOID *pool_start, ULONG pool_size)
 {
    u32 hn;
@@ -45,21 +55,14 @@ UINT  tx_byte_pool_create(TX_BYTE_POOL *pool_ptr, CHAR *name_ptr, VOID *pool_sta
          return TX_POOL_ERROR;
    }
 
-   if (hsem[hn] = smx_SemCreate(SMX_SEM_EVENT, 1, "heap_sem"))
+   bpwq[hn] = NULL;
+   eh_hvpn = hn;
+   if (smx_HeapInit(pool_size, 0, (u8*)pool_start, pool_ptr, hbin[2*hn], 
+                       (HBCB*)hbin[2*hn+1], (EH_EDA | EH_EM | EH_PRE) != -1))
    {
-      eh_hvpn = hn;
-      if (smx_HeapInit(pool_size, 0, (u8*)pool_start, pool_ptr, hbin[2*hn], 
-                          (HBCB*)hbin[2*hn+1], (EH_EDA | EH_EM | EH_PRE) != -1))
-      {
-         eh_hvp[hn]->name = (const char*)name_ptr;
-         eh_hvp[hn]->mode.fl.cmerge = ON;
-         return TX_SUCCESS;
-      }
-      else
-      {
-         smx_SemDelete(&hsem[hn]);
-         return TX_POOL_ERROR;
-      }
+      eh_hvp[hn]->name = (const char*)name_ptr;
+      eh_hvp[hn]->mode.fl.cmerge = ON;
+      return TX_SUCCESS;
    }
    else
       return TX_POOL_ERROR;
@@ -67,20 +70,25 @@ UINT  tx_byte_pool_create(TX_BYTE_POOL *pool_ptr, CHAR *name_ptr, VOID *pool_sta
 
 UINT  tx_byte_pool_delete(TX_BYTE_POOL *pool_ptr)
 {
-   u32 hn;
+   BPW* w;
+   u32  hn;
    for (hn = 0; pool_ptr != eh_hvp[hn]; hn++)
    {
       if (hn >= EH_NUM_HEAPS)
          return TX_POOL_ERROR;
    }
 
-   if (smx_SemDelete(&hsem[hn]))
+   /* resume all waiters with TX_DELETED */
+   smx_LSRsOff();
+   for (w = bpwq[hn]; w != NULL; w = w->next)
    {
-      eh_hvp[hn]->mode.fl.init = 0;
-      return TX_SUCCESS;
+      w->del = true;
+      smx_TaskResume(w->task);
    }
-   else
-      return TX_POOL_ERROR;
+   bpwq[hn] = NULL;
+   eh_hvp[hn]->mode.fl.init = 0;
+   smx_LSRsOn();
+   return TX_SUCCESS;
 }
 
 UINT  tx_byte_allocate(TX_BYTE_POOL *pool_ptr, VOID **memory_ptr, ULONG memory_size, ULONG wait_option)
@@ -92,57 +100,96 @@ UINT  tx_byte_allocate(TX_BYTE_POOL *pool_ptr, VOID **memory_ptr, ULONG memory_s
       if (hn >= EH_NUM_HEAPS)
          return TX_POOL_ERROR;
    }
-   SCB_PTR sem = hsem[hn];
+   BPW   w;
+   UINT  ret = TX_NO_MEMORY;
+
+   smx_LSRsOff();
 
    /* suppress heap error reporting for first malloc unless TX_NO_WAIT */
    if (wait_option != TX_NO_WAIT)
       eh_hvp[hn]->mode.fl.em_en = 0;
 
-   /* get block if enough heap space is available */
-   if (bp = (u32*)smx_HeapMalloc(memory_size+4, 3, hn))
-   {
-      *bp++ = hn;          /* store heap number in first word */
-      *memory_ptr = bp;
-      eh_hvp[hn]->mode.fl.em_en = 1;   /* restore heap error reporting */
-      return TX_SUCCESS;
-   }
-   else /* wait for available heap space */
+   /* get block if enough heap space is available and no waiter has equal or
+      higher priority */
+   if (bpwq[hn] == NULL || bpwq[hn]->task->pri < smx_ct->pri)
+      bp = (u32*)smx_HeapMalloc(memory_size+4, 3, hn); /*<1>*/
+   else
+      bp = NULL;
+   eh_hvp[hn]->mode.fl.em_en = 1;   /* restore heap error reporting */
+
+   if (bp == NULL && wait_option != TX_NO_WAIT)
    {
-      eh_hvp[hn]->mode.fl.em_en = 1;   /* restore heap error reporting */
-      do 
+      /* wait in pool waiter queue, in priority order, for tx_byte_release() 
+         to allocate <2> */
+      BPW** wp = &bpwq[hn];
+      w.task = smx_ct;
+      w.sz   = memory_size+4;
+      w.bp   = NULL;
+      w.del  = false;
+      while (*wp != NULL && (*wp)->task->pri >= smx_ct->pri)
+         wp = &(*wp)->next;
+      w.next = *wp;
+      *wp = &w;
+
+      /* block with LSRs on. Lock prevents a release before suspend. <3> */
+      smx_TaskLock();
+      smx_LSRsOn();
+      smx_TaskSuspend(smx_ct, wait_option);
+      smx_LSRsOff();
+
+      if (w.del)
+         ret = TX_DELETED;
+      else if ((bp = w.bp) == NULL)
       {
-         if (smx_SemTest(sem, wait_option)) /* requires smx modification for finite timeout */
-         {
-            if (bp = (u32*)smx_HeapMalloc(memory_size+4, 3, hn)) /*<1>*/
+         /* timed out -- remove w from waiter queue */
+         for (wp = &bpwq[hn]; *wp != NULL; wp = &(*wp)->next)
+            if (*wp == &w)
             {
-               *bp++ = hn;
-               *memory_ptr = bp;
-               return TX_SUCCESS;
+               *wp = w.next;
+               break;
             }
-         }
-         else
-            break;
-      } while (wait_option);
+      }
+   }
+   if (bp != NULL)
+   {
+      *bp++ = hn;          /* store heap number in first word */
+      *memory_ptr = bp;
+      ret = TX_SUCCESS;
    }
-   return TX_NO_MEMORY;
+   smx_LSRsOn();
+   return ret;
 }
 
 UINT  tx_byte_release(VOID *memory_ptr)
 {
    u32*    bp = (u32*)memory_ptr - 1;
    u32     hn = *bp;
-   SCB_PTR sem;
+   BPW*    w;
+   BPW**   wp;
 
    if (hn >= eh_hvpn)
       return TX_PTR_ERROR; 
-   else
-      sem = hsem[hn];
 
    smx_LSRsOff();
-   if (sem->fl) /* task waiting */
-      smx_SemSignal(sem);
    if (!smx_HeapFree(bp, hn))
+   {
+      smx_LSRsOn();
       return TX_PTR_ERROR;
+   }
+
+   /* allocate for each waiter, highest priority first, whose request now fits */
+   eh_hvp[hn]->mode.fl.em_en = 0;
+   for (wp = &bpwq[hn]; (w = *wp) != NULL; )
+   {
+      if ((w->bp = (u32*)smx_HeapMalloc(w->sz, 3, hn)) != NULL)
+      {
+         *wp = w->next;
+         smx_TaskResume(w->task);
+      }
+      else
+         wp = &w->next;
+   }
+   eh_hvp[hn]->mode.fl.em_en = 1;
    smx_LSRsOn();
    return TX_SUCCESS;
 }
@@ -160,8 +207,7 @@ UINT  tx_byte_pool_info_get(TX_BYTE_POOL *pool_ptr, CHAR **name, ULONG *availabl
       if (hn >= EH_NUM_HEAPS)
          return TX_POOL_ERROR;
    }
-   SCB_PTR  sem = hsem[hn];
-   TCB_PTR  task;
+   BPW*     w;
 
    if (name != TX_NULL)
      *name = (CHAR*)pool_ptr->name;
@@ -185,20 +231,15 @@ UINT  tx_byte_pool_info_get(TX_BYTE_POOL *pool_ptr, CHAR **name, ULONG *availabl
      *fragments = cnt - 2;    /* dc and end chunks do not count (and start chunk wasn't counted) */
    if (first_suspended != TX_NULL)
    {
-      if (sem->fl != NULL)
-         *first_suspended = (TCB**)&*sem->fl;
+      if (bpwq[hn] != NULL)
+         *first_suspended = (TX_THREAD*)bpwq[hn]->task;
       else
          *first_suspended = NULL;
    }
    if (suspended_count != TX_NULL)
    {
-      if (sem->fl != NULL)
-      {
-         for (task = sem->fl, cnt = 1; task->fl != (CB_PTR)sem; task = (TCB_PTR)task->fl, cnt++) {}
-         *suspended_count = cnt;
-      }
-      else
-         *suspended_count = 0;
+      for (w = bpwq[hn], cnt = 0; w != NULL; w = w->next, cnt++) {}
+      *suspended_count = cnt;
    }
    if (next_pool != TX_NULL)
      *next_pool = NULL;
@@ -219,12 +260,49 @@ UINT  tx_byte_pool_performance_system_info_get(ULONG *allocates, ULONG *releases
 
 UINT  tx_byte_pool_prioritize(TX_BYTE_POOL *pool_ptr)
 {
+   BPW  *w, **wp, **hwp;
+   u32   hn;
+
    if (pool_ptr == NULL)
       return TX_POOL_ERROR;
-   else
-      return TX_SUCCESS;
+   for (hn = 0; pool_ptr != eh_hvp[hn]; hn++)
+   {
+      if (hn >= EH_NUM_HEAPS)
+         return TX_POOL_ERROR;
+   }
+
+   /* move highest priority waiter to front, in case a priority has changed
+      since it started waiting. Others keep their order. */
+   smx_LSRsOff();
+   if (bpwq[hn] != NULL)
+   {
+      for (hwp = wp = &bpwq[hn]; *wp != NULL; wp = &(*wp)->next)
+         if ((*wp)->task->pri > (*hwp)->task->pri)
+            hwp = wp;
+      w = *hwp;
+      *hwp = w->next;
+      w->next = bpwq[hn];
+      bpwq[hn] = w;
+   }
+   smx_LSRsOn();
+   return TX_SUCCESS;
 }
 
 /* Notes:
    1. eh_hvp[hn]->mode.fl.cmerge should be ON. 
+   2. Each byte pool has a queue of waiters, in priority order and FIFO
+      within a priority. A waiter record is on the waiting task's stack and
+      holds its request size. tx_byte_release() goes down the queue and
+      allocates for each waiter whose request fits, then resumes it with the
+      block, so the highest priority waiter that fits is satisfied first and
+      only satisfied waiters run. A new request does not bypass waiters of
+      equal or higher priority. The queue order is set when a task starts to
+      wait. tx_byte_pool_prioritize() moves the highest priority waiter to the
+      front if a priority has changed since then.
+   3. smx_TaskSuspend() does not block with LSRs off, so the waiter record is
+      queued with LSRs off, then LSRs are turned on before suspending. The 
+      task lock keeps another task from running tx_byte_release() and 
+      resuming this task before it is suspended; suspend clears the lock.
+      On return, w.bp and w.del are read with LSRs off. If neither is set, 
+      the wait timed out and w is removed from the queue.
 */
\ No newline at end of file
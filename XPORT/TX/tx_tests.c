@@ -790,7 +790,6 @@ u32*     hbin[3][2] = {(u32*)NULL,   (u32*)NULL,
                        (u32*)&bsza1, (u32*)&bina1,
                        (u32*)&bsza2, (u32*)&bina2};
 ULONG    fragments;
-SCB_PTR  hsem[EH_NUM_HEAPS];
 u8       heap1[2000];
 ULONG    total_bytes;
 
@@ -890,7 +889,72 @@ void tbyp00_t2b(ULONG par)
       tfail();
 }
 
-void tbyp01(void){}
+/* test byte pool waiter queue, prioritize, and release to waiters that fit */
+void tbyp01_t2a(ULONG par);
+void tbyp01_t2b(ULONG par);
+void* bp4;
+
+void tbyp01(void)
+{
+   /* create byte pool and leave little free space */
+   eh_hvp[1] = &hv1;
+   if (tx_byte_pool_create(eh_hvp[1], (CHAR*)"heap1", &heap1, sizeof(heap1)) != TX_SUCCESS)
+      tfail();
+   if (tx_byte_allocate(eh_hvp[1], &bp1, 1000, TX_NO_WAIT) != TX_SUCCESS ||
+       tx_byte_allocate(eh_hvp[1], &bp2, 800, TX_NO_WAIT) != TX_SUCCESS)
+      tfail();
+
+   /* t2a waits for 900 bytes, then higher priority t2b waits for 600 bytes
+      ahead of it */
+   bp3 = bp4 = NULL;
+   tx_thread_create(&t2a, (CHAR*)"t2a", tbyp01_t2a, 0, sp1, TSSZ, TP2, TP2, 
+                    TX_NO_TIME_SLICE, TX_AUTO_START);
+   tx_thread_create(&t2b, (CHAR*)"t2b", tbyp01_t2b, 0, sp2, TSSZ, TP3, TP3, 
+                    TX_NO_TIME_SLICE, TX_AUTO_START);
+   if (tx_byte_pool_info_get(eh_hvp[1], NULL, NULL, NULL, &first_suspended, 
+       &suspended_count, NULL) != TX_SUCCESS || first_suspended != (TX_THREAD*)t2b ||
+       suspended_count != 2)
+      tfail();
+
+   /* t2b stays at front */
+   if (tx_byte_pool_prioritize(eh_hvp[1]) != TX_SUCCESS)
+      tfail();
+   tx_byte_pool_info_get(eh_hvp[1], NULL, NULL, NULL, &first_suspended, NULL, NULL);
+   if (first_suspended != (TX_THREAD*)t2b)
+      tfail();
+
+   /* release 800 bytes. Only t2b fits and runs. */
+   if (tx_byte_release(bp2) != TX_SUCCESS || bp4 == NULL || bp3 != NULL)
+      tfail();
+   tx_byte_pool_info_get(eh_hvp[1], NULL, NULL, NULL, &first_suspended, 
+                                                    &suspended_count, NULL);
+   if (first_suspended != (TX_THREAD*)t2a || suspended_count != 1)
+      tfail();
+
+   /* release 1000 bytes. t2a fits and runs. */
+   if (tx_byte_release(bp1) != TX_SUCCESS || bp3 == NULL)
+      tfail();
+
+   /* cleanup */
+   tx_byte_release(bp3);
+   tx_byte_release(bp4);
+   tx_byte_pool_delete(eh_hvp[1]);
+   tx_thread_delete(&t2a);
+   tx_thread_delete(&t2b);
+}
+
+void tbyp01_t2a(ULONG par)
+{
+   if (tx_byte_allocate(eh_hvp[1], &bp3, 900, TX_WAIT_FOREVER) != TX_SUCCESS || bp3 == NULL)
+      tfail();
+}
+
+void tbyp01_t2b(ULONG par)
+{
+   if (tx_byte_allocate(eh_hvp[1], &bp4, 600, TX_WAIT_FOREVER) != TX_SUCCESS || bp4 == NULL)
+      tfail();
+}
+
 void tbyp02(void){}
 void tbyp03(void){}
 
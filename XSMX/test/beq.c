@@ -0,0 +1,239 @@
+/*
+* beq.c                                                     Version 6.0.0
+*
+* Host Benchmark of Event Queue Differential List vs Count Buckets
+*
+* Copyright (c) 2026 Micro Digital Inc.
+* All rights reserved. www.smxrtos.com
+*
+* SPDX-License-Identifier: GPL-2.0-only OR LicenseRef-MDI-Commercial
+*
+* This software, documentation, and accompanying materials are made available
+* under a dual license, either GPLv2 or Commercial. You may not use this file
+* except in compliance with either License. GPLv2 is at www.gnu.org/licenses.
+* It does not permit the incorporation of this code into proprietary programs.
+*
+* Commercial license and support services are available from Micro Digital.
+* Inquire at support@smxrtos.com.
+*
+* This Work embodies patents listed in smx.h. A patent license is hereby
+* granted to use these patents in this Work and Derivative Works, except in
+* another RTOS or OS.
+*
+* This entire comment block must be preserved in all copies of this file.
+*
+*****************************************************************************/
+
+/*
+*  Times the insert and signal code of xeq.c on the host, with list links
+*  only: the differential list (SMX_SIZE_EQ_WHEEL == 0) and ordered count
+*  buckets (SMX_SIZE_EQ_WHEEL == W). See Note 1.
+*
+*     cd XSMX/test
+*     cc -O2 -o beq beq.c && ./beq [max_count]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+typedef uint32_t u32;
+
+#define W      8        /* SMX_SIZE_EQ_WHEEL */
+#define NSIG   4000000  /* signals per run */
+
+typedef struct T {      /* task: TCB fields used by xeq.c */
+   struct T*   fl;
+   struct T*   bl;
+   u32         sv;
+} T;
+
+typedef struct Q {      /* queue head: fl and bl at same offsets as T */
+   T*          fl;
+   T*          bl;
+} Q;
+
+static Q     eq;        /* differential list */
+static u32   ctr;       /* signal counter */
+static Q     bkt[W];    /* count buckets */
+static T*    rq[100000];/* tasks resumed by last signal */
+static int   nrq;
+
+static double now(void)
+{
+   struct timespec t;
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return t.tv_sec*1e9 + t.tv_nsec;
+}
+
+/* differential list, as smx_EventQueueCount_F() with SMX_SIZE_EQ_WHEEL == 0 */
+static void diff_count(T* ct, u32 count)
+{
+   T* nt = eq.fl;
+
+   if (nt)
+   {
+      do
+      {
+         if (count < nt->sv)
+         {
+            nt->sv -= count;
+            break;
+         }
+         count -= nt->sv;
+         nt = nt->fl;
+      } while (nt != (T*)&eq);
+      nt->bl->fl = ct;
+      ct->bl = nt->bl;
+      nt->bl = ct;
+      ct->fl = nt;
+   }
+   else
+   {
+      ct->fl = ct->bl = (T*)&eq;
+      eq.fl = eq.bl = ct;
+   }
+   ct->sv = count;
+}
+
+/* as smx_EventQueueSignal() and smx_EventQueueSignal_F() */
+static void diff_signal(void)
+{
+   T* t;
+
+   if (eq.fl == NULL || --eq.fl->sv != 0)
+      return;
+   t = eq.fl;
+   do
+   {
+      eq.fl = t->fl;
+      t->fl->bl = (T*)&eq;
+      rq[nrq++] = t;
+      t = eq.fl;
+      if (t == (T*)&eq)
+      {
+         eq.fl = NULL;
+         break;
+      }
+   } while (t->sv == 0);
+}
+
+/* ordered count buckets, as smx_EventQueueCount_F() with SMX_SIZE_EQ_WHEEL */
+static void bkt_count(T* ct, u32 count)
+{
+   Q* b;
+   T* nt;
+
+   ct->sv = ctr + count;
+   b = &bkt[ct->sv & (W - 1)];
+   for (nt = b->fl; nt != NULL && nt != (T*)b; nt = nt->fl)
+      if (nt->sv - ctr > count)
+         break;
+   if (nt == NULL)
+   {
+      ct->fl = ct->bl = (T*)b;
+      b->fl = b->bl = ct;
+   }
+   else  /* insert ahead of nt, which may be b */
+   {
+      nt->bl->fl = ct;
+      ct->bl = nt->bl;
+      nt->bl = ct;
+      ct->fl = nt;
+   }
+}
+
+/* as smx_EventQueueSignal() and smx_EventQueueSignal_F() */
+static void bkt_signal(void)
+{
+   Q* b = &bkt[++ctr & (W - 1)];
+   T* t;
+
+   if (b->fl == NULL || b->fl->sv != ctr)
+      return;
+   t = b->fl;
+   do
+   {
+      b->fl = t->fl;
+      t->fl->bl = (T*)b;
+      rq[nrq++] = t;
+      t = b->fl;
+      if (t == (T*)b)
+      {
+         b->fl = NULL;
+         break;
+      }
+   } while (t->sv == ctr);
+}
+
+static void run(int wheel, int n, u32 maxc)
+{
+   void (*count)(T*, u32) = (wheel ? bkt_count : diff_count);
+   void (*signal)(void) = (wheel ? bkt_signal : diff_signal);
+   T*     ts = calloc(n, sizeof(T));
+   u32*   cnt = malloc(n*sizeof(u32));
+   int    reps = 2000000/n;
+   u32    x = 12345;
+   double t0, ins, sig;
+   int    i, r;
+   long   k;
+
+   srand(1);
+   for (i = 0; i < n; i++)
+      cnt[i] = 1 + rand()%maxc;
+
+   /* count: fill an empty event queue with n waiters, repeatedly */
+   t0 = now();
+   for (r = 0; r < reps; r++)
+   {
+      eq.fl = NULL;
+      for (i = 0; i < W; i++)
+         bkt[i].fl = NULL;
+      for (i = 0; i < n; i++)
+         count(&ts[i], cnt[i]);
+   }
+   ins = (now() - t0)/((double)reps*n);
+
+   /* signal: steady state, each resumed task waits again */
+   t0 = now();
+   for (k = 0; k < NSIG; k++)
+   {
+      nrq = 0;
+      signal();
+      for (i = 0; i < nrq; i++)
+      {
+         x = x*1103515245 + 12345;
+         count(rq[i], 1 + (x >> 8)%maxc);
+      }
+   }
+   sig = (now() - t0)/NSIG;
+   printf("  %5.1f / %-5.1f", ins, sig);
+   free(ts);
+   free(cnt);
+}
+
+int main(int argc, char* argv[])
+{
+   static const int ns[] = {4, 16, 64, 256};
+   u32 maxc = (argc > 1 ? (u32)atoi(argv[1]) : 1000);
+   int i;
+
+   printf("ns per count / per signal (with re-waits), counts 1-%u, W = %d\n", maxc, W);
+   printf("waiters  diff list      buckets\n");
+   for (i = 0; i < 4; i++)
+   {
+      printf("%7d", ns[i]);
+      run(0, ns[i], maxc);
+      run(1, ns[i], maxc);
+      printf("\n");
+   }
+   return 0;
+}
+
+/* Notes:
+   1. Only the list operations are modeled: no SSR entry/exit, timeouts, or
+      scheduling. Counts are random from 1 to max_count, and each resumed
+      task waits again with a new random count, so the number of waiters
+      stays constant during the signal run.
+*/
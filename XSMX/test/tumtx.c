@@ -0,0 +1,206 @@
+/*
+* tumtx.c                                                   Version 6.0.0
+*
+* smx Umode Mutex Lock Word Tests
+*
+* Copyright (c) 2026 Micro Digital Inc.
+* All rights reserved. www.smxrtos.com
+*
+* SPDX-License-Identifier: GPL-2.0-only OR LicenseRef-MDI-Commercial
+*
+* This software, documentation, and accompanying materials are made available
+* under a dual license, either GPLv2 or Commercial. You may not use this file
+* except in compliance with either License. GPLv2 is at www.gnu.org/licenses.
+* It does not permit the incorporation of this code into proprietary programs.
+*
+* Commercial license and support services are available from Micro Digital.
+* Inquire at support@smxrtos.com.
+*
+* This Work embodies patents listed in smx.h. A patent license is hereby
+* granted to use these patents in this Work and Derivative Works, except in
+* another RTOS or OS.
+*
+* This entire comment block must be preserved in all copies of this file.
+*
+* Tests smx_MutexSet(SMX_ST_UMTX) lock word binding and owner adoption by
+* smx_MutexGet(), smx_CondVarSignal(), smx_CondVarWait(), task delete, and
+* LSRs. The umode fast path is simulated by writing the lock word as 
+* smxu_MutexGetU() would. Call umtx_test() from appl_init().
+*
+*****************************************************************************/
+
+#include "xsmx.h"
+
+#define TP1 1  /* test task priority */
+
+#define TSSZ 300
+
+void test_umtx(void);
+void tfail(void);
+void tumtx_main(u32);
+
+bool           ts_pass;
+TCB_PTR        tumtx;
+
+void umtx_test(void)
+{
+   sb_ConWriteString(0,0,SB_CLR_WHITE,SB_CLR_BLACK,!SB_CON_BLINK,"Umode Mutex Test  (Built " __DATE__ " " __TIME__ ")");
+   tumtx = smx_TaskCreate(tumtx_main, TP1, 400, 0, "tumtx");
+   smx_TaskStart(tumtx);
+}
+
+void tumtx_main(u32)
+{
+   test_umtx();
+   sb_MsgOut(SB_MSG_INFO, "TESTS DONE");
+   sb_MsgDisplay();
+}
+
+void tfail(void)
+{
+   sb_DEBUGTRAP();
+   ts_pass = false;
+}
+
+/******************************************************************************
+*                                                                             *
+*                          UMODE MUTEX LOCK WORD TESTS                        *
+*                                                                             *
+******************************************************************************/
+
+void tu01(void);
+void tu02(void);
+void tu03(void);
+
+void test_umtx(void)
+{
+   ts_pass   = true;
+   smx_errno = SMXE_OK;
+   tu01();
+   tu02();
+   tu03();
+
+   if(ts_pass)
+      sb_MsgOut(SB_MSG_INFO, "UMODE MUTEXES PASSED");
+   else
+      sb_MsgOut(SB_MSG_WARN, "UMODE MUTEXES FAILED");
+   sb_MsgDisplay();
+}
+
+UMTX        umx;
+MUCB_PTR    mtxu;
+CVCB_PTR    cvu;
+TCB_PTR     tu;
+bool        tu_pass;
+
+void tu01_tu(u32 par) {}
+
+void tu01(void)
+{
+   /* bind umx to mtxu for tumtx's partition */
+   smx_MutexCreate(1, 0, "mtxu", &mtxu);
+   tu = smx_TaskCreate(tu01_tu, smx_ct->pri, TSSZ, 0, "tu");
+   if (!smx_MutexSet(mtxu, SMX_ST_UMTX, (u32)&umx, (u32)tumtx) || umx.lock != 0)
+      tfail();
+
+   /* verify that a claim for a task outside the partition is discarded */
+   umx.lock = (u32)tu;
+   if (smx_MutexGet(mtxu, SMX_TMO_NOWAIT) || smx_errno != SMXE_TOKEN_VIOL ||
+       umx.lock != 0 || smx_MutexPeek(mtxu, SMX_PK_ONR) != 0)
+      tfail();
+   smx_errno = SMXE_OK;
+
+   /* verify that a valid claim is adopted and nests */
+   umx.lock = (u32)tumtx;
+   if (!smx_MutexGet(mtxu, SMX_TMO_NOWAIT) || smx_MutexPeek(mtxu, SMX_PK_ONR) != (u32)tumtx ||
+       smx_MutexPeek(mtxu, SMX_PK_NCNT) != 2 || umx.lock != ((u32)tumtx | SMX_UMTX_KERN))
+      tfail();
+   if (!smx_MutexRel(mtxu) || !smx_MutexRel(mtxu) || umx.lock != 0)
+      tfail();
+
+   /* verify that deleting tu resets a lock word it holds */
+   umx.lock = (u32)tu;
+   smx_TaskDelete(&tu);
+   if (umx.lock != 0)
+      tfail();
+}
+
+void tu02_tu(u32 par);
+
+void tu02(void)
+{
+   smx_CondVarCreate("cvu", &cvu);
+   tu = smx_TaskCreate(tu02_tu, smx_ct->pri, TSSZ, 0, "tu");
+   tu_pass = false;
+
+   /* let tu get mtxu and wait at cvu */
+   smx_TaskStart(tu);
+   smx_TaskBump(tumtx, SMX_PRI_NOCHG);
+
+   /* get mtxu via lock word, then verify that signal adopts tumtx as owner and
+      moves tu to the mtxu wait queue */
+   umx.lock = (u32)tumtx;
+   if (!smx_CondVarSignal(cvu) || smx_MutexPeek(mtxu, SMX_PK_ONR) != (u32)tumtx ||
+       smx_MutexPeek(mtxu, SMX_PK_FIRST) != (u32)tu)
+      tfail();
+
+   /* release mtxu to tu and let it finish */
+   if (!smx_MutexRel(mtxu))
+      tfail();
+   smx_TaskBump(tumtx, SMX_PRI_NOCHG);
+   if (!tu_pass || umx.lock != 0)
+      tfail();
+
+   /* verify that wait adopts tumtx before checking the owner */
+   umx.lock = (u32)tumtx;
+   if (smx_CondVarWait(cvu, mtxu, SMX_TMO_NOWAIT) || smx_errno != SMXE_OK ||
+       smx_MutexPeek(mtxu, SMX_PK_ONR) != (u32)tumtx || !smx_MutexRel(mtxu))
+      tfail();
+
+   /* cleanup */
+   smx_TaskDelete(&tu);
+   smx_CondVarDelete(&cvu);
+}
+
+void tu02_tu(u32 par)
+{
+   if (smx_MutexGet(mtxu, SMX_TMO_NOWAIT) && smx_CondVarWait(cvu, mtxu, SMX_TMO_INF) &&
+       smx_MutexPeek(mtxu, SMX_PK_ONR) == (u32)tu)
+      tu_pass = smx_MutexRel(mtxu);
+}
+
+UMTX        umc;
+MUCB_PTR    mtxc;
+LCB_PTR     lsru;
+bool        lsru_pass;
+
+void tu03_lsr(u32 par)
+{
+   lsru_pass = smx_MutexGet((MUCB_PTR)par, SMX_TMO_NOWAIT);
+}
+
+void tu03(void)
+{
+   /* verify that an LSR sees a free mutex with a ceiling as free */
+   smx_MutexCreate(0, smx_ct->pri + 1, "mtxc", &mtxc);
+   smx_MutexSet(mtxc, SMX_ST_UMTX, (u32)&umc, (u32)tumtx);
+   lsru = smx_LSRCreate(tu03_lsr, SMX_FL_TRUST, "lsru");
+   lsru_pass = false;
+   if (umc.lock != SMX_UMTX_KERN || !smx_LSRInvoke(lsru, (u32)mtxc) || !lsru_pass)
+      tfail();
+
+   /* verify that it sees the mutex as busy if the lock word is taken */
+   umc.lock = (u32)tumtx;
+   if (!smx_LSRInvoke(lsru, (u32)mtxc) || lsru_pass)
+      tfail();
+   umc.lock = SMX_UMTX_KERN;
+
+   /* cleanup */
+   smx_LSRDelete(&lsru);
+   smx_MutexDelete(&mtxc);
+   smx_MutexDelete(&mtxu);
+
+   /* verify that delete removed both mutexes from the bound list */
+   if (smx_umtxl != NULL)
+      tfail();
+}
@@ -51,6 +51,12 @@ u32      smx_BlockPoolPeek(PCB_PTR pool, SMX_PK_PAR par);
 
 bool     smx_CBPoolsCreate(void);
 
+bool     smx_CondVarBroadcast(CVCB_PTR cv);
+CVCB_PTR smx_CondVarCreate(const char* name=NULL, CVCB_PTR* cvhp=NULL);
+bool     smx_CondVarDelete(CVCB_PTR* cvhp);
+bool     smx_CondVarSignal(CVCB_PTR cv);
+bool     smx_CondVarWait(CVCB_PTR cv, MUCB_PTR mtx, u32 timeout=SMX_TMO_DFLT);
+
 bool     smx_EventFlagsPulse(EGCB_PTR eg, u32 pulse_mask);
 bool     smx_EventFlagsSet(EGCB_PTR eg, u32 set_mask, u32 pre_clear_mask);
 u32      smx_EventFlagsTest(EGCB_PTR eg, u32 test_mask, u32 mode, u32 post_clear_mask, u32 timeout=SMX_TMO_DFLT);
@@ -76,17 +82,36 @@ u32      smx_HeapBinPeek(u32 binno, EH_PK_PAR par, u32 hn=0);
 bool     smx_HeapBinScan(u32 binno, u32 fnum, u32 bnum, u32 hn=0);
 bool     smx_HeapBinSeed(u32 num, u32 bsz, u32 hn=0);
 bool     smx_HeapBinSort(u32 binno, u32 fnum, u32 hn=0);
+void*    smx_HeapBuddyGet(u32 sz, u32 hn=0);
+bool     smx_HeapBuddyInit(u32 an, u8* ap=NULL, u32 hn=0);
+u32      smx_HeapBuddyPeek(EH_PK_PAR par, u32 hn=0);
 void*    smx_HeapCalloc(u32 num, u32 sz, u32 an=0, u32 hn=0);
 u32      smx_HeapChunkPeek(void* vp, EH_PK_PAR par, u32 hn=0);
+bool     smx_HeapCompact(u32 num, u32 hn=0);
 bool     smx_HeapExtend(u32 xsz, u8* xp, u32 hn=0);
 bool     smx_HeapFree(void* bp, u32 hn=0);
+bool     smx_HeapFreeM(void** bpp, u32 n, u32 hn=0);
+bool     smx_HeapFreeP(void* bp);
+EHH_PTR  smx_HeapHandleAlloc(u32 sz, u32 hn=0);
+bool     smx_HeapHandleFree(EHH_PTR hp, u32 hn=0);
+void*    smx_HeapHandleLock(EHH_PTR hp, u32 hn=0);
+bool     smx_HeapHandleUnlock(EHH_PTR hp, u32 hn=0);
 u32      smx_HeapInit(u32 sz, u32 dcsz, u8* hp, EHV_PTR vp, u32* bszap, HBCB* binp, u32 mode, const char* name=NULL);
 void*    smx_HeapMalloc(u32 sz, u32 an=0, u32 hn=0);
+bool     smx_HeapMallocM(const u32* szp, u32 n, void** bpp, u32 hn=0);
+void*    smx_HeapMallocP(u32 sz, u32 an=0, u32 hint=SMX_HP_TASK);
+u32      smx_HeapOwnerPeek(u32 onr, EH_PK_PAR par, u32 hn=0);
 u32      smx_HeapPeek(EH_PK_PAR par, u32 hn=0);
+bool     smx_HeapPlaceSet(SMX_HP hint, const u8* hnl, u32 num);
+bool     smx_HeapPlaceTask(TCB_PTR task, SMX_HP hint);
+u32      smx_HeapPoolPeek(u32 pn, EH_PK_PAR par, u32 hn=0);
+bool     smx_HeapPoolTrim(u32 hn=0);
 void*    smx_HeapRealloc(void* cbp, u32 sz, u32 an=0, u32 hn=0);
 bool     smx_HeapRecover(u32 sz, u32 num, u32 an=0, u32 hn=0);
 bool     smx_HeapScan(CCB_PTR cp, u32 fnum, u32 bnum, u32 hn=0);
 bool     smx_HeapSet(EH_ST_PAR par, u32 val, u32 hn=0);
+u32      smx_HeapSitePeek(u32 site, EH_PK_PAR par, u32 hn=0);
+void     smx_HeapSiteSet(u32 site);
 
 bool     smx_HTAdd(void* h, const char* name);
 bool     smx_HTDelete(void* h);
@@ -106,12 +131,16 @@ bool     smx_LSRsOn(void);
 
 bool     smx_MsgBump(MCB_PTR msg, u8 pri);
 MCB_PTR  smx_MsgGet(PCB_PTR pool, u8** bpp=NULL, u16 clrsz=0, MCB_PTR* mhp=NULL);
+MCB_PTR  smx_MsgGetSz(MPS_PTR set, u32 sz, u8** bpp=NULL, u16 clrsz=0, MCB_PTR* mhp=NULL);
 MCB_PTR  smx_MsgMake(u8* bp, u32 bs=-1, MCB_PTR* mhp=NULL);
 u32      smx_MsgPeek(MCB_PTR msg, SMX_PK_PAR par);
 MCB_PTR  smx_MsgReceive(XCB_PTR xchg, u8** bpp=NULL, u32 timeout=SMX_TMO_DFLT, MCB_PTR* mhp=NULL);
+MCB_PTR  smx_MsgReceiveAny(XCB_PTR* xl, u32 num, u8** bpp=NULL, u32 timeout=SMX_TMO_DFLT, MCB_PTR* mhp=NULL, u32* xip=NULL);
+u32      smx_MsgReceiveM(XCB_PTR xchg, MCB_PTR* mcba, u32 max, u32 timeout=SMX_TMO_DFLT);
 void     smx_MsgReceiveStop(XCB_PTR xchg, u8** bpp=NULL, u32 timeout=SMX_TMO_DFLT, MCB_PTR* mhp=NULL);
 bool     smx_MsgRel(MCB_PTR msg, u16 clrsz=0);
 u32      smx_MsgRelAll(TCB_PTR task);
+u32      smx_MsgRelM(MCB_PTR* mcba, u32 n, u16 clrsz);
 bool     smx_MsgSend(MCB_PTR msg, XCB_PTR xchg, u8 pri=0, void* reply=NULL);
 u8*      smx_MsgUnmake(MCB_PTR msg, u32* bsp=NULL);
 
@@ -128,13 +157,15 @@ bool     smx_MutexFree(MUCB_PTR mtx);
 bool     smx_MutexGet(MUCB_PTR mtx, u32 timeout=SMX_TMO_DFLT);
 bool     smx_MutexGetFast(MUCB_PTR mtx, u32 timeout=SMX_TMO_DFLT);
 void     smx_MutexGetStop(MUCB_PTR mtx, u32 timeout=SMX_TMO_DFLT);
+bool     smx_MutexGetU(UMTX_PTR um, u32 timeout=SMX_TMO_DFLT);
 u32      smx_MutexPeek(MUCB_PTR mtx, SMX_PK_PAR par);
 bool     smx_MutexRel(MUCB_PTR mtx);
 void     smx_MutexRelFast(MUCB_PTR mtx);
+bool     smx_MutexRelU(UMTX_PTR um);
 bool     smx_MutexSet(MUCB_PTR mtx, SMX_ST_PAR par, u32 v1, u32 v2=0);
 
 bool     smx_PipeClear(PICB_PTR pipe);
-PICB_PTR smx_PipeCreate(void* ppb, u8 width, u16 length, const char* name=NULL, PICB_PTR* php=NULL);
+PICB_PTR smx_PipeCreate(void* ppb, u16 width, u16 length, const char* name=NULL, PICB_PTR* php=NULL);
 void*    smx_PipeDelete(PICB_PTR* php);
 bool     smx_PipeGet8(PICB_PTR pipe, u8* bp);
 u32      smx_PipeGet8M(PICB_PTR pipe, u8* bp, u32 lim);
@@ -142,6 +173,7 @@ bool     smx_PipeGetPkt(PICB_PTR pipe, void* pdst);
 bool     smx_PipeGetPktWait(PICB_PTR pipe, void* pdst, u32 timeout=SMX_TMO_DFLT);
 void     smx_PipeGetPktWaitStop(PICB_PTR pipe, void* pdst, u32 timeout=SMX_TMO_DFLT);
 u32      smx_PipePeek(PICB_PTR pipe, SMX_PK_PAR par);
+bool     smx_PipePeekWait(PICB_PTR pipe, void* pdst, u32 timeout=SMX_TMO_DFLT);
 bool     smx_PipePut8(PICB_PTR pipe, u8 b);
 u32      smx_PipePut8M(PICB_PTR pipe, u8* bp, u32 lim);
 bool     smx_PipePutPkt(PICB_PTR pipe, void* psrc);
@@ -168,13 +200,15 @@ bool     smx_PMsgSendB(MCB_PTR pmsg, XCB_PTR xchg, u8 pri=0, void* reply=NULL);
 #endif
 
 bool     smx_SemClear(SCB_PTR sem);
-SCB_PTR  smx_SemCreate(SMX_SEM_MODE mode, u8 lim, const char* name=NULL, SCB_PTR* shp=NULL);
+SCB_PTR  smx_SemCreate(SMX_SEM_MODE mode, u32 lim, const char* name=NULL, SCB_PTR* shp=NULL);
 bool     smx_SemDelete(SCB_PTR* shp);
 u32      smx_SemPeek(SCB_PTR sem, SMX_PK_PAR par);
 bool     smx_SemSet(SCB_PTR sem, SMX_ST_PAR par, u32 v1, u32 v2=0);
 bool     smx_SemSignal(SCB_PTR sem);
+bool     smx_SemSignalN(SCB_PTR sem, u32 n);
 bool     smx_SemTest(SCB_PTR sem, u32 timeout=SMX_TMO_DFLT);
 void     smx_SemTestStop(SCB_PTR sem, u32 timeout=SMX_TMO_DFLT);
+bool     smx_SemTestWrtr(SCB_PTR sem, u32 timeout=SMX_TMO_DFLT);
 
 u32      smx_SysPeek(SMX_PK_PAR par);
 bool     smx_SysPowerDown(u32 power_mode);
@@ -228,6 +262,12 @@ u32      smx_BlockPoolPeek(PCB_PTR pool, SMX_PK_PAR par);
 
 bool     smx_CBPoolsCreate(void);
 
+bool     smx_CondVarBroadcast(CVCB_PTR cv);
+CVCB_PTR smx_CondVarCreate(const char* name, CVCB_PTR* cvhp);
+bool     smx_CondVarDelete(CVCB_PTR* cvhp);
+bool     smx_CondVarSignal(CVCB_PTR cv);
+bool     smx_CondVarWait(CVCB_PTR cv, MUCB_PTR mtx, u32 timeout);
+
 bool     smx_EventFlagsPulse(EGCB_PTR eg, u32 pulse_mask);
 bool     smx_EventFlagsSet(EGCB_PTR eg, u32 set_mask, u32 pre_clear_mask);
 u32      smx_EventFlagsTest(EGCB_PTR eg, u32 test_mask, u32 mode, u32 post_clear_mask, u32 timeout);
@@ -253,17 +293,36 @@ u32      smx_HeapBinPeek(u32 binno, EH_PK_PAR par, u32 hn);
 bool     smx_HeapBinScan(u32 binno, u32 fnum, u32 bnum, u32 hn);
 bool     smx_HeapBinSeed(u32 num, u32 bsz, u32 hn);
 bool     smx_HeapBinSort(u32 binno, u32 fnum, u32 hn);
+void*    smx_HeapBuddyGet(u32 sz, u32 hn);
+bool     smx_HeapBuddyInit(u32 an, u8* ap, u32 hn);
+u32      smx_HeapBuddyPeek(EH_PK_PAR par, u32 hn);
 void*    smx_HeapCalloc(u32 num, u32 sz, u32 an, u32 hn);
 u32      smx_HeapChunkPeek(void* vp, EH_PK_PAR par, u32 hn);
+bool     smx_HeapCompact(u32 num, u32 hn);
 bool     smx_HeapExtend(u32 xsz, u8* xp, u32 hn);
 bool     smx_HeapFree(void* bp, u32 hn);
+bool     smx_HeapFreeM(void** bpp, u32 n, u32 hn);
+bool     smx_HeapFreeP(void* bp);
+EHH_PTR  smx_HeapHandleAlloc(u32 sz, u32 hn);
+bool     smx_HeapHandleFree(EHH_PTR hp, u32 hn);
+void*    smx_HeapHandleLock(EHH_PTR hp, u32 hn);
+bool     smx_HeapHandleUnlock(EHH_PTR hp, u32 hn);
 u32      smx_HeapInit(u32 sz, u32 dcsz, u8* hp, EHV_PTR vp, u32* bszap, HBCB* binp, u32 mode, const char* name);
 void*    smx_HeapMalloc(u32 sz, u32 an, u32 hn);
+bool     smx_HeapMallocM(const u32* szp, u32 n, void** bpp, u32 hn);
+void*    smx_HeapMallocP(u32 sz, u32 an, u32 hint);
+u32      smx_HeapOwnerPeek(u32 onr, EH_PK_PAR par, u32 hn);
 u32      smx_HeapPeek(EH_PK_PAR par, u32 hn);
+bool     smx_HeapPlaceSet(SMX_HP hint, const u8* hnl, u32 num);
+bool     smx_HeapPlaceTask(TCB_PTR task, SMX_HP hint);
+u32      smx_HeapPoolPeek(u32 pn, EH_PK_PAR par, u32 hn);
+bool     smx_HeapPoolTrim(u32 hn);
 void*    smx_HeapRealloc(void* cbp, u32 sz, u32 an, u32 hn);
 bool     smx_HeapRecover(u32 sz, u32 num, u32 an, u32 hn);
 bool     smx_HeapScan(CCB_PTR cp, u32 fnum, u32 bnum, u32 hn);
 bool     smx_HeapSet(EH_ST_PAR par, u32 val, u32 hn);
+u32      smx_HeapSitePeek(u32 site, EH_PK_PAR par, u32 hn);
+void     smx_HeapSiteSet(u32 site);
 
 bool     smx_HTAdd(void* h, const char* name);
 bool     smx_HTDelete(void* h);
@@ -280,12 +339,16 @@ bool     smx_LSRsOn(void);
 
 bool     smx_MsgBump(MCB_PTR msg, u8 pri);
 MCB_PTR  smx_MsgGet(PCB_PTR pool, u8** bpp, u16 clrsz, MCB_PTR* mhp);
+MCB_PTR  smx_MsgGetSz(MPS_PTR set, u32 sz, u8** bpp, u16 clrsz, MCB_PTR* mhp);
 MCB_PTR  smx_MsgMake(u8* bp, u32 bs, MCB_PTR* mhp);
 u32      smx_MsgPeek(MCB_PTR msg, SMX_PK_PAR par);
 MCB_PTR  smx_MsgReceive(XCB_PTR xchg, u8** bpp, u32 timeout, MCB_PTR* mhp);
+MCB_PTR  smx_MsgReceiveAny(XCB_PTR* xl, u32 num, u8** bpp, u32 timeout, MCB_PTR* mhp, u32* xip);
+u32      smx_MsgReceiveM(XCB_PTR xchg, MCB_PTR* mcba, u32 max, u32 timeout);
 void     smx_MsgReceiveStop(XCB_PTR xchg, u8** bpp, u32 timeout, MCB_PTR* mhp);
 bool     smx_MsgRel(MCB_PTR msg, u16 clrsz);
 u32      smx_MsgRelAll(TCB_PTR task);
+u32      smx_MsgRelM(MCB_PTR* mcba, u32 n, u16 clrsz);
 bool     smx_MsgSend(MCB_PTR msg, XCB_PTR xchg, u8 pri, void* reply);
 u8*      smx_MsgUnmake(MCB_PTR msg, u32* bsp);
 
@@ -302,13 +365,15 @@ bool     smx_MutexFree(MUCB_PTR mtx);
 bool     smx_MutexGet(MUCB_PTR mtx, u32 timeout);
 bool     smx_MutexGetFast(MUCB_PTR mtx, u32 timeout);
 void     smx_MutexGetStop(MUCB_PTR mtx, u32 timeout);
+bool     smx_MutexGetU(UMTX_PTR um, u32 timeout);
 bool     smx_MutexRel(MUCB_PTR mtx);
 u32      smx_MutexPeek(MUCB_PTR mtx, SMX_PK_PAR par);
 void     smx_MutexRelFast(MUCB_PTR mtx);
+bool     smx_MutexRelU(UMTX_PTR um);
 bool     smx_MutexSet(MUCB_PTR mtx, SMX_ST_PAR par, u32 v1, u32 v2);
 
 bool     smx_PipeClear(PICB_PTR pipe);
-PICB_PTR smx_PipeCreate(void* ppb, u8 width, u16 length, const char* name, PICB_PTR* php);
+PICB_PTR smx_PipeCreate(void* ppb, u16 width, u16 length, const char* name, PICB_PTR* php);
 void*    smx_PipeDelete(PICB_PTR* php);
 bool     smx_PipeGet8(PICB_PTR pipe, u8* bp);
 u32      smx_PipeGet8M(PICB_PTR pipe, u8* bp, u32 lim);
@@ -316,6 +381,7 @@ bool     smx_PipeGetPkt(PICB_PTR pipe, void* pdst);
 bool     smx_PipeGetPktWait(PICB_PTR pipe, void* pdst, u32 timeout);
 void     smx_PipeGetPktWaitStop(PICB_PTR pipe, void* pdst, u32 timeout);
 u32      smx_PipePeek(PICB_PTR pipe, SMX_PK_PAR par);
+bool     smx_PipePeekWait(PICB_PTR pipe, void* pdst, u32 timeout);
 bool     smx_PipePut8(PICB_PTR pipe, u8 b);
 u32      smx_PipePut8M(PICB_PTR pipe, u8* bp, u32 lim);
 bool     smx_PipePutPkt(PICB_PTR pipe, void* psrc);
@@ -342,13 +408,15 @@ bool     smx_PMsgSendB(MCB_PTR pmsg, XCB_PTR xchg, u8 pri, void* reply);
 #endif
 
 bool     smx_SemClear(SCB_PTR sem);
-SCB_PTR  smx_SemCreate(SMX_SEM_MODE mode, u8 lim, const char* name, SCB_PTR* shp);
+SCB_PTR  smx_SemCreate(SMX_SEM_MODE mode, u32 lim, const char* name, SCB_PTR* shp);
 bool     smx_SemDelete(SCB_PTR* shp);
 u32      smx_SemPeek(SCB_PTR sem, SMX_PK_PAR par);
 bool     smx_SemSet(SCB_PTR sem, SMX_ST_PAR par, u32 v1, u32 v2);
 bool     smx_SemSignal(SCB_PTR sem);
+bool     smx_SemSignalN(SCB_PTR sem, u32 n);
 bool     smx_SemTest(SCB_PTR sem, u32 timeout);
 void     smx_SemTestStop(SCB_PTR sem, u32 timeout);
+bool     smx_SemTestWrtr(SCB_PTR sem, u32 timeout);
 
 u32      smx_SysPeek(SMX_PK_PAR par);
 bool     smx_SysPowerDown(u32 power_mode);
@@ -472,6 +540,17 @@ bool     mp_RegionMakeT(u8* bp, u32 sz, u8 sn, u32 attr, const char* name);
 #define  smx_DelayTicks(t)          smx_TaskSuspend(SMX_CT, (t)+1)
 #define  smx_LSR_INVOKE(lsr, par)   smx_LSRInvokeF(lsr, par)
 
+/* heap call site for wrappers of heap services <6> */
+#if EH_OSTATS
+#if defined(__IAR_SYSTEMS_ICC__)
+#define  smx_HEAP_SITE_SET()        smx_HeapSiteSet(__get_LR())
+#else
+#define  smx_HEAP_SITE_SET()        smx_HeapSiteSet((u32)__builtin_return_address(0))
+#endif
+#else
+#define  smx_HEAP_SITE_SET()
+#endif
+
 #if !SMX_CFG_SSMX
 #define  smx_TaskYield()            smx_TaskBump(smx_ct, SMX_PRI_NOCHG)
 #endif
@@ -506,4 +585,7 @@ PNHX set_new_handler(PNHX a_new_handler);
       use these rather than the versions provided with the compiler,
       to ensure that smx heap functions are used and that no unwanted behavior
       is present. Also see XSMX\xheap.c for implementation of these operators.
+   6. A function that wraps a heap allocation service, such as malloc(), 
+      starts with smx_HEAP_SITE_SET() so that its caller, rather than the 
+      wrapper, is recorded as the call site. See XSMX\xheap.c note 4.
 */
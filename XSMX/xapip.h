@@ -43,6 +43,12 @@
 #undef smx_BlockPoolDelete
 #undef smx_BlockPoolPeek
 
+#undef smx_CondVarBroadcast
+#undef smx_CondVarCreate
+#undef smx_CondVarDelete
+#undef smx_CondVarSignal
+#undef smx_CondVarWait
+
 #undef smx_EventFlagsPulse
 #undef smx_EventFlagsSet
 #undef smx_EventFlagsTest
@@ -66,17 +72,36 @@
 #undef smx_HeapBinScan
 #undef smx_HeapBinSeed
 #undef smx_HeapBinSort
+#undef smx_HeapBuddyGet
+#undef smx_HeapBuddyInit
+#undef smx_HeapBuddyPeek
 #undef smx_HeapCalloc
 #undef smx_HeapChunkPeek
+#undef smx_HeapCompact
 #undef smx_HeapExtend
 #undef smx_HeapFree
+#undef smx_HeapFreeM
+#undef smx_HeapFreeP
+#undef smx_HeapHandleAlloc
+#undef smx_HeapHandleFree
+#undef smx_HeapHandleLock
+#undef smx_HeapHandleUnlock
 #undef smx_HeapInit
 #undef smx_HeapMalloc
+#undef smx_HeapMallocM
+#undef smx_HeapMallocP
+#undef smx_HeapOwnerPeek
 #undef smx_HeapPeek
+#undef smx_HeapPlaceSet
+#undef smx_HeapPlaceTask
+#undef smx_HeapPoolPeek
+#undef smx_HeapPoolTrim
 #undef smx_HeapRealloc
 #undef smx_HeapRecover
 #undef smx_HeapScan
 #undef smx_HeapSet
+#undef smx_HeapSitePeek
+#undef smx_HeapSiteSet
 
 #undef smx_HTAdd
 #undef smx_HTDelete
@@ -92,12 +117,16 @@
 
 #undef smx_MsgBump
 #undef smx_MsgGet
+#undef smx_MsgGetSz
 #undef smx_MsgMake
 #undef smx_MsgPeek
 #undef smx_MsgReceive
+#undef smx_MsgReceiveAny
+#undef smx_MsgReceiveM
 #undef smx_MsgReceiveStop
 #undef smx_MsgRel
 #undef smx_MsgRelAll
+#undef smx_MsgRelM
 #undef smx_MsgSend
 #undef smx_MsgUnmake
 
@@ -113,9 +142,11 @@
 #undef smx_MutexFree
 #undef smx_MutexGet
 #undef smx_MutexGetStop
+#undef smx_MutexGetU
 #undef smx_MutexPeek
 #undef smx_MutexSet
 #undef smx_MutexRel
+#undef smx_MutexRelU
 
 #undef smx_PipeClear
 #undef smx_PipeCreate
@@ -126,6 +157,7 @@
 #undef smx_PipeGetPktWait
 #undef smx_PipeGetPktWaitStop
 #undef smx_PipePeek
+#undef smx_PipePeekWait
 #undef smx_PipePut8
 #undef smx_PipePut8M
 #undef smx_PipePutPkt
@@ -154,8 +186,10 @@
 #undef smx_SemPeek
 #undef smx_SemSet
 #undef smx_SemSignal
+#undef smx_SemSignalN
 #undef smx_SemTest
 #undef smx_SemTestStop
+#undef smx_SemTestWrtr
 
 #undef smx_SysPeek
 #undef smx_SysPowerDown
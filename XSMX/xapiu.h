@@ -56,6 +56,12 @@ PCB_PTR  smxu_BlockPoolCreate(u8* p, u16 num, u16 size, const char* name=NULL, P
 u8*      smxu_BlockPoolDelete(PCB_PTR* php);
 u32      smxu_BlockPoolPeek(PCB_PTR pool, SMX_PK_PAR par);
 
+bool     smxu_CondVarBroadcast(CVCB_PTR cv);
+CVCB_PTR smxu_CondVarCreate(const char* name=NULL, CVCB_PTR* cvhp=NULL);
+bool     smxu_CondVarDelete(CVCB_PTR* cvhp);
+bool     smxu_CondVarSignal(CVCB_PTR cv);
+bool     smxu_CondVarWait(CVCB_PTR cv, MUCB_PTR mtx, u32 timeout=SMX_TMO_DFLT);
+
 bool     smxu_EventFlagsPulse(EGCB_PTR eg, u32 pulse_mask);
 bool     smxu_EventFlagsSet(EGCB_PTR eg, u32 set_mask, u32 pre_clear_mask);
 u32      smxu_EventFlagsTest(EGCB_PTR eg, u32 test_mask, u32 mode, u32 post_clear_mask, u32 timeout=SMX_TMO_DFLT);
@@ -97,12 +103,16 @@ bool     smxu_LSRsOn(void);
 
 bool     smxu_MsgBump(MCB_PTR msg, u8 pri);
 MCB_PTR  smxu_MsgGet(PCB_PTR pool, u8** bpp=NULL, u16 clrsz=0, MCB_PTR* mhp=NULL);
+MCB_PTR  smxu_MsgGetSz(MPS_PTR set, u32 sz, u8** bpp=NULL, u16 clrsz=0, MCB_PTR* mhp=NULL);
 MCB_PTR  smxu_MsgMake(u8* bp, u32 bs=-1, MCB_PTR* mhp=NULL);
 u32      smxu_MsgPeek(MCB_PTR msg, SMX_PK_PAR par);
 MCB_PTR  smxu_MsgReceive(XCB_PTR xchg, u8** bpp=NULL, u32 timeout=SMX_TMO_DFLT, MCB_PTR* mhp=NULL);
+MCB_PTR  smxu_MsgReceiveAny(XCB_PTR* xl, u32 num, u8** bpp=NULL, u32 timeout=SMX_TMO_DFLT, MCB_PTR* mhp=NULL, u32* xip=NULL);
+u32      smxu_MsgReceiveM(XCB_PTR xchg, MCB_PTR* mcba, u32 max, u32 timeout=SMX_TMO_DFLT);
 void     smxu_MsgReceiveStop(XCB_PTR xchg, u8** bpp=NULL, u32 timeout=SMX_TMO_DFLT, MCB_PTR* mhp=NULL);
 bool     smxu_MsgRel(MCB_PTR msg, u16 clrsz=0);
 u32      smxu_MsgRelAll(TCB_PTR task);
+u32      smxu_MsgRelM(MCB_PTR* mcba, u32 n, u16 clrsz);
 bool     smxu_MsgSend(MCB_PTR msg, XCB_PTR xchg, u8 pri, void* reply=NULL);
 u8*      smxu_MsgUnmake(MCB_PTR msg, u32* bsp=NULL);
 
@@ -117,12 +127,14 @@ bool     smxu_MutexDelete(MUCB_PTR* muhp);
 bool     smxu_MutexFree(MUCB_PTR mtx);
 bool     smxu_MutexGet(MUCB_PTR mtx, u32 timeout=SMX_TMO_DFLT);
 void     smxu_MutexGetStop(MUCB_PTR mtx, u32 timeout=SMX_TMO_DFLT);
+bool     smxu_MutexGetU(UMTX_PTR um, u32 timeout=SMX_TMO_DFLT);
 u32      smxu_MutexPeek(MUCB_PTR mtx, SMX_PK_PAR par);
 bool     smxu_MutexRel(MUCB_PTR mtx);
+bool     smxu_MutexRelU(UMTX_PTR um);
 bool     smxu_MutexSet(MUCB_PTR mtx, SMX_ST_PAR par, u32 v1, u32 v2=0);
 
 bool     smxu_PipeClear(PICB_PTR pipe);
-PICB_PTR smxu_PipeCreate(void* ppb, u8 width, u16 length, const char* name=NULL, PICB_PTR* php=NULL);
+PICB_PTR smxu_PipeCreate(void* ppb, u16 width, u16 length, const char* name=NULL, PICB_PTR* php=NULL);
 void*    smxu_PipeDelete(PICB_PTR* php);
 bool     smxu_PipeGet8(PICB_PTR pipe, u8* bp);
 u32      smxu_PipeGet8M(PICB_PTR pipe, u8* bp, u32 lim);
@@ -130,6 +142,7 @@ void     smxu_PipeGetPkt(PICB_PTR pipe, void* pdst);
 bool     smxu_PipeGetPktWait(PICB_PTR pipe, void* pdst, u32 timeout=SMX_TMO_DFLT);
 void     smxu_PipeGetPktWaitStop(PICB_PTR pipe, void* pdst, u32 timeout=SMX_TMO_DFLT);
 u32      smxu_PipePeek(PICB_PTR pipe, SMX_PK_PAR par);
+bool     smxu_PipePeekWait(PICB_PTR pipe, void* pdst, u32 timeout=SMX_TMO_DFLT);
 bool     smxu_PipePut8(PICB_PTR pipe, u8 b);
 u32      smxu_PipePut8M(PICB_PTR pipe, u8* bp, u32 lim);
 void     smxu_PipePutPkt(PICB_PTR pipe, void* psrc);
@@ -153,12 +166,14 @@ bool     smxu_PMsgSend(MCB_PTR pmsg, XCB_PTR xchg, u8 pri=0, void* reply=NULL);
 bool     smxu_PMsgSendB(MCB_PTR pmsg, XCB_PTR xchg, u8 pri=0, void* reply=NULL);
 
 bool     smxu_SemClear(SCB_PTR sem);
-SCB_PTR  smxu_SemCreate(SMX_SEM_MODE mode, u8 lim, const char* name=NULL, SCB_PTR* shp=NULL);
+SCB_PTR  smxu_SemCreate(SMX_SEM_MODE mode, u32 lim, const char* name=NULL, SCB_PTR* shp=NULL);
 bool     smxu_SemDelete(SCB_PTR* shp);
 u32      smxu_SemPeek(SCB_PTR sem, SMX_PK_PAR par);
 bool     smxu_SemSignal(SCB_PTR sem);
+bool     smxu_SemSignalN(SCB_PTR sem, u32 n);
 bool     smxu_SemTest(SCB_PTR sem, u32 timeout=SMX_TMO_DFLT);
 void     smxu_SemTestStop(SCB_PTR sem, u32 timeout=SMX_TMO_DFLT);
+bool     smxu_SemTestWrtr(SCB_PTR sem, u32 timeout=SMX_TMO_DFLT);
 
 u32      smxu_SysPeek(SMX_PK_PAR par);
 void*    smxu_SysPseudoHandleCreate(void);
@@ -246,6 +261,12 @@ PCB_PTR  smxu_BlockPoolCreate(u8* p, u16 num, u16 size, const char* name, PCB_PT
 u8*      smxu_BlockPoolDelete(PCB_PTR* php);
 u32      smxu_BlockPoolPeek(PCB_PTR pool, SMX_PK_PAR par);
 
+bool     smxu_CondVarBroadcast(CVCB_PTR cv);
+CVCB_PTR smxu_CondVarCreate(const char* name, CVCB_PTR* cvhp);
+bool     smxu_CondVarDelete(CVCB_PTR* cvhp);
+bool     smxu_CondVarSignal(CVCB_PTR cv);
+bool     smxu_CondVarWait(CVCB_PTR cv, MUCB_PTR mtx, u32 timeout);
+
 bool     smxu_EventFlagsPulse(EGCB_PTR eg, u32 pulse_mask);
 bool     smxu_EventFlagsSet(EGCB_PTR eg, u32 set_mask, u32 pre_clear_mask);
 u32      smxu_EventFlagsTest(EGCB_PTR eg, u32 test_mask, u32 mode, u32 post_clear_mask, u32 timeout);
@@ -287,12 +308,16 @@ bool     smxu_LSRsOn(void);
 
 bool     smxu_MsgBump(MCB_PTR msg, u8 pri);
 MCB_PTR  smxu_MsgGet(PCB_PTR pool, u8** bpp, u16 clrsz, MCB_PTR* mhp);
+MCB_PTR  smxu_MsgGetSz(MPS_PTR set, u32 sz, u8** bpp, u16 clrsz, MCB_PTR* mhp);
 MCB_PTR  smxu_MsgMake(u8* bp, u32 bs, MCB_PTR* mhp);
 u32      smxu_MsgPeek(MCB_PTR msg, SMX_PK_PAR par);
 MCB_PTR  smxu_MsgReceive(XCB_PTR xchg, u8** bpp, u32 timeout, MCB_PTR* mhp);
+MCB_PTR  smxu_MsgReceiveAny(XCB_PTR* xl, u32 num, u8** bpp, u32 timeout, MCB_PTR* mhp, u32* xip);
+u32      smxu_MsgReceiveM(XCB_PTR xchg, MCB_PTR* mcba, u32 max, u32 timeout);
 void     smxu_MsgReceiveStop(XCB_PTR xchg, u8** bpp, u32 timeout, MCB_PTR* mhp);
 bool     smxu_MsgRel(MCB_PTR msg, u16 clrsz);
 u32      smxu_MsgRelAll(TCB_PTR task);
+u32      smxu_MsgRelM(MCB_PTR* mcba, u32 n, u16 clrsz);
 bool     smxu_MsgSend(MCB_PTR msg, XCB_PTR xchg, u8 pri, void* reply);
 u8*      smxu_MsgUnmake(MCB_PTR msg, u32* bsp);
 
@@ -307,12 +332,14 @@ bool     smxu_MutexDelete(MUCB_PTR* muhp);
 bool     smxu_MutexFree(MUCB_PTR mtx);
 bool     smxu_MutexGet(MUCB_PTR mtx, u32 timeout);
 void     smxu_MutexGetStop(MUCB_PTR mtx, u32 timeout);
+bool     smxu_MutexGetU(UMTX_PTR um, u32 timeout);
 u32      smxu_MutexPeek(MUCB_PTR mtx, SMX_PK_PAR par);
 bool     smxu_MutexRel(MUCB_PTR mtx);
+bool     smxu_MutexRelU(UMTX_PTR um);
 bool     smxu_MutexSet(MUCB_PTR mtx, SMX_ST_PAR par, u32 v1, u32 v2);
 
 bool     smxu_PipeClear(PICB_PTR pipe);
-PICB_PTR smxu_PipeCreate(void* ppb, u8 width, u16 length, const char* name, PICB_PTR* php);
+PICB_PTR smxu_PipeCreate(void* ppb, u16 width, u16 length, const char* name, PICB_PTR* php);
 void*    smxu_PipeDelete(PICB_PTR* php);
 bool     smxu_PipeGet8(PICB_PTR pipe, u8* bp);
 u32      smxu_PipeGet8M(PICB_PTR pipe, u8* bp, u32 lim);
@@ -320,6 +347,7 @@ void     smxu_PipeGetPkt(PICB_PTR pipe, void* pdst);
 bool     smxu_PipeGetPktWait(PICB_PTR pipe, void* pdst, u32 timeout);
 void     smxu_PipeGetPktWaitStop(PICB_PTR pipe, void* pdst, u32 timeout);
 u32      smxu_PipePeek(PICB_PTR pipe, SMX_PK_PAR par);
+bool     smxu_PipePeekWait(PICB_PTR pipe, void* pdst, u32 timeout);
 bool     smxu_PipePut8(PICB_PTR pipe, u8 b);
 u32      smxu_PipePut8M(PICB_PTR pipe, u8* bp, u32 lim);
 void     smxu_PipePutPkt(PICB_PTR pipe, void* psrc);
@@ -343,12 +371,14 @@ bool     smxu_PMsgSend(MCB_PTR pmsg, XCB_PTR xchg, u8 pri, void* reply);
 bool     smxu_PMsgSendB(MCB_PTR pmsg, XCB_PTR xchg, u8 pri, void* reply);
 
 bool     smxu_SemClear(SCB_PTR sem);
-SCB_PTR  smxu_SemCreate(SMX_SEM_MODE mode, u8 lim, const char* name, SCB_PTR* shp);
+SCB_PTR  smxu_SemCreate(SMX_SEM_MODE mode, u32 lim, const char* name, SCB_PTR* shp);
 bool     smxu_SemDelete(SCB_PTR* shp);
 u32      smxu_SemPeek(SCB_PTR sem, SMX_PK_PAR par);
 bool     smxu_SemSignal(SCB_PTR sem);
+bool     smxu_SemSignalN(SCB_PTR sem, u32 n);
 bool     smxu_SemTest(SCB_PTR sem, u32 timeout);
 void     smxu_SemTestStop(SCB_PTR sem, u32 timeout);
+bool     smxu_SemTestWrtr(SCB_PTR sem, u32 timeout);
 
 u32      smxu_SysPeek(SMX_PK_PAR par);
 void*    smxu_SysPseudoHandleCreate(void);
@@ -439,6 +469,12 @@ bool     mpu_TPortalSend(TPCS* pch, u8* dp, u32 rqsz, u32 tmo);
 #define smx_BlockPoolDelete(php)                smxu_BlockPoolDelete(php)
 #define smx_BlockPoolPeek(pool, par)            smxu_BlockPoolPeek(pool, par)
 
+#define smx_CondVarBroadcast(cv)                smxu_CondVarBroadcast(cv)
+#define smx_CondVarCreate(name, cvhp)           smxu_CondVarCreate(name, cvhp)
+#define smx_CondVarDelete(cvhp)                 smxu_CondVarDelete(cvhp)
+#define smx_CondVarSignal(cv)                   smxu_CondVarSignal(cv)
+#define smx_CondVarWait(cv, mtx, tmo)           smxu_CondVarWait(cv, mtx, tmo)
+
 #define smx_EventFlagsPulse(eg, pmsk)           smxu_EventFlagsPulse(eg, pmsk)
 #define smx_EventFlagsSet(eg, smsk, pcmsk)      smxu_EventFlagsSet(eg, smsk, pcmsk)
 #define smx_EventFlagsTest(eg, tmsk, mode, pcmsk, tmo)  smxu_EventFlagsTest(eg, tmsk, mode, pcmsk, tmo)
@@ -462,17 +498,36 @@ bool     mpu_TPortalSend(TPCS* pch, u8* dp, u32 rqsz, u32 tmo);
 #define smx_HeapBinScan(binno, fnum, bnum, hn)  smxu_HeapBinScan(binno, fnum, bnum, hn)
 #define smx_HeapBinSeed(num, bsz)               _Pragma("error\"smx_HeapBinSeed() not available in umode\"")
 #define smx_HeapBinSort(binno, fnum, hn)        smxu_HeapBinSort(binno, fnum, hn)
+#define smx_HeapBuddyGet(sz, hn)                _Pragma("error\"smx_HeapBuddyGet() not available in umode\"")
+#define smx_HeapBuddyInit(an, ap, hn)           _Pragma("error\"smx_HeapBuddyInit() not available in umode\"")
+#define smx_HeapBuddyPeek(par, hn)              _Pragma("error\"smx_HeapBuddyPeek() not available in umode\"")
 #define smx_HeapCalloc(num, sz, an, hn)         smxu_HeapCalloc(num, sz, an, hn)
 #define smx_HeapChunkPeek(vp, par, hn)          smxu_HeapChunkPeek(vp, par, hn)
+#define smx_HeapCompact(num, hn)                _Pragma("error\"smx_HeapCompact() not available in umode\"")
 #define smx_HeapExtend(xsz, xp)                 _Pragma("error\"smx_HeapExtend() not available in umode\"")
 #define smx_HeapFree(bp, hn)                    smxu_HeapFree(bp, hn)
+#define smx_HeapFreeM(bpp, n, hn)               _Pragma("error\"smx_HeapFreeM() not available in umode\"")
+#define smx_HeapFreeP(bp)                       _Pragma("error\"smx_HeapFreeP() not available in umode\"")
+#define smx_HeapHandleAlloc(sz, hn)             _Pragma("error\"smx_HeapHandleAlloc() not available in umode\"")
+#define smx_HeapHandleFree(hp, hn)              _Pragma("error\"smx_HeapHandleFree() not available in umode\"")
+#define smx_HeapHandleLock(hp, hn)              _Pragma("error\"smx_HeapHandleLock() not available in umode\"")
+#define smx_HeapHandleUnlock(hp, hn)            _Pragma("error\"smx_HeapHandleUnlock() not available in umode\"")
 #define smx_HeapInit(sz, hp)                    _Pragma("error\"smx_HeapInit() not available in umode\"")
 #define smx_HeapMalloc(sz, an, hn)              smxu_HeapMalloc(sz, an, hn)
+#define smx_HeapMallocM(szp, n, bpp, hn)        _Pragma("error\"smx_HeapMallocM() not available in umode\"")
+#define smx_HeapMallocP(sz, an, hint)           _Pragma("error\"smx_HeapMallocP() not available in umode\"")
+#define smx_HeapOwnerPeek(onr, par, hn)         _Pragma("error\"smx_HeapOwnerPeek() not available in umode\"")
 #define smx_HeapPeek(par, hn)                   smxu_HeapPeek(par, hn)
+#define smx_HeapPlaceSet(hint, hnl, num)        _Pragma("error\"smx_HeapPlaceSet() not available in umode\"")
+#define smx_HeapPlaceTask(task, hint)           _Pragma("error\"smx_HeapPlaceTask() not available in umode\"")
+#define smx_HeapPoolPeek(pn, par, hn)           _Pragma("error\"smx_HeapPoolPeek() not available in umode\"")
+#define smx_HeapPoolTrim(hn)                    _Pragma("error\"smx_HeapPoolTrim() not available in umode\"")
 #define smx_HeapRealloc(cbp, sz, an, hn)        smxu_HeapRealloc(cbp, sz, an, hn)
 #define smx_HeapRecover(sz, fnum)               _Pragma("error\"smx_HeapRecover() not available in umode\"")
 #define smx_HeapScan(cp, fnum, bnum)            _Pragma("error\"smx_HeapScan() not available in umode\"")
 #define smx_HeapSet(par, val)                   _Pragma("error\"smx_HeapSet() not available in umode\"")
+#define smx_HeapSitePeek(site, par, hn)         _Pragma("error\"smx_HeapSitePeek() not available in umode\"")
+#define smx_HeapSiteSet(site)                   /* site is taken from the SVC frame */
 
 #define smx_HTAdd(h, name)                      smxu_HTAdd(h, name)
 #define smx_HTDelete(h)                         smxu_HTDelete(h)
@@ -488,12 +543,16 @@ bool     mpu_TPortalSend(TPCS* pch, u8* dp, u32 rqsz, u32 tmo);
 
 #define smx_MsgBump(msg, pri)                   smxu_MsgBump(msg, pri)
 #define smx_MsgGet(pool, bpp, clrsz, mhp)       smxu_MsgGet(pool, bpp, clrsz, mhp)
+#define smx_MsgGetSz(set, sz, bpp, clrsz, mhp)  smxu_MsgGetSz(set, sz, bpp, clrsz, mhp)
 #define smx_MsgMake(bp, bs, mhp)                smxu_MsgMake(bp, bs, mhp)
 #define smx_MsgPeek(msg, par)                   smxu_MsgPeek(msg, par)
 #define smx_MsgReceive(xchg, bpp, tmo, mhp)     smxu_MsgReceive(xchg, bpp, tmo, mhp)
+#define smx_MsgReceiveAny(xl, num, bpp, tmo, mhp, xip)  smxu_MsgReceiveAny(xl, num, bpp, tmo, mhp, xip)
+#define smx_MsgReceiveM(xchg, mcba, max, tmo)   smxu_MsgReceiveM(xchg, mcba, max, tmo)
 #define smx_MsgReceiveStop(xchg, bpp, tmo, mhp) smxu_MsgReceiveStop(xchg, bpp, tmo, mhp)
 #define smx_MsgRel(msg, clrsz)                  smxu_MsgRel(msg, clrsz)
 #define smx_MsgRelAll(task)                     smxu_MsgRelAll(task)
+#define smx_MsgRelM(mcba, n, clrsz)             smxu_MsgRelM(mcba, n, clrsz)
 #define smx_MsgSend(msg, xchg, pri, reply)      smxu_MsgSend(msg, xchg, pri, reply)
 #define smx_MsgUnmake(msg, bsp)                 smxu_MsgUnmake(msg, bsp)
 
@@ -509,8 +568,10 @@ bool     mpu_TPortalSend(TPCS* pch, u8* dp, u32 rqsz, u32 tmo);
 #define smx_MutexFree(mtx)                      smxu_MutexFree(mtx)
 #define smx_MutexGet(mtx, tmo)                  smxu_MutexGet(mtx, tmo)
 #define smx_MutexGetStop(mtx, tmo)              smxu_MutexGetStop(mtx, tmo)
+#define smx_MutexGetU(um, tmo)                  smxu_MutexGetU(um, tmo)
 #define smx_MutexPeek(mtx, par)                 smxu_MutexPeek(mtx, par)
 #define smx_MutexRel(mtx)                       smxu_MutexRel(mtx)
+#define smx_MutexRelU(um)                       smxu_MutexRelU(um)
 #define smx_MutexSet(mtx, par, v1, v2)          _Pragma("error\"smx_MutexSet() not available in umode\"")
 
 #define smx_PipeClear(pipe)                     smxu_PipeClear(pipe)
@@ -522,6 +583,7 @@ bool     mpu_TPortalSend(TPCS* pch, u8* dp, u32 rqsz, u32 tmo);
 #define smx_PipeGetPktWait(pipe, pdst, tmo)     smxu_PipeGetPktWait(pipe, pdst, tmo)
 #define smx_PipeGetPktWaitStop(pipe, pdst, tmo) smxu_PipeGetPktWaitStop(pipe, pdst, tmo)
 #define smx_PipePeek(pipe, par)                 smxu_PipePeek(pipe, par)
+#define smx_PipePeekWait(pipe, pdst, tmo)       smxu_PipePeekWait(pipe, pdst, tmo)
 #define smx_PipePut8(pipe, b)                   smxu_PipePut8(pipe, b)
 #define smx_PipePut8M(pipe, bp, lim)            smxu_PipePut8M(pipe, bp, lim)
 #define smx_PipePutPkt(pipe, psrc)              smxu_PipePutPkt(pipe, psrc)
@@ -551,8 +613,10 @@ bool     mpu_TPortalSend(TPCS* pch, u8* dp, u32 rqsz, u32 tmo);
 #define smx_SemPeek(sem, par)                   smxu_SemPeek(sem, par)
 #define smx_SemSet(sem, par, v1, v2)            _Pragma("error\"smx_SemSet() not available in umode\"")
 #define smx_SemSignal(sem)                      smxu_SemSignal(sem)
+#define smx_SemSignalN(sem, n)                  smxu_SemSignalN(sem, n)
 #define smx_SemTest(sem, tmo)                   smxu_SemTest(sem, tmo)
 #define smx_SemTestStop(sem, tmo)               smxu_SemTestStop(sem, tmo)
+#define smx_SemTestWrtr(sem, tmo)               smxu_SemTestWrtr(sem, tmo)
 
 #define smx_SysPeek(par)                        smxu_SysPeek(par)
 #define smx_SysPowerDown(power_mode)            _Pragma("error\"smx_SysPowerDown() not available in umode\"")
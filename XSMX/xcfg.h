@@ -56,6 +56,21 @@
 
 #define SMX_LOCK_NEST_LIMIT      5  /* maximum nesting of task locking (smx_lockctr) */
 
+#define SMX_SIZE_EQ_WHEEL        0  /* event queue count buckets -- power of 2; 0 = differential list <7> */
+#define SMX_SIZE_SEMRD           4  /* maximum RDR/WRTR sem accesses per task; 0 = none <6> */
+#define SMX_SIZE_XSEL            8  /* maximum exchanges for smx_MsgReceiveAny(); 0 = none */
+
+#define SMX_CFG_HEAP_CACHE       0  /* enable per-task heap block cache <4> */
+#if SMX_CFG_HEAP_CACHE
+#define SMX_HEAP_CACHE_BINS      4  /* SBA bins cached, starting at bin 0 */
+#define SMX_HEAP_CACHE_NUM       4  /* maximum blocks per bin per task */
+#endif
+
+#define SMX_CFG_HEAP_PLACE       0  /* enable heap placement hints <5> */
+#if SMX_CFG_HEAP_PLACE
+#define SMX_HEAP_LARGE_SZ     4096  /* SMX_HP_NORM blocks this big use SMX_HP_LARGE */
+#endif
+
 #if SMX_CFG_PROFILE
 #define SMX_RTCB_SIZE            3  /* number of runtime counter samples in smx_rtcb[][] */
 #define SMX_RTC_FRAME          100  /* rtc frame in ticks */
@@ -77,6 +92,19 @@ enum SMX_PRIORITIES {PRI_MIN, PRI_LO, PRI_NORM, PRI_HI, PRI_MAX, PRI_SYS}; /*<3>
       to be able to see the full call stack when debugging. It serves as a half
       step to convert pmode code to umode.
    3. PRI_SYS is reserved for smx use -- do not add priority levels above it.
+   4. Small blocks of heap 0 freed by a task are kept for reuse by that task,
+      without taking the heap mutex. Costs SMX_NUM_TASKS*SMX_HEAP_CACHE_BINS*5
+      bytes of RAM. See xheap.c.
+   5. smx_HeapMallocP() picks the heap from a hint, such as SMX_HP_FAST or 
+      SMX_HP_DMA, and falls back to the next heap for the hint, if the first
+      is full. Costs SMX_HP_NUM*EH_NUM_HEAPS + SMX_NUM_TASKS bytes of RAM. 
+      See xheap.c.
+   6. Each read or write access to a RDR or WRTR semaphore is recorded in the
+      task's row of smx_semrd[]. Costs SMX_NUM_TASKS*SMX_SIZE_SEMRD*4 bytes of
+      RAM. 0 removes RDR and WRTR modes and the table. See xsem.c.
+   7. Event queue count buckets make smx_EventQueueCount() and task removal 
+      cheaper for long event queues. Costs 4 + 16*SMX_SIZE_EQ_WHEEL bytes of
+      RAM per EQCB. 0 keeps the differential list. See xeq.c.
 */
 #endif /* SMX_XCFG_H */
 
@@ -57,6 +57,9 @@ typedef enum {
    SMX_CB_TASK,      /* 0x0E */
    SMX_CB_PCBH,      /* 0x0F */
    SMX_CB_LSR,       /* 0x10 */
+   SMX_CB_CV,        /* 0x11 */ /* BQ */
+   SMX_CB_EQBKT,     /* 0x12 */ /* BQ */
+   SMX_CB_XSELQ,     /* 0x13 */ /* BQ */
 } __short_enum_attr SMX_CBTYPE; /*<2>*/
 
 /* task callback function modes */
@@ -82,6 +85,9 @@ typedef enum {
 #define  SMX_EF_AND        1           /* AND flag */
 #define  SMX_EF_ANDOR      2           /* ANDOR flag */
 
+/* umode mutex lock word flags */
+#define  SMX_UMTX_KERN     1           /* owned or locked via kernel */
+
 /* task and LSR create flags */
 typedef enum {
    SMX_FL_NONE       = 0x00000000,
@@ -173,8 +179,8 @@ typedef enum {
    SMX_SEM_EVENT,    /* event */
    SMX_SEM_THRES,    /* threshold */
    SMX_SEM_GATE,     /* gate */
-   SMX_SEM_RDR,      /* reader (future) */
-   SMX_SEM_WRTR      /* writer (future) */
+   SMX_SEM_RDR,      /* reader/writer, reader preference */
+   SMX_SEM_WRTR      /* reader/writer, writer preference */
 } __short_enum_attr SMX_SEM_MODE;
 
 /* set parameters */
@@ -188,7 +194,8 @@ typedef enum {
    SMX_ST_STK_CK,
    SMX_ST_STRT_LOCKD,
    SMX_ST_TAP,
-   SMX_ST_UMODE
+   SMX_ST_UMODE,
+   SMX_ST_UMTX
 } SMX_ST_PAR;
 
 /* task states */
@@ -228,6 +235,17 @@ typedef enum {
    SMX_XCHG_BCST     /* broadcast */
 } __short_enum_attr SMX_XMODE;
 
+/* heap placement hints for smx_HeapMallocP() */
+typedef enum {
+   SMX_HP_NORM,      /* general purpose */
+   SMX_HP_FAST,      /* fast memory (e.g. DTCM) for hot objects */
+   SMX_HP_DMA,       /* DMA-capable memory */
+   SMX_HP_LARGE,     /* large blocks (e.g. external SDRAM) */
+   SMX_HP_PERSIST,   /* blocks that are never freed */
+   SMX_HP_NUM,       /* number of hints */
+   SMX_HP_TASK = 0xFF /* current task default hint */
+} __short_enum_attr SMX_HP;
+
 /* misc */
 #define  SMX_CT   (TCB_PTR)0xFFFFFFFF  /* use for smx_ct when called from umode */
 #define  SMX_FL_MSEC       0x80000000  /* delay msec instead of ticks */
@@ -273,6 +291,7 @@ typedef enum {
 
    SMXE_INV_BCB,
    SMXE_INV_CCB,
+   SMXE_INV_CVCB,
    SMXE_INV_EGCB,
    SMXE_INV_EQCB,
    SMXE_INV_FUNC,
@@ -301,6 +320,7 @@ typedef enum {
    SMXE_OP_NOT_ALLOWED,
 
    SMXE_OUT_OF_BCBS,
+   SMXE_OUT_OF_CVCBS,
    SMXE_OUT_OF_EGCBS,
    SMXE_OUT_OF_EQCBS,
    SMXE_OUT_OF_LCBS,
@@ -480,6 +500,10 @@ typedef enum {
 #define  SMX_ID_MSG_XCHG_DELETE           0x0101105C
 #define  SMX_ID_MSG_XCHG_PEEK             0x0101205D
 #define  SMX_ID_MSG_XCHG_SET              0x0101405E
+#define  SMX_ID_MSG_RECEIVE_ANY           0x0101605F
+#define  SMX_ID_MSG_RECEIVE_M             0x010140BC
+#define  SMX_ID_MSG_REL_M                 0x010130BD
+#define  SMX_ID_MSG_GET_SZ                0x010150BE
 
 #define  SMX_ID_MUTEX_CLEAR               0x01011060
 #define  SMX_ID_MUTEX_CREATE              0x01014061
@@ -515,6 +539,7 @@ typedef enum {
 #define  SMX_ID_PIPE_PUT_PKT_WAIT_STOP    0x01014087
 #define  SMX_ID_PIPE_RESUME               0x01011088
 #define  SMX_ID_PIPE_SET                  0x01014089
+#define  SMX_ID_PIPE_PEEK_WAIT            0x0101308A
 
 #define  SMX_ID_SEM_CLEAR                 0x01011090
 #define  SMX_ID_SEM_CREATE                0x01014091
@@ -524,6 +549,8 @@ typedef enum {
 #define  SMX_ID_SEM_SIGNAL                0x01011095
 #define  SMX_ID_SEM_TEST                  0x01012096
 #define  SMX_ID_SEM_TEST_STOP             0x01012097
+#define  SMX_ID_SEM_TEST_WRTR             0x01012098
+#define  SMX_ID_SEM_SIGNAL_N              0x01012099
 
 #define  SMX_ID_SYS_PEEK                  0x0101109A
 #define  SMX_ID_SYS_POWER_DOWN            0x0100109B
@@ -555,7 +582,28 @@ typedef enum {
 #define  SMX_ID_TIMER_START               0x010150B9
 #define  SMX_ID_TIMER_START_ABS           0x010150BA
 #define  SMX_ID_TIMER_STOP                0x010120BB
-#define  SMX_ID_END                       0x010100BC
+
+
+#define  SMX_ID_CV_BROADCAST              0x010110BF
+#define  SMX_ID_CV_CREATE                 0x010120C0
+#define  SMX_ID_CV_DELETE                 0x010110C1
+#define  SMX_ID_CV_SIGNAL                 0x010110C2
+#define  SMX_ID_CV_WAIT                   0x010130C3
+#define  SMX_ID_HEAP_POOL_PEEK            0x018030C4
+#define  SMX_ID_HEAP_POOL_TRIM            0x018010C5
+#define  SMX_ID_HEAP_OWNER_PEEK           0x018030C6
+#define  SMX_ID_HEAP_SITE_PEEK            0x018030C7
+#define  SMX_ID_HEAP_COMPACT              0x018020C8
+#define  SMX_ID_HEAP_HANDLE_ALLOC         0x018020C9
+#define  SMX_ID_HEAP_HANDLE_FREE          0x018020CA
+#define  SMX_ID_HEAP_HANDLE_LOCK          0x018020CB
+#define  SMX_ID_HEAP_HANDLE_UNLOCK        0x018020CC
+#define  SMX_ID_HEAP_BUDDY_GET            0x018020CD
+#define  SMX_ID_HEAP_BUDDY_INIT           0x018030CE
+#define  SMX_ID_HEAP_BUDDY_PEEK           0x018020CF
+#define  SMX_ID_HEAP_MALLOC_M             0x018040D0
+#define  SMX_ID_HEAP_FREE_M               0x018030D1
+#define  SMX_ID_END                       0x010100D2
 
 /* Notes:
    1. Version numbers are of the form XX.X.X. Using the hex scheme above,
@@ -30,7 +30,7 @@
 
 /* internal subroutines */
 static u32  andor_test(u32 flags, u32 mask);
-static void smx_EventFlagsSearch_F(EGCB_PTR eg);
+static void smx_EventFlagsSearch_F(EGCB_PTR eg, u32 new_mask);
 static u32  smx_EventFlagsTest_F(EGCB_PTR eg, u32 test_mask, u32 mode, 
                                              u32 post_clear_mask, u32 timeout);
 static void smx_EventGroupResumeTasks_F(EGCB_PTR eg);
@@ -57,7 +57,7 @@ bool smx_EventFlagsPulse(EGCB_PTR eg, u32 pulse_mask)
       new_mask = pulse_mask & ~eg->flags; /* exclude flags already set */
       eg->flags |= new_mask;
       if (new_mask)
-         smx_EventFlagsSearch_F(eg);
+         smx_EventFlagsSearch_F(eg, new_mask);
       eg->flags &= ~new_mask; /* clear flags not already set */
       /* callback */
       if (eg->cbfun)
@@ -92,7 +92,7 @@ bool smx_EventFlagsSet(EGCB_PTR eg, u32 set_mask, u32 pre_clear_mask)
       eg->flags |= new_mask;
 
       if (new_mask)
-         smx_EventFlagsSearch_F(eg);
+         smx_EventFlagsSearch_F(eg, new_mask);
 
       /* callback */
       if (eg->cbfun)
@@ -357,9 +357,11 @@ u32 andor_test(u32 flags, u32 mask)
 *  smx_EventFlagsSearch_F()      
 *
 *  Searches eg task wait queue for matches and resumes matching tasks. Clears
-*  flags causing matches, if enabled.
+*  flags causing matches, if enabled. Returns immediately if no waiting task
+*  tests any flag in new_mask. Otherwise tests only tasks whose test masks
+*  include a new flag <1> and rebuilds eg->wmask from the tasks still waiting.
 */
-void smx_EventFlagsSearch_F(EGCB_PTR eg)
+void smx_EventFlagsSearch_F(EGCB_PTR eg, u32 new_mask)
 {
    CB_PTR   next;
    TCB_PTR  task;
@@ -369,10 +371,11 @@ void smx_EventFlagsSearch_F(EGCB_PTR eg)
    u32      tcmsk;      /* task clear mask */
    u32      sflags;     /* selected flags */
    u32      ccmsk = 0;  /* cumulative clear mask */
+   u32      wmask = 0;  /* test masks of tasks still waiting */
    bool     match = false;
 
-   /* return if no tasks waiting */
-   if (eg->fl == NULL)
+   /* return if no tasks waiting or none waiting for new flags */
+   if (eg->fl == NULL || (eg->wmask & new_mask) == 0)
       return;
 
    /* search eg wait queue for tasks that match flags */
@@ -381,6 +384,13 @@ void smx_EventFlagsSearch_F(EGCB_PTR eg)
       ttmsk = task->sv;
       tcmsk = task->sv2;
       next = task->fl;
+
+      /* skip task if no new flag is in its test mask */
+      if ((ttmsk & new_mask) == 0)
+      {
+         wmask |= ttmsk;
+         continue;
+      }
       ef_and = task->flags.ef_and;
       ef_andor = task->flags.ef_andor;
 
@@ -409,7 +419,10 @@ void smx_EventFlagsSearch_F(EGCB_PTR eg)
          smx_timeout[task->indx] = SMX_TMO_INF;
          match = true;
       }
+      else
+         wmask |= ttmsk;
    }
+   eg->wmask = wmask;
    if (match)
       smx_DO_CTTEST();  /* test for task resume */
    eg->flags &= ~ccmsk; /* clear all flags causing matches */
@@ -461,6 +474,7 @@ u32 smx_EventFlagsTest_F(EGCB_PTR eg, u32 test_mask, u32 mode, u32 post_clear_ma
             ct->sv2 = post_clear_mask;
             ct->flags.ef_and = ef_and;
             ct->flags.ef_andor = ef_andor;
+            eg->wmask |= ttmsk;
             smx_DQRQTask(ct);
             smx_NQTask((CB_PTR)eg, ct);
             smx_sched = SMX_CT_SUSP;
@@ -489,7 +503,16 @@ void smx_EventGroupResumeTasks_F(EGCB_PTR eg)
       task->sv = 0;
       smx_timeout[task->indx] = SMX_TMO_INF;
    }
+   eg->wmask = 0;
    if (task)
       smx_DO_CTTEST();
 }
 
+
+/* Notes:
+   1. A waiting task failed its test when it was enqueued, and every later
+      search either resumed it or found no match. Since clearing flags cannot
+      cause a match, only a newly set flag in its test mask can satisfy it.
+      eg->wmask may include test masks of tasks that have since timed out or
+      been resumed; this only costs an extra search, which then rebuilds it.
+*/
@@ -68,6 +68,7 @@ const char *const smx_errmsgs[] =  /* (2nd const puts into ROM) */
 
    "smx INV BCB",
    "smx INV CCB",
+   "smx INV CVCB",
    "smx INV EGCB",
    "smx INV EQCB",
    "smx INV FUNCTION",
@@ -95,6 +96,7 @@ const char *const smx_errmsgs[] =  /* (2nd const puts into ROM) */
    "smx OP NOT ALLOWED",
 
    "smx OUT OF BCBS",
+   "smx OUT OF CVCBS",
    "smx OUT OF EGCBS",
    "smx OUT OF EQCBS",
    "smx OUT OF LCBS",
@@ -31,7 +31,12 @@
 /* internal subroutines */
 static bool smx_EventQueueClear_F(EQCB_PTR eq);
 static bool smx_EventQueueCount_F(EQCB_PTR eq, u32 count, u32 timeout);
+#if SMX_SIZE_EQ_WHEEL
+static TCB_PTR smx_EventQueueFind_F(EQCB_PTR eq, bool last);
+static void smx_EventQueueSignal_F(EQCB_PTR eq, EQBKT* b);
+#else
 static void smx_EventQueueSignal_F(EQCB_PTR eq);
+#endif
 
 /*
 *  smx_EventQueueClear()   SSR
@@ -106,6 +111,9 @@ void smx_EventQueueCountStop(EQCB_PTR eq, u32 count, u32 timeout)
 EQCB_PTR smx_EventQueueCreate(const char* name, EQCB_PTR* eqhp)
 {
    EQCB_PTR  eq;
+  #if SMX_SIZE_EQ_WHEEL
+   u32       i;
+  #endif
 
    smx_SSR_ENTER2(SMX_ID_EQ_CREATE, name, eqhp);
    smx_EXIT_IF_IN_ISR(SMX_ID_EQ_CREATE, NULL);
@@ -122,6 +130,13 @@ EQCB_PTR smx_EventQueueCreate(const char* name, EQCB_PTR* eqhp)
       eq->eqhp = eqhp;
       if (name && *name)
          eq->name = name;
+     #if SMX_SIZE_EQ_WHEEL
+      for (i = 0; i < SMX_SIZE_EQ_WHEEL; i++)
+      {
+         eq->bkt[i].cbtype = SMX_CB_EQBKT;
+         eq->bkt[i].eq = eq;
+      }
+     #endif
 
       /* load event queue handle */
       if (eqhp)
@@ -172,12 +187,21 @@ u32 smx_EventQueuePeek(EQCB_PTR eq, SMX_PK_PAR par)
    {
       switch (par)
       {
+        #if SMX_SIZE_EQ_WHEEL
+         case SMX_PK_FIRST:
+            val = (u32)smx_EventQueueFind_F(eq, false);
+            break;
+         case SMX_PK_LAST:
+            val = (u32)smx_EventQueueFind_F(eq, true);
+            break;
+        #else
          case SMX_PK_FIRST:
             val = (u32)eq->fl;
             break;
          case SMX_PK_LAST:
             val = (u32)eq->bl;
             break;
+        #endif
          case SMX_PK_NAME:
             val = (u32)eq->name;
             break;
@@ -222,18 +246,31 @@ bool smx_EventQueueSet(EQCB_PTR eq, SMX_ST_PAR par, u32 v1, u32 v2)
 /*
 *  smx_EventQueueSignal()   SSR
 *
-*  If eq is a valid event queue and it is not empty, decrement the sv field of
-*  first task and if 0, call smx_EventQueueSignal_F()
+*  If eq is a valid event queue, increments its signal counter and, if the
+*  first task in the bucket for the new count has reached its target count,
+*  calls smx_EventQueueSignal_F(). For the differential list, if eq is not 
+*  empty, decrements the sv field of the first task and if 0, calls 
+*  smx_EventQueueSignal_F().
 */
 bool smx_EventQueueSignal(EQCB_PTR eq)
 {
-   bool pass;
+   bool   pass;
+  #if SMX_SIZE_EQ_WHEEL
+   EQBKT* b;
+  #endif
+
    smx_SSR_ENTER1(SMX_ID_EQ_SIGNAL, eq);
    smx_EXIT_IF_IN_ISR(SMX_ID_EQ_SIGNAL, false);
 
    /* verify that eq is valid and that current task has access permission */
    if (pass = smx_EQCBTest(eq, SMX_PRIV_LO))
    {
+     #if SMX_SIZE_EQ_WHEEL
+      eq->ctr++;
+      b = &eq->bkt[eq->ctr & (SMX_SIZE_EQ_WHEEL - 1)];
+      if (b->fl != NULL && b->fl->sv == eq->ctr)
+         smx_EventQueueSignal_F(eq, b);
+     #else
       /* if eq is not empty, decrement sv field of first task; if 0 call */
       if (eq->fl != NULL)
       {
@@ -241,6 +278,7 @@ bool smx_EventQueueSignal(EQCB_PTR eq)
          if (((TCB_PTR)eq->fl)->sv == 0)
             smx_EventQueueSignal_F(eq);
       }
+     #endif
    }
    return((bool)smx_SSRExit(pass, SMX_ID_EQ_SIGNAL));
 }
@@ -258,12 +296,29 @@ bool smx_EventQueueSignal(EQCB_PTR eq)
 */
 static bool smx_EventQueueClear_F(EQCB_PTR eq)
 {
-   bool pass;
+   bool    pass;
    TCB_PTR t = NULL;
+  #if SMX_SIZE_EQ_WHEEL
+   u32     i;
+  #endif
 
    /* verify that eq is valid and that current task has access permission */
    if (pass = smx_EQCBTest(eq, SMX_PRIV_HI))
    {
+     #if SMX_SIZE_EQ_WHEEL
+      for (i = 0; i < SMX_SIZE_EQ_WHEEL; i++)
+      {
+         while (eq->bkt[i].fl)  /* clear task queue */
+         {
+            t = smx_DQFTask((CB_PTR)&eq->bkt[i]);
+            t->sv = 0;
+            t->flags.in_eq = 0;
+            smx_NQRQTask(t);
+            smx_DO_CTTEST();
+            smx_timeout[t->indx] = SMX_TMO_INF;
+         }
+      }
+     #else
       while (eq->fl)  /* clear task queue */
       {
          t = smx_DQFTask((CB_PTR)eq);
@@ -273,6 +328,7 @@ static bool smx_EventQueueClear_F(EQCB_PTR eq)
          smx_DO_CTTEST();
          smx_timeout[t->indx] = SMX_TMO_INF;
       }
+     #endif
    }
    return pass;
 }
@@ -280,13 +336,21 @@ static bool smx_EventQueueClear_F(EQCB_PTR eq)
 /*
 *  smx_EventQueueCount_F()
 *
-*  If timeout and count are nonzero, suspend ct on eq in order by count. Load
-*  the calculated differential count into ct->sv. Always returns false.
+*  If timeout and count are nonzero, suspend ct on eq until count more signals
+*  have occurred. Loads the target signal count into ct->sv and inserts ct
+*  into the bucket for that count, in order by remaining count <1>. For the
+*  differential list, suspends ct on eq in order by count and loads the
+*  calculated differential count into ct->sv. Always returns false.
 */
 static bool smx_EventQueueCount_F(EQCB_PTR eq, u32 count, u32 timeout)
 {
    TCB_PTR  ct = smx_ct;          /* globals optimization */
+  #if SMX_SIZE_EQ_WHEEL
+   TCB_PTR  nt;                   /* next task in bucket */
+   EQBKT*   b;
+  #else
    TCB_PTR  nt = (TCB_PTR)eq->fl; /* next task eq queue */
+  #endif
    bool  pass;
 
    /* verify that eq is valid and that current task has access permission */
@@ -298,6 +362,27 @@ static bool smx_EventQueueCount_F(EQCB_PTR eq, u32 count, u32 timeout)
          if (smx_sched != SMX_CT_STOP)
             smx_sched = SMX_CT_SUSP;
 
+        #if SMX_SIZE_EQ_WHEEL
+         ct->sv = eq->ctr + count;
+         b = &eq->bkt[ct->sv & (SMX_SIZE_EQ_WHEEL - 1)];
+
+         /* find first task in b that needs more signals than ct */
+         for (nt = b->fl; nt != NULL && nt != (TCB_PTR)b; nt = (TCB_PTR)nt->fl)
+         {
+            if (nt->sv - eq->ctr > count)
+               break;
+         }
+
+         if (nt == NULL || nt == (TCB_PTR)b)
+            smx_NQTask((CB_PTR)b, ct);
+         else /* insert ct into bucket ahead of nt */
+         {
+            nt->bl->fl = (CB_PTR)ct;
+            ct->bl = nt->bl;
+            nt->bl = (CB_PTR)ct;
+            ct->fl = (CB_PTR)nt;
+         }
+        #else
          if (nt)  /* eq is not empty */
          {
             /* find position for ct */
@@ -329,6 +414,7 @@ static bool smx_EventQueueCount_F(EQCB_PTR eq, u32 count, u32 timeout)
             eq->fl = (eq->bl = ct);
          }
          ct->sv = count;
+        #endif
          ct->flags.in_eq = 1;
          smx_TimeoutSet(ct, timeout);
          pass = false;
@@ -337,13 +423,75 @@ static bool smx_EventQueueCount_F(EQCB_PTR eq, u32 count, u32 timeout)
    return pass;
 }
 
+#if SMX_SIZE_EQ_WHEEL
+/*
+*  smx_EventQueueFind_F()
+*
+*  Returns the task waiting at eq that needs the fewest more signals, or the
+*  most if last is true. For ties, returns the one that will resume first or
+*  last. Returns NULL if no task is waiting. Buckets are ordered, so only
+*  the first or last task of each bucket is checked.
+*/
+static TCB_PTR smx_EventQueueFind_F(EQCB_PTR eq, bool last)
+{
+   TCB_PTR  t;
+   TCB_PTR  ft = NULL;  /* found task */
+   u32      fn = 0;     /* remaining count of found task */
+   u32      i;
+
+   for (i = 0; i < SMX_SIZE_EQ_WHEEL; i++)
+   {
+      if (eq->bkt[i].fl == NULL)
+         continue;
+      t = (last ? eq->bkt[i].bl : eq->bkt[i].fl);
+      if (ft == NULL || (last ? (t->sv - eq->ctr > fn) : (t->sv - eq->ctr < fn)))
+      {
+         ft = t;
+         fn = t->sv - eq->ctr;
+      }
+   }
+   return ft;
+}
+
+/*
+*  smx_EventQueueSignal_F()
+*
+*  Resumes the tasks at the front of bucket b whose target counts equal
+*  eq->ctr, in the order they started waiting. The first task in b must have
+*  reached its target count. Other tasks in b wait for later rounds.
+*/
+static void smx_EventQueueSignal_F(EQCB_PTR eq, EQBKT* b)
+{
+   TCB_PTR  t = b->fl;
+
+   smx_DO_CTTEST();
+   do
+   {
+      b->fl = (TCB_PTR)t->fl;
+      t->fl->bl = (CB_PTR)b;
+      t->flags.in_eq = 0;
+      t->sv = 0;
+      t->rv = true;
+      smx_PUT_RV_IN_EXR0(t)
+      smx_NQRQTask(t);  /* q is set by macro */
+      smx_timeout[t->indx] = SMX_TMO_INF;
+      t = b->fl;
+      if (t == (TCB_PTR)b)
+      {  /* bucket is now empty */
+         b->fl = NULL;
+         break;
+      }
+   } while (t->sv == eq->ctr);
+}
+
+#else /* differential list */
 /*
 *  smx_EventQueueSignal_F()
 *
 *  Resume the first task in eq and any subsequent tasks which also have zero
-*  diff counts. Shared between smx_EventQueueSignal() and smx_KeepTimeLSR()
+*  diff counts.
 */
-void smx_EventQueueSignal_F(EQCB_PTR eq)
+static void smx_EventQueueSignal_F(EQCB_PTR eq)
 {
    TCB_PTR  t = (TCB_PTR)eq->fl;
    smx_DO_CTTEST();
@@ -364,3 +512,18 @@ void smx_EventQueueSignal_F(EQCB_PTR eq)
       }
    } while (t->sv == 0);
 }
+#endif /* SMX_SIZE_EQ_WHEEL */
+
+/* Notes:
+   1. If SMX_SIZE_EQ_WHEEL > 0, waiting tasks are kept in a hashed wheel of
+      SMX_SIZE_EQ_WHEEL buckets keyed by target signal count, instead of 
+      one list ordered by differential counts. Each bucket is ordered by remaining count, so a
+      signal only checks the front of the one bucket for its count, and
+      task removal (e.g. timeout) is O(1). A count walks only its bucket,
+      about 1/SMX_SIZE_EQ_WHEEL of the waiting tasks. Counts wrap modulo
+      2^32, so a task may wait for up to 0xFFFFFFFF signals. Tasks reaching
+      their count on the same signal resume in FIFO order, as before.
+      The wheel adds 4 + 16*SMX_SIZE_EQ_WHEEL bytes to each EQCB, so the
+      differential list is the default. See XSMX/test/beq.c for a host
+      comparison of the two.
+*/
@@ -30,6 +30,7 @@
 
 FUNV_PTR       smx_autostop;           /* autostop function address */
 PCB            smx_bcbs;               /* BCB pool */
+PCB            smx_cvcbs;              /* CVCB pool */
 LCB_PTR        smx_clsr;               /* current LSR */
 u32*           smx_cmpap;              /* current MPA pointer */
 TCB_PTR        smx_ct = (TCB_PTR)&smx_dtcb; /* current task */
@@ -97,6 +98,9 @@ void*          smx_scanstack_end = &smx_scanstack; /* stack scan pool end pointe
 #endif
 PCB            smx_scbs;               /* SCB pool */
 SMX_SCHED      smx_sched;              /* scheduler flags */
+#if SMX_SIZE_SEMRD
+SCB_PTR        smx_semrd[SMX_NUM_TASKS][SMX_SIZE_SEMRD]; /* RDR/WRTR sems accessed by each task */
+#endif
 u32*           smx_spmin;              /* start of stack pool */
 u32            smx_srnest;             /* service routine nesting level */
 #if SMX_CFG_SSMX
@@ -118,7 +122,18 @@ u32            smx_tmo_indx;                    /* index of minimum timeout */
 u32            smx_tmo_min = SMX_TMO_INF;       /* minimum waiting timeout value */
 CB             smx_tqcb;                        /* timer queue control block */
 CB_PTR         smx_tq = &smx_tqcb;              /* timer queue */
+MUCB_PTR       smx_umtxl;                       /* mutexes bound to umode lock words */
 PCB            smx_xcbs;                        /* XCB pool */
+#if SMX_SIZE_XSEL
+XSEL           smx_xsel[SMX_NUM_TASKS];         /* exchange select records */
+CB             smx_xselqcb;                     /* exchange select queue control block */
+CB_PTR         smx_xselq = &smx_xselqcb;        /* exchange select queue */
+#endif
+#if SMX_CFG_SSMX
+#pragma default_variable_attributes = @ ".ucom.bss"
+TCB_PTR        smxu_ct;                         /* umode copy of smx_ct <2> */
+#pragma default_variable_attributes =
+#endif
 
 u32            smx_Version = SMX_VERSION;       /* smx version number (consulted by smxAware) */
 
@@ -134,4 +149,7 @@ LCB_PTR        smx_TimeoutLSR;
 /* Notes:
    1. smx_dtcb provides a place to write smx_ct->err and smx_ct->susploc
       for C++ initializers that call SSRs, before smx sets smx_ct to a task.
+   2. smxu_ct lets umode code identify the current task without an SVC, for
+      the umode mutex fast path. It is in ucom, so a utask can overwrite it.
+      The kernel does not trust it; see smx_MutexUmtxAdopt() in xmtx.c.
 */
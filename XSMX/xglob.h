@@ -31,6 +31,7 @@
 
 extern FUNV_PTR   smx_autostop;     /* autostop function address */
 extern PCB        smx_bcbs;         /* BCB pool */
+extern PCB        smx_cvcbs;        /* CVCB pool */
 extern LCB_PTR    smx_clsr;         /* current LSR */
 extern u32*       smx_cmpap;        /* current MPA pointer */
 #if SMX_CFG_PROFILE
@@ -114,6 +115,9 @@ extern void*      smx_scanstack_end;   /* stack scan pool end pointer */
 #endif
 extern PCB        smx_scbs;         /* SCB pool */
 extern SMX_SCHED  smx_sched;        /* scheduler flags */
+#if SMX_SIZE_SEMRD
+extern SCB_PTR    smx_semrd[SMX_NUM_TASKS][SMX_SIZE_SEMRD]; /* RDR/WRTR sems accessed by each task */
+#endif
 extern u32*       smx_spmin;        /* start of stack pool */
 extern u32        smx_srnest;       /* service routine nesting level */
 #if SMX_CFG_SSMX
@@ -135,8 +139,17 @@ extern u32        smx_tmo_indx;     /* index of minimum timeout */
 extern u32        smx_tmo_min;      /* minimum waiting timeout value */
 extern CB         smx_tqcb;         /* timer queue control block */
 extern CB_PTR     smx_tq;           /* timer queue */
+extern MUCB_PTR   smx_umtxl;        /* mutexes bound to umode lock words */
 extern u32        smx_Version;      /* smx version number (consulted by smxAware) */
 extern PCB        smx_xcbs;         /* XCB pool */
+#if SMX_SIZE_XSEL
+extern XSEL       smx_xsel[SMX_NUM_TASKS]; /* exchange select records */
+extern CB         smx_xselqcb;      /* exchange select queue control block */
+extern CB_PTR     smx_xselq;        /* exchange select queue */
+#endif
+#if SMX_CFG_SSMX
+extern TCB_PTR    smxu_ct;          /* umode copy of smx_ct */
+#endif
 
 /* system objects */
 extern TCB_PTR    smx_Idle;         /* idle task */
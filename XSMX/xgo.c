@@ -85,6 +85,13 @@ void smx_Go(void)
    smx_tq->name = "smx_tq";
    smx_HT_ADD(smx_tq, "smx_tq");
 
+  #if SMX_SIZE_XSEL
+   /* initialize exchange select queue */
+   smx_xselq->cbtype = SMX_CB_XSELQ;
+   smx_xselq->name = "smx_xselq";
+   smx_HT_ADD(smx_xselq, "smx_xselq");
+  #endif
+
    /* initialize smx_timeout array */
    for (u32 i = 0; i < SMX_NUM_TASKS; i++)
       smx_timeout[i] = SMX_TMO_INF;
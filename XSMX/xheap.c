@@ -29,10 +29,18 @@
 #include "xsmx.h"
 
 /* internal subroutines */
+#if SMX_CFG_HEAP_CACHE
+static bool  smx_HeapCacheFlush_F(TCB_PTR task);
+static void* smx_HeapCacheGet(u32 sz, u32 an, u32 hn);
+static bool  smx_HeapCachePut(void* bp, u32 hn);
+#endif
 static bool smx_HeapEnter(u32 p1, u32 hn, u32 id);
 static bool smx_HeapEnter(u32 p1, u32 p2, u32 hn, u32 id);
 static bool smx_HeapEnter(u32 p1, u32 p2, u32 p3, u32 hn, u32 id);
 static void smx_HeapExit(u32 rv, u32 hn, u32 id);
+#if EH_OSTATS
+static u32  smx_HeapSiteGet(u32 ra);
+#endif
 
 /* internal variables */
 bool        smx_hmng;   /* run HeapManager */
@@ -45,6 +53,32 @@ u32         smx_ts1;    /* time start 1 */
 
 MUCB_PTR  smx_hmtx[EH_NUM_HEAPS];  /* heap mutex pointer array */
 
+#if EH_OSTATS
+u32         smx_hsite;  /* heap call site for eh_site() <4> */
+static u32  smx_hsitep[SMX_NUM_TASKS];  /* sites set by smx_HeapSiteSet() */
+
+/* call site of the current function; must be used before any call */
+#if defined(__IAR_SYSTEMS_ICC__)
+#define SMX_HEAP_SITE()  smx_HeapSiteGet(__get_LR())
+#else
+#define SMX_HEAP_SITE()  smx_HeapSiteGet((u32)__builtin_return_address(0))
+#endif
+#endif
+
+#if SMX_CFG_HEAP_CACHE
+/* per-task heap 0 block cache <3> */
+static void* smx_hcache[SMX_NUM_TASKS][SMX_HEAP_CACHE_BINS]; /* block lists */
+static u8    smx_hcnum[SMX_NUM_TASKS][SMX_HEAP_CACHE_BINS];  /* blocks in lists */
+#endif
+
+#if SMX_CFG_HEAP_PLACE
+/* heap placement lists, ending with 0xFF, and task default hints <5> */
+static u8    smx_hpl[SMX_HP_NUM][EH_NUM_HEAPS + 1] =
+                              {{0, 0xFF}, {0, 0xFF}, {0, 0xFF}, {0, 0xFF}, {0, 0xFF}};
+static u8    smx_htpl[SMX_NUM_TASKS];
+u32          smx_hpfb[EH_NUM_HEAPS];  /* placement fallbacks into heap hn */
+#endif
+
 /* eheap error to smx error mapping table */
 const u32 xerrno[] = {SMXE_OK, 
                       SMXE_HEAP_ALRDY_INIT, 
@@ -140,6 +174,61 @@ bool smx_HeapBinSort(u32 binno, u32 fnum, u32 hn)
    return epass;
 }
 
+#if EH_BUDDY
+/*
+*  smx_HeapBuddyGet()   Mutex-Protected Service
+*
+*  Gets a block of the smallest power of 2 >= sz from the buddy arena of heap
+*  hn, aligned on its size. Free it with smx_HeapFree().
+*/
+void* smx_HeapBuddyGet(u32 sz, u32 hn)
+{
+   void* bp;
+   if (!smx_HeapEnter(sz, hn, SMX_ID_HEAP_BUDDY_GET))
+      return NULL;
+   bp = eh_BuddyGet(sz, hn);
+   if (eh_hvp[hn]->errno != 0 && eh_hvp[hn]->mode.fl.em_en)
+      smx_ERROR((SMX_ERRNO)xerrno[eh_hvp[hn]->errno], 0);
+   smx_HeapExit((u32)bp, hn, SMX_ID_HEAP_BUDDY_GET);
+   return bp;
+}
+
+/*
+*  smx_HeapBuddyInit()   Mutex-Protected Service
+*
+*  Sets up a buddy arena of 2^an bytes for heap hn, at ap or, if ap is NULL,
+*  allocated from heap hn. Normally called right after smx_HeapInit().
+*/
+bool smx_HeapBuddyInit(u32 an, u8* ap, u32 hn)
+{
+   bool pass;
+   if (!smx_HeapEnter(an, (u32)ap, hn, SMX_ID_HEAP_BUDDY_INIT))
+      return false;
+   pass = eh_BuddyInit(an, ap, hn);
+   if (eh_hvp[hn]->errno != 0)
+      smx_ERROR((SMX_ERRNO)xerrno[eh_hvp[hn]->errno], 0);
+   smx_HeapExit(pass, hn, SMX_ID_HEAP_BUDDY_INIT);
+   return pass;
+}
+
+/*
+*  smx_HeapBuddyPeek()   Mutex-Protected Service
+*
+*  Returns information concerning the buddy arena of heap hn.
+*/
+u32 smx_HeapBuddyPeek(EH_PK_PAR par, u32 hn)
+{
+   u32 val;
+   if (!smx_HeapEnter(par, hn, SMX_ID_HEAP_BUDDY_PEEK))
+      return 0;
+   val = eh_BuddyPeek(par, hn);
+   if (eh_hvp[hn]->errno != 0)
+      smx_ERROR((SMX_ERRNO)xerrno[eh_hvp[hn]->errno], 0);
+   smx_HeapExit(val, hn, SMX_ID_HEAP_BUDDY_PEEK);
+   return val;
+}
+#endif
+
 /*
 *  smx_HeapCalloc()   Mutex-Protected Service
 *
@@ -149,9 +238,18 @@ bool smx_HeapBinSort(u32 binno, u32 fnum, u32 hn)
 void* smx_HeapCalloc(u32 num, u32 sz, u32 an, u32 hn)
 {
    void* bp;  
+  #if EH_OSTATS
+   u32   site = SMX_HEAP_SITE();
+  #endif
    if (!smx_HeapEnter(num, sz, an, hn, SMX_ID_HEAP_CALLOC))
       return NULL;
+  #if EH_OSTATS
+   smx_hsite = site;
+  #endif
    bp = eh_Calloc(num, sz, an, hn);
+  #if EH_TRACE
+   eh_Trace(EH_TR_CALLOC, bp, NULL, num*sz, an, hn);
+  #endif
    smx_HeapExit((u32)bp, hn, SMX_ID_HEAP_CALLOC);
    return bp;
 }
@@ -174,6 +272,27 @@ u32 smx_HeapChunkPeek(void* vp, EH_PK_PAR par, u32 hn)
    return val;
 }
 
+#if EH_HANDLES
+/*
+*  smx_HeapCompact()   Mutex-Protected Service
+*
+*  Slides unlocked handle blocks down over free chunks, examining up to num 
+*  chunks. Returns true at the end of the heap. Normally called from a heap 
+*  manager during idle time.
+*/
+bool smx_HeapCompact(u32 num, u32 hn)
+{
+   bool pass;
+   if (!smx_HeapEnter(num, hn, SMX_ID_HEAP_COMPACT))
+      return false;
+   pass = eh_Compact(num, hn);
+   if (eh_hvp[hn]->errno != 0)
+      smx_ERROR((SMX_ERRNO)xerrno[eh_hvp[hn]->errno], 0);
+   smx_HeapExit(pass, hn, SMX_ID_HEAP_COMPACT);
+   return pass;
+}
+#endif
+
 /*
 *  smx_HeapExtend()   Mutex-Protected Service
 *
@@ -200,15 +319,158 @@ bool smx_HeapExtend(u32 xsz, u8* xp, u32 hn)
 bool smx_HeapFree(void* bp, u32 hn) 
 {
    bool pass;
+  #if EH_BP && USE_LDREX && !EH_OSTATS
+   if (hn < eh_hvpn && eh_PoolRel(bp, hn))
+   {
+     #if EH_TRACE
+      eh_Trace(EH_TR_FREE, bp, NULL, 0, 0, hn);
+     #endif
+      return true;
+   }
+  #endif
+  #if SMX_CFG_HEAP_CACHE
+   if (smx_HeapCachePut(bp, hn))
+   {
+     #if EH_TRACE
+      eh_Trace(EH_TR_FREE, bp, NULL, 0, 0, hn);
+     #endif
+      return true;
+   }
+  #endif
    if (!smx_HeapEnter((u32)bp, hn, SMX_ID_HEAP_FREE))
       return false;
    pass = eh_Free(bp, hn);
    if (eh_hvp[hn]->errno != 0 && eh_hvp[hn]->mode.fl.em_en)
       smx_ERROR((SMX_ERRNO)xerrno[eh_hvp[hn]->errno], 0);
+  #if EH_TRACE
+   if (pass)
+      eh_Trace(EH_TR_FREE, bp, NULL, 0, 0, hn);
+  #endif
    smx_HeapExit(pass, hn, SMX_ID_HEAP_FREE);
    return pass;
 }
 
+/*
+*  smx_HeapFreeM()   Mutex-Protected Service
+*
+*  Frees n blocks, listed in bpp[], with one heap access. Adjacent blocks are
+*  merged and freed as one chunk. Clears bpp[]. <6>
+*/
+bool smx_HeapFreeM(void** bpp, u32 n, u32 hn)
+{
+   bool pass;
+  #if EH_TRACE
+   u32  i;
+  #endif
+   if (!smx_HeapEnter((u32)bpp, n, hn, SMX_ID_HEAP_FREE_M))
+      return false;
+  #if EH_TRACE
+   /* trace before eh_FreeM() clears bpp[] */
+   for (i = 0; bpp != NULL && i < n; i++)
+      eh_Trace(EH_TR_FREE, bpp[i], NULL, 0, 0, hn);
+  #endif
+   pass = eh_FreeM(bpp, n, hn);
+   if (eh_hvp[hn]->errno != 0 && eh_hvp[hn]->mode.fl.em_en)
+      smx_ERROR((SMX_ERRNO)xerrno[eh_hvp[hn]->errno], 0);
+   smx_HeapExit(pass, hn, SMX_ID_HEAP_FREE_M);
+   return pass;
+}
+
+#if EH_HANDLES
+/*
+*  smx_HeapHandleAlloc()   Mutex-Protected Service
+*
+*  Allocates a movable block of sz bytes and returns its handle. Use 
+*  smx_HeapHandleLock() to get the block pointer.
+*/
+EHH_PTR smx_HeapHandleAlloc(u32 sz, u32 hn)
+{
+   EHH_PTR hp;
+   if (!smx_HeapEnter(sz, hn, SMX_ID_HEAP_HANDLE_ALLOC))
+      return NULL;
+   hp = eh_HandleAlloc(sz, hn);
+   if (eh_hvp[hn]->errno != 0 && eh_hvp[hn]->mode.fl.em_en)
+      smx_ERROR((SMX_ERRNO)xerrno[eh_hvp[hn]->errno], 0);
+   smx_HeapExit((u32)hp, hn, SMX_ID_HEAP_HANDLE_ALLOC);
+   return hp;
+}
+
+/*
+*  smx_HeapHandleFree()   Mutex-Protected Service
+*
+*  Frees an unlocked handle block and its handle.
+*/
+bool smx_HeapHandleFree(EHH_PTR hp, u32 hn)
+{
+   bool pass;
+   if (!smx_HeapEnter((u32)hp, hn, SMX_ID_HEAP_HANDLE_FREE))
+      return false;
+   pass = eh_HandleFree(hp, hn);
+   if (eh_hvp[hn]->errno != 0 && eh_hvp[hn]->mode.fl.em_en)
+      smx_ERROR((SMX_ERRNO)xerrno[eh_hvp[hn]->errno], 0);
+   smx_HeapExit(pass, hn, SMX_ID_HEAP_HANDLE_FREE);
+   return pass;
+}
+
+/*
+*  smx_HeapHandleLock()   Mutex-Protected Service
+*
+*  Locks a handle block in place and returns its block pointer, which is 
+*  valid until the matching smx_HeapHandleUnlock().
+*/
+void* smx_HeapHandleLock(EHH_PTR hp, u32 hn)
+{
+   void* bp;
+   if (!smx_HeapEnter((u32)hp, hn, SMX_ID_HEAP_HANDLE_LOCK))
+      return NULL;
+   bp = eh_HandleLock(hp, hn);
+   if (eh_hvp[hn]->errno != 0 && eh_hvp[hn]->mode.fl.em_en)
+      smx_ERROR((SMX_ERRNO)xerrno[eh_hvp[hn]->errno], 0);
+   smx_HeapExit((u32)bp, hn, SMX_ID_HEAP_HANDLE_LOCK);
+   return bp;
+}
+
+/*
+*  smx_HeapHandleUnlock()   Mutex-Protected Service
+*
+*  Undoes one smx_HeapHandleLock(). The block may be moved after its last 
+*  unlock.
+*/
+bool smx_HeapHandleUnlock(EHH_PTR hp, u32 hn)
+{
+   bool pass;
+   if (!smx_HeapEnter((u32)hp, hn, SMX_ID_HEAP_HANDLE_UNLOCK))
+      return false;
+   pass = eh_HandleUnlock(hp, hn);
+   if (eh_hvp[hn]->errno != 0 && eh_hvp[hn]->mode.fl.em_en)
+      smx_ERROR((SMX_ERRNO)xerrno[eh_hvp[hn]->errno], 0);
+   smx_HeapExit(pass, hn, SMX_ID_HEAP_HANDLE_UNLOCK);
+   return pass;
+}
+#endif
+
+#if SMX_CFG_HEAP_PLACE
+/*
+*  smx_HeapFreeP()   Mutex-Protected Service
+*
+*  Frees a block previously allocated by smx_HeapMallocP(), from whichever 
+*  heap it is in.
+*/
+bool smx_HeapFreeP(void* bp)
+{
+   u32 hn;
+   if (bp == NULL)
+      return true;
+   for (hn = 0; hn < eh_hvpn; hn++)
+   {
+      if (bp > (void*)eh_hvp[hn]->pi && bp < (void*)eh_hvp[hn]->px)
+         return smx_HeapFree(bp, hn);
+   }
+   smx_ERROR(SMXE_WRONG_HEAP, 0);
+   return false;
+}
+#endif
+
 /*
 *  smx_HeapInit()   Function
 *
@@ -271,17 +533,160 @@ u32 smx_HeapInit(u32 sz, u32 dcsz, u8* hp, EHV_PTR vp, u32* bszap, HBCB* binp,
 void* smx_HeapMalloc(u32 sz, u32 an, u32 hn)
 {
    void* bp;
+  #if EH_OSTATS
+   u32   site = SMX_HEAP_SITE();
+  #endif
+  #if SMX_CFG_HEAP_CACHE
+   if ((bp = smx_HeapCacheGet(sz, an, hn)) != NULL)
+   {
+     #if EH_TRACE
+      eh_Trace(EH_TR_MALLOC, bp, NULL, sz, an, hn);
+     #endif
+      return bp;
+   }
+  #endif
+  #if EH_BP && USE_LDREX && !EH_OSTATS
+   if (hn < eh_hvpn && (bp = eh_PoolGet(sz, an, hn)) != NULL)
+   {
+     #if EH_TRACE
+      eh_Trace(EH_TR_MALLOC, bp, NULL, sz, an, hn);
+     #endif
+      return bp;
+   }
+  #endif
    if (!smx_HeapEnter(sz, an, hn, SMX_ID_HEAP_MALLOC))
       return NULL;
+  #if EH_OSTATS
+   smx_hsite = site;
+  #endif
    bp = eh_Malloc(sz, an, hn);
+  #if SMX_CFG_HEAP_CACHE
+   /* if heap 0 is out of space, free cached blocks and try again */
+   if (bp == NULL && hn == 0 && smx_HeapCacheFlush_F(smx_ct))
+      bp = eh_Malloc(sz, an, hn);
+  #endif
    if (eh_hvp[hn]->errno != 0 && eh_hvp[hn]->mode.fl.em_en)
    {
       smx_ERROR((SMX_ERRNO)xerrno[eh_hvp[hn]->errno], 0);
    }
+  #if EH_TRACE
+   eh_Trace(EH_TR_MALLOC, bp, NULL, sz, an, hn);
+  #endif
    smx_HeapExit((u32)bp, hn, SMX_ID_HEAP_MALLOC);
    return bp;
 }
 
+/*
+*  smx_HeapMallocM()   Mutex-Protected Service
+*
+*  Allocates n 8-byte aligned blocks of sizes szp[0] thru szp[n-1] from heap 
+*  hn, with one heap access, and loads their pointers into bpp[]. The blocks
+*  are contiguous, if possible. Either all blocks are allocated or none are.
+*  <6>
+*/
+bool smx_HeapMallocM(const u32* szp, u32 n, void** bpp, u32 hn)
+{
+   bool pass;
+  #if EH_TRACE
+   u32  i;
+  #endif
+  #if EH_OSTATS
+   u32  site = SMX_HEAP_SITE();
+  #endif
+   if (!smx_HeapEnter((u32)szp, n, (u32)bpp, hn, SMX_ID_HEAP_MALLOC_M))
+      return false;
+  #if EH_OSTATS
+   smx_hsite = site;
+  #endif
+   pass = eh_MallocM(szp, n, bpp, hn);
+  #if SMX_CFG_HEAP_CACHE
+   /* if heap 0 is out of space, free cached blocks and try again */
+   if (!pass && hn == 0 && eh_hvp[hn]->errno == EH_INSUFF_HEAP 
+                                          && smx_HeapCacheFlush_F(smx_ct))
+      pass = eh_MallocM(szp, n, bpp, hn);
+  #endif
+   if (eh_hvp[hn]->errno != 0 && eh_hvp[hn]->mode.fl.em_en)
+      smx_ERROR((SMX_ERRNO)xerrno[eh_hvp[hn]->errno], 0);
+  #if EH_TRACE
+   for (i = 0; pass && i < n; i++)
+      eh_Trace(EH_TR_MALLOC, bpp[i], NULL, szp[i], 0, hn);
+  #endif
+   smx_HeapExit(pass, hn, SMX_ID_HEAP_MALLOC_M);
+   return pass;
+}
+
+#if SMX_CFG_HEAP_PLACE
+/*
+*  smx_HeapMallocP()   Mutex-Protected Service
+*
+*  Allocates a block of sz bytes, aligned on 2^an, from the first heap in the
+*  placement list for hint that has enough space. SMX_HP_TASK selects the 
+*  current task default hint. <5>
+*/
+void* smx_HeapMallocP(u32 sz, u32 an, u32 hint)
+{
+   void* bp = NULL;
+   u32   hn;
+   u8*   lp;   /* heap list pointer */
+  #if EH_OSTATS
+   u32   site = SMX_HEAP_SITE();
+  #endif
+
+   if (hint == SMX_HP_TASK)
+      hint = (smx_clsr != NULL ? SMX_HP_NORM : smx_htpl[smx_ct->indx]);
+   if (hint >= SMX_HP_NUM)
+   {
+      smx_ERROR(SMXE_INV_PAR, 0);
+      return NULL;
+   }
+   if (hint == SMX_HP_NORM && sz >= SMX_HEAP_LARGE_SZ)
+      hint = SMX_HP_LARGE;
+
+   /* try each heap in the list until one has space */
+   for (lp = smx_hpl[hint]; bp == NULL && *lp < eh_hvpn; lp++)
+   {
+      hn = *lp;
+      if (!smx_HeapEnter(sz, an, hn, SMX_ID_HEAP_MALLOC))
+         continue;
+     #if EH_OSTATS
+      smx_hsite = site;
+     #endif
+      if ((bp = eh_Malloc(sz, an, hn)) != NULL)
+      {
+         if (lp != smx_hpl[hint])
+            smx_hpfb[hn]++;
+        #if EH_TRACE
+         eh_Trace(EH_TR_MALLOC, bp, NULL, sz, an, hn);
+        #endif
+      }
+      smx_HeapExit((u32)bp, hn, SMX_ID_HEAP_MALLOC);
+   }
+   if (bp == NULL)
+      smx_ERROR(SMXE_INSUFF_HEAP, 0);
+   return bp;
+}
+#endif
+
+#if EH_OSTATS
+/*
+*  smx_HeapOwnerPeek()   Mutex-Protected Service
+*
+*  Returns the number of chunks, bytes, or maximum bytes held in the heap by 
+*  owner onr, which is a task or LSR handle. Debug chunks only. <4>
+*/
+u32 smx_HeapOwnerPeek(u32 onr, EH_PK_PAR par, u32 hn)
+{
+   u32 val;
+   if (!smx_HeapEnter(onr, par, hn, SMX_ID_HEAP_OWNER_PEEK))
+      return 0;
+   val = eh_OwnerPeek(onr, par, hn);
+   if (eh_hvp[hn]->errno != 0)
+      smx_ERROR((SMX_ERRNO)xerrno[eh_hvp[hn]->errno], 0);
+   smx_HeapExit(val, hn, SMX_ID_HEAP_OWNER_PEEK);
+   return val;
+}
+#endif
+
 /*
 *  smx_HeapPeek()   Mutex-Protected Service
 *
@@ -299,6 +704,90 @@ u32 smx_HeapPeek(EH_PK_PAR par, u32 hn)
    return val;
 }
 
+#if SMX_CFG_HEAP_PLACE
+/*
+*  smx_HeapPlaceSet()   Function
+*
+*  Loads the placement list for hint with num heap numbers, in the order 
+*  they are to be tried. Normally called during initialization, after the 
+*  heaps have been initialized. Not permitted in umode.
+*/
+bool smx_HeapPlaceSet(SMX_HP hint, const u8* hnl, u32 num)
+{
+   u32 i;
+   if (hint >= SMX_HP_NUM || hnl == NULL || num == 0 || num > EH_NUM_HEAPS)
+   {
+      smx_ERROR(SMXE_INV_PAR, 0);
+      return false;
+   }
+   for (i = 0; i < num; i++)
+   {
+      if (hnl[i] >= eh_hvpn)
+      {
+         smx_ERROR(SMXE_INV_PAR, 0);
+         return false;
+      }
+   }
+   memcpy(smx_hpl[hint], hnl, num);
+   smx_hpl[hint][num] = 0xFF;
+   return true;
+}
+
+/*
+*  smx_HeapPlaceTask()   Function
+*
+*  Sets the default placement hint of task, which smx_HeapMallocP() uses for
+*  SMX_HP_TASK. Not permitted in umode.
+*/
+bool smx_HeapPlaceTask(TCB_PTR task, SMX_HP hint)
+{
+   if (hint >= SMX_HP_NUM || !smx_TCBTest(task, SMX_PRIV_HI))
+   {
+      smx_ERROR(SMXE_INV_PAR, 0);
+      return false;
+   }
+   smx_htpl[task->indx] = (u8)hint;
+   return true;
+}
+#endif
+
+#if EH_BP
+/*
+*  smx_HeapPoolPeek()   Mutex-Protected Service
+*
+*  Returns information concerning block pool pn of the heap.
+*/
+u32 smx_HeapPoolPeek(u32 pn, EH_PK_PAR par, u32 hn)
+{
+   u32 val;
+   if (!smx_HeapEnter(pn, par, hn, SMX_ID_HEAP_POOL_PEEK))
+      return 0;
+   val = eh_PoolPeek(pn, par, hn);
+   if (eh_hvp[hn]->errno != 0)
+      smx_ERROR((SMX_ERRNO)xerrno[eh_hvp[hn]->errno], 0);
+   smx_HeapExit(val, hn, SMX_ID_HEAP_POOL_PEEK);
+   return val;
+}
+
+/*
+*  smx_HeapPoolTrim()   Mutex-Protected Service
+*
+*  Frees block pool slabs with no blocks in use back to the heap, except for 
+*  one per pool. Normally called from a heap manager task.
+*/
+bool smx_HeapPoolTrim(u32 hn)
+{
+   bool pass;
+   if (!smx_HeapEnter(hn, hn, SMX_ID_HEAP_POOL_TRIM))
+      return false;
+   pass = eh_PoolTrim(hn);
+   if (eh_hvp[hn]->errno != 0)
+      smx_ERROR((SMX_ERRNO)xerrno[eh_hvp[hn]->errno], 0);
+   smx_HeapExit(pass, hn, SMX_ID_HEAP_POOL_TRIM);
+   return pass;
+}
+#endif
+
 /*
 *  smx_HeapRealloc()   Mutex-Protected Service
 *
@@ -308,11 +797,20 @@ u32 smx_HeapPeek(EH_PK_PAR par, u32 hn)
 void* smx_HeapRealloc(void* cbp, u32 sz, u32 an, u32 hn)
 {
    void* nbp;
+  #if EH_OSTATS
+   u32   site = SMX_HEAP_SITE();
+  #endif
    if (!smx_HeapEnter((u32)cbp, sz, an, hn, SMX_ID_HEAP_REALLOC))
       return NULL;
+  #if EH_OSTATS
+   smx_hsite = site;
+  #endif
    nbp = eh_Realloc(cbp, sz, an, hn);
    if (eh_hvp[hn]->errno != 0 && eh_hvp[hn]->mode.fl.em_en)
       smx_ERROR((SMX_ERRNO)xerrno[eh_hvp[hn]->errno], 0);
+  #if EH_TRACE
+   eh_Trace(EH_TR_REALLOC, nbp, cbp, sz, an, hn);
+  #endif
    smx_HeapExit((u32)nbp, hn, SMX_ID_HEAP_REALLOC);
    return nbp;
 }
@@ -375,6 +873,40 @@ bool smx_HeapSet(EH_ST_PAR par, u32 val, u32 hn)
    return pass;
 }
 
+#if EH_OSTATS
+/*
+*  smx_HeapSitePeek()   Mutex-Protected Service
+*
+*  Returns the number of chunks, bytes, or maximum bytes held in the heap by 
+*  call site site, which is the return address of a heap allocation call or 
+*  of a wrapper call, such as malloc(). Debug chunks and blocks only. <4>
+*/
+u32 smx_HeapSitePeek(u32 site, EH_PK_PAR par, u32 hn)
+{
+   u32 val;
+   if (!smx_HeapEnter(site, par, hn, SMX_ID_HEAP_SITE_PEEK))
+      return 0;
+   val = eh_SitePeek(site, par, hn);
+   if (eh_hvp[hn]->errno != 0)
+      smx_ERROR((SMX_ERRNO)xerrno[eh_hvp[hn]->errno], 0);
+   smx_HeapExit(val, hn, SMX_ID_HEAP_SITE_PEEK);
+   return val;
+}
+
+/*
+*  smx_HeapSiteSet()   Function
+*
+*  Sets the call site for the next heap allocation by the current task. Used 
+*  by malloc(), new, and other wrappers to pass their caller as the site, 
+*  via smx_HEAP_SITE_SET(). Ignored for LSRs. <4>
+*/
+void smx_HeapSiteSet(u32 site)
+{
+   if (smx_clsr == NULL)
+      smx_hsitep[smx_ct->indx] = site & ~1;
+}
+#endif
+
 /*===========================================================================*
                              CALLBACK FUNCTIONS
                             Do Not Call Directly
@@ -390,6 +922,13 @@ u32 eh_time(void)
    return smx_etime;
 }
 
+#if EH_OSTATS
+u32 eh_site(void)
+{
+   return smx_hsite;
+}
+#endif
+
 /*===========================================================================*
 *                         HEAP TRANSLATION ROUTINES                          *
 *===========================================================================*/
@@ -408,6 +947,7 @@ void *__data_calloc(size_t nitems, size_t size)
 void *calloc(size_t nitems, size_t size)
 #endif
 {
+   smx_HEAP_SITE_SET();
    return(smx_HeapCalloc(nitems, size));
 }
 
@@ -417,6 +957,7 @@ void *__data_malloc(size_t size)
 void *malloc(size_t size)
 #endif
 {
+   smx_HEAP_SITE_SET();
    return(smx_HeapMalloc(size));
 }
 
@@ -426,6 +967,7 @@ void *__data_realloc(void *bp, size_t size)
 void *realloc(void *bp, size_t size)
 #endif
 {
+   smx_HEAP_SITE_SET();
    return(smx_HeapRealloc(bp, size));
 }
 
@@ -483,11 +1025,13 @@ void * newx(size_t s)
 
 void * operator new[](size_t s)
 {
+   smx_HEAP_SITE_SET();
    return newx(s);
 }
 
 void * operator new(size_t s)
 {
+   smx_HEAP_SITE_SET();
    return newx(s);
 }
 
@@ -502,6 +1046,27 @@ void operator delete(void * b)
 *                            Do Not Call Directly                            *
 *===========================================================================*/
 
+#if EH_OSTATS
+/* Returns the heap call site for a service whose return address is ra: the 
+   site set by a wrapper, else the caller of the SVC shim for a umode call, 
+   else ra. A set site is used once. <4> */
+static u32 smx_HeapSiteGet(u32 ra)
+{
+   u32 site;
+   if (smx_clsr == NULL && (site = smx_hsitep[smx_ct->indx]) != 0)
+   {
+      smx_hsitep[smx_ct->indx] = 0;
+      return site;
+   }
+  #if SMX_CFG_SSMX
+   /* called by smx_SVC_Handler: LR in the exception frame is the shim caller */
+   if ((__get_IPSR() & 0x1FF) == 11)
+      ra = ((u32*)__get_PSP())[5];
+  #endif
+   return ra & ~1;
+}
+#endif
+
 static bool smx_HeapEnter(u32 p1, u32 hn, u32 id)
 {
    MUCB_PTR hmtx;
@@ -602,10 +1167,175 @@ static void smx_HeapExit(u32 rv, u32 hn, u32 id)
    #endif
 }
 
+#if SMX_CFG_HEAP_CACHE
+/*
+*  smx_HeapCacheFlush()
+*
+*  Frees all blocks in the task heap cache to heap 0. Called from 
+*  smx_TaskFreeAll().
+*/
+bool smx_HeapCacheFlush(TCB_PTR task)
+{
+   bool pass;
+   if (eh_hvpn == 0)
+      return true;
+   if (!smx_HeapEnter((u32)task, 0, SMX_ID_HEAP_FREE))
+      return false;
+   smx_HeapCacheFlush_F(task);
+   pass = (eh_hvp[0]->errno == EH_OK);
+   smx_HeapExit(pass, 0, SMX_ID_HEAP_FREE);
+   return pass;
+}
+
+/* Frees task heap cache blocks with heap 0 mutex owned. Returns true if any 
+   blocks were freed. */
+static bool smx_HeapCacheFlush_F(TCB_PTR task)
+{
+   void* bp;
+   bool  found = false;
+   u32   i;
+
+   for (i = 0; i < SMX_HEAP_CACHE_BINS; i++)
+   {
+      while ((bp = smx_hcache[task->indx][i]) != NULL)
+      {
+         smx_hcache[task->indx][i] = *(void**)bp;
+         eh_Free(bp, 0);
+         found = true;
+      }
+      smx_hcnum[task->indx][i] = 0;
+   }
+   return found;
+}
+
+/* Gets a block from the current task heap cache. Returns NULL if the request 
+   cannot be served from the cache. */
+static void* smx_HeapCacheGet(u32 sz, u32 an, u32 hn)
+{
+   void** lp;  /* list pointer */
+   void*  bp;
+   u32    i;
+
+   if (hn != 0 || an > 3 || smx_clsr != NULL || eh_hvpn == 0)
+      return NULL;
+   if (eh_hvp[0]->mode.fl.debug || eh_hvp[0]->mode.fl.fill)
+      return NULL;
+
+   /* find SBA bin for the chunk eh_Malloc() would allocate <3> */
+   if (sz < 16)
+      sz = 16;
+   else
+      sz = (sz + 7)&0xFFFFFFF8;
+   i = (sz + 8)/8 - 3;
+   if (i >= SMX_HEAP_CACHE_BINS)
+      return NULL;
+
+   lp = &smx_hcache[smx_ct->indx][i];
+   if ((bp = *lp) != NULL)
+   {
+      *lp = *(void**)bp;
+      smx_hcnum[smx_ct->indx][i]--;
+   }
+   return bp;
+}
+
+/* Puts a block into the current task heap cache. Returns false if the block 
+   cannot be cached and must be freed to the heap. */
+static bool smx_HeapCachePut(void* bp, u32 hn)
+{
+   CICB_PTR cp;
+   void*    p;
+   u32      csz, flags, i;
+
+   if (hn != 0 || bp == NULL || smx_clsr != NULL || eh_hvpn == 0)
+      return false;
+   if (eh_hvp[0]->mode.fl.debug || eh_hvp[0]->mode.fl.fill)
+      return false;
+
+   /* block must be in the chunk area of heap 0 */
+   if (((u32)bp & 7) || (CICB_PTR)bp <= eh_hvp[0]->pi || (CICB_PTR)bp >= eh_hvp[0]->px)
+      return false;
+
+   /* chunk must be a plain inuse chunk with a cacheable SBA size */
+   flags = *((u32*)bp - 1) & EH_FLAGS;
+   if (flags != EH_INUSE)
+      return false;
+   cp  = (CICB_PTR)((u32)bp - 8);
+   csz = (u32)cp->fl - (u32)cp;
+   if (cp->fl <= (CCB_PTR)eh_hvp[0]->pi || cp->fl > (CCB_PTR)eh_hvp[0]->px 
+                                        || csz > eh_hvp[0]->sba_top_sz)
+      return false;
+
+   /* next chunk must link back to it -- excludes block pool blocks */
+   if (((u32)cp->fl->blf & ~EH_FLAGS) != (u32)cp)
+      return false;
+   i = csz/8 - 3;
+   if (i >= SMX_HEAP_CACHE_BINS || smx_hcnum[smx_ct->indx][i] >= SMX_HEAP_CACHE_NUM)
+      return false;
+
+   /* prevent double free */
+   for (p = smx_hcache[smx_ct->indx][i]; p != NULL; p = *(void**)p)
+   {
+      if (p == bp)
+      {
+         smx_ERROR(SMXE_HEAP_ERROR, 0);
+         return true;
+      }
+   }
+
+   *(void**)bp = smx_hcache[smx_ct->indx][i];
+   smx_hcache[smx_ct->indx][i] = bp;
+   smx_hcnum[smx_ct->indx][i]++;
+   return true;
+}
+#endif /* SMX_CFG_HEAP_CACHE */
+
 /* Notes:
    1. This covers both a call from an SSR and from the SVC handler. This also 
       allows LSR access if the hn mutex is free. If preemption is not allowed
       for the heap (hpv[n]->mode.fl.eh_pre == 0), hmtx == NULL.
    2. smx_HeapEnter() can be called twice if first called from umode, then
       the SSR is called from pmode.
+   3. If SMX_CFG_HEAP_CACHE, blocks of heap 0 with chunk sizes in the first
+      SMX_HEAP_CACHE_BINS SBA bins, which are freed by a task, are kept in a
+      per-task list, indexed by task->indx, up to SMX_HEAP_CACHE_NUM per bin. 
+      The task gets them back from smx_HeapMalloc() without taking the heap 
+      mutex or logging to EVB. Only the task uses its own lists, so no other
+      protection is needed. LSRs bypass the cache. Cached chunks stay inuse 
+      chunks in the heap, so heap scans and heap used still cover them. The 
+      cache is bypassed in debug and fill modes so that debug info and fill 
+      patterns stay correct. It is flushed when the task is deleted and when
+      heap 0 has insufficient space for a smx_HeapMalloc().
+   4. If EH_OSTATS, the heap allocation services get their call site with 
+      smx_HeapSiteGet() and save it in smx_hsite, after getting heap access,
+      and eh_site() returns it to eheap for the CDCB of the new chunk or for
+      the block pool site index (see eheap.h note 8). The site is the 
+      service return address, except: (1) for a umode call, the service is
+      called by smx_SVC_Handler() and the site is the return address of the 
+      smxu shim, taken from the exception frame; (2) wrappers, such as 
+      malloc(), new, and pvPortMalloc(), use smx_HEAP_SITE_SET() to pass 
+      their own return address, which is used for the next allocation by the
+      task. The lock-free block pool paths are skipped, so pool blocks are 
+      counted under the heap mutex. To find the task or call site holding 
+      the most heap, walk the owner and site arrays loaded in the EHV, or use
+      smx_HeapOwnerPeek() and smx_HeapSitePeek() for a known task or site.
+   5. If SMX_CFG_HEAP_PLACE, smx_HeapMallocP() selects a heap by placement 
+      hint, instead of by heap number. smx_hpl[hint] lists the heaps to try
+      for each hint, in order, and is loaded with smx_HeapPlaceSet(). By 
+      default, every hint uses only heap 0. For example, on a board with 
+      DTCM, SRAM, and SDRAM heaps, SMX_HP_FAST might list DTCM then SRAM,
+      SMX_HP_DMA only SRAM, and SMX_HP_LARGE SDRAM then SRAM. A heap is tried
+      under its own mutex, so a fallback does not hold two heaps at once. 
+      smx_hpfb[hn] counts allocations that fell back to heap hn, which shows
+      when a preferred heap is too small; use smx_HeapPeek(EH_PK_INUSE, hn) 
+      and smx_HeapPeek(EH_PK_MAXUSE, hn) for per-heap usage. Blocks can be 
+      freed with smx_HeapFreeP(), which finds the heap by address, or with 
+      smx_HeapFree(). smx_HeapPlaceTask() sets a task default hint, which is
+      used for SMX_HP_TASK.
+   6. smx_HeapMallocM() and smx_HeapFreeM() take the heap mutex once for a 
+      batch of blocks, such as a message and its buffers, so a batch costs 
+      one mutex get and usually one free chunk search or merge, not n. 
+      smx_HeapMallocM() does not use the heap cache or block pools. Its 
+      blocks may be freed singly with smx_HeapFree(), and any blocks of heap
+      hn may be freed with smx_HeapFreeM(). See eheap.h note 11.
 */
@@ -29,8 +29,12 @@
 #include "xsmx.h"
 
 /* internal subroutines */
+static MCB_PTR smx_MsgGet_F(PCB_PTR pool, u8** bpp, u16 clrsz, MCB_PTR* mhp);
 static void smx_MsgPriorityPromotion(XCB_PTR xchg, MCB_PTR msg);
 static bool smx_MsgXchgClear_F(XCB_PTR xchg);
+#if SMX_SIZE_XSEL
+static TCB_PTR smx_MsgXchgSelect(XCB_PTR xchg);
+#endif
 
 /* shared subroutines -- see xsmx.h */
 /* smx_MsgReceive_F(), smx_MsgRel_F(), smx_MsgRelAll_F() */
@@ -111,7 +115,6 @@ bool smx_MsgBump(MCB_PTR msg, u8 pri)
 MCB_PTR smx_MsgGet(PCB_PTR pool, u8** bpp, u16 clrsz, MCB_PTR* mhp)
 {
    MCB_PTR msg;
-   u8     *bp;
 
    smx_SSR_ENTER4(SMX_ID_MSG_GET, pool, bpp, clrsz, mhp);
    smx_EXIT_IF_IN_ISR(SMX_ID_MSG_GET, NULL);
@@ -124,49 +127,89 @@ MCB_PTR smx_MsgGet(PCB_PTR pool, u8** bpp, u16 clrsz, MCB_PTR* mhp)
       {
          /* get block if pool not empty */
          if (pool->pn != NULL)
-         {
-            /* get MCB */
-            if ((msg = (MCB_PTR)smx_mcbs.pn) == NULL)
-               smx_ERROR_EXIT(SMXE_OUT_OF_MCBS, NULL, 0, SMX_ID_MSG_GET);
-            smx_mcbs.pn = *(u8**)msg;
-            smx_mcbs.num_used++;
-
-            /* get next block and update pcb.pn, with interrupts disabled */
-            sb_INT_DISABLE();
-            bp = pool->pn;
-            pool->pn = *(u8**)bp;
-            pool->num_used++;
-            sb_INT_ENABLE();
-
-            /* initialize MCB */
-            msg->fl = NULL;
-            msg->cbtype = SMX_CB_MCB;
-            msg->bp = bp;
-            msg->bs = (u32)pool;
-            msg->onr = (smx_clsr ? (TCB_PTR)smx_clsr : smx_ct);
-            msg->pri = 0;
-            msg->rpx = 0xFF;
-            msg->mhp = mhp;
+            msg = smx_MsgGet_F(pool, bpp, clrsz, mhp);
+         else
+            smx_ERROR_EXIT(SMXE_POOL_EMPTY, NULL, 0, SMX_ID_MSG_GET);
+      }
+   }
+   return((MCB_PTR)smx_SSRExit((u32)msg, SMX_ID_MSG_GET));
+}
+
+/*
+*  smx_MsgGetSz()   SSR
+*
+*  Gets a message with a block of at least sz bytes from pool set, set. Size
+*  classes are searched in order, so set->cls must be in increasing block size
+*  order. The block comes from the smallest class that fits sz and has a free
+*  block. If it is full, the next larger class is tried, and so on, all in one
+*  SSR. Updates the statistics of the class used. If no class has a free
+*  block, increments set->fails and reports POOL_EMPTY. Reports INV_PAR if
+*  set is not valid or sz is larger than the largest class. Otherwise, 
+*  operates like smx_MsgGet().
+*/
+MCB_PTR smx_MsgGetSz(MPS_PTR set, u32 sz, u8** bpp, u16 clrsz, MCB_PTR* mhp)
+{
+   MPSC*    cp;
+   MPSC*    cx;
+   MCB_PTR  msg;
+   u32      szx = 0;
+   bool     fit = false;
+
+   smx_SSR_ENTER5(SMX_ID_MSG_GET_SZ, set, sz, bpp, clrsz, mhp);
+   smx_EXIT_IF_IN_ISR(SMX_ID_MSG_GET_SZ, NULL);
+
+   if (set == NULL || set->cls == NULL || set->num == 0)
+      smx_ERROR_EXIT(SMXE_INV_PAR, NULL, 0, SMX_ID_MSG_GET_SZ);
+
+   /* verify that current task has access permission to set */
+   if (!smx_TOKEN_TEST(smx_ct, (u32)set, SMX_PRIV_HI))
+      return((MCB_PTR)smx_SSRExit(NULL, SMX_ID_MSG_GET_SZ));
+
+   /* verify that class pools are valid, that current task has access 
+      permission, and that they are in increasing block size order */
+   for (cp = set->cls, cx = cp + set->num; cp < cx; cp++)
+   {
+      if (!smx_PCBTest(cp->pool, SMX_PRIV_LO))
+         return((MCB_PTR)smx_SSRExit(NULL, SMX_ID_MSG_GET_SZ));
+      if (cp->pool->size < szx)
+         smx_ERROR_EXIT(SMXE_INV_PAR, NULL, 0, SMX_ID_MSG_GET_SZ);
+      szx = cp->pool->size;
+   }
+
+   /* no class can hold sz */
+   if (sz > szx)
+      smx_ERROR_EXIT(SMXE_INV_PAR, NULL, 0, SMX_ID_MSG_GET_SZ);
+
+   /* block multiple gets and verify current task has msg get permission */
+   if ((msg = (MCB_PTR)smx_ObjectCreateTestH((u32*)mhp)) && !smx_errno)
+   {
+      msg = NULL;
+      for (cp = set->cls; cp < cx; cp++)
+      {
+         /* skip classes too small for sz */
+         if (cp->pool->size < sz)
+            continue;
 
-            /* clear clrsz bytes, up to block size */
-            if (clrsz)
+         /* get block from first class that fits and is not empty */
+         if (cp->pool->pn != NULL)
+         {
+            if ((msg = smx_MsgGet_F(cp->pool, bpp, clrsz, mhp)) != NULL)
             {
-               if (clrsz < pool->size)
-                  memset(bp, 0, clrsz);
-               else
-                  memset(bp, 0, pool->size);
+               cp->gets++;
+               if (fit)
+                  cp->falls++;
+               cp->waste += cp->pool->size - sz;
+               if (cp->pool->num_used > cp->hwm)
+                  cp->hwm = cp->pool->num_used;
             }
-            /* load message block pointer and message handle */
-            if (bpp)
-               *bpp = bp;
-            if (mhp)
-               *mhp = msg;
+            return((MCB_PTR)smx_SSRExit((u32)msg, SMX_ID_MSG_GET_SZ));
          }
-         else
-            smx_ERROR_EXIT(SMXE_POOL_EMPTY, NULL, 0, SMX_ID_MSG_GET);
+         fit = true;
       }
+      set->fails++;
+      smx_ERROR_EXIT(SMXE_POOL_EMPTY, NULL, 0, SMX_ID_MSG_GET_SZ);
    }
-   return((MCB_PTR)smx_SSRExit((u32)msg, SMX_ID_MSG_GET));
+   return((MCB_PTR)smx_SSRExit((u32)msg, SMX_ID_MSG_GET_SZ));
 }
 
 /*
@@ -354,6 +397,50 @@ u32 smx_MsgRelAll(TCB_PTR task)
    return(smx_SSRExit(n, SMX_ID_MSG_REL_ALL));
 }
 
+/*
+*  smx_MsgRelM()   SSR
+*
+*  Releases up to n messages whose handles are in mcba, in one SSR. NULL
+*  entries are skipped. Each message is tested and released as by
+*  smx_MsgRel() and its entry in mcba is cleared. If an entry is not its
+*  message's handle, ct must also have access to the entry. Stops at the 
+*  first message that fails. Returns the number of messages released.
+*/
+u32 smx_MsgRelM(MCB_PTR* mcba, u32 n, u16 clrsz)
+{
+   MCB_PTR  msg;
+   u32      i;
+   u32      nr = 0;
+
+   smx_SSR_ENTER3(SMX_ID_MSG_REL_M, mcba, n, clrsz);
+   smx_EXIT_IF_IN_ISR(SMX_ID_MSG_REL_M, 0);
+
+   if (mcba == NULL)
+      smx_ERROR_EXIT(SMXE_INV_PAR, 0, 0, SMX_ID_MSG_REL_M);
+
+   for (i = 0; i < n; i++)
+   {
+      if ((msg = mcba[i]) == NULL)
+         continue;
+
+      /* verify that msg is valid and that current task is its owner and has 
+         access permission */
+      if (!smx_MCBOnrTest(msg, SMX_PRIV_HI))
+         break;
+      if (msg->mhp != &mcba[i] && !smx_TOKEN_TEST(smx_ct, (u32)&mcba[i], SMX_PRIV_HI))
+         break;
+
+      /* dequeue msg from broadcast exchange */
+      if (msg->fl != NULL)
+         smx_DQMsg(msg);
+      if (!smx_MsgRel_F(msg, clrsz))
+         break;
+      mcba[i] = NULL;
+      nr++;
+   }
+   return(smx_SSRExit(nr, SMX_ID_MSG_REL_M));
+}
+
 /*
 *  smx_MsgUnmake()   SSR
 *
@@ -417,6 +504,182 @@ MCB_PTR smx_MsgReceive(XCB_PTR xchg, u8** bpp, u32 timeout, MCB_PTR* mhp)
    return((MCB_PTR)smx_SSRExit((u32)msg, SMX_ID_MSG_RECEIVE));
 }
 
+#if SMX_SIZE_XSEL
+/*
+*  smx_MsgReceiveAny()   SSR
+*
+*  Receives the first message available at any of the num exchanges in list xl.
+*  Exchanges are tested in list order and the index of the exchange that
+*  supplied the message is loaded into *xip, if xip != NULL. If no message is
+*  waiting and timeout > 0, ct waits in smx_xselq, in priority order, and the
+*  first message sent to any listed exchange is given to it. Since ct waits in
+*  only one queue, resuming it removes it from all listed exchanges. num must 
+*  be <= SMX_SIZE_XSEL. Broadcast exchanges are not allowed. Aborts if called
+*  from LSR and tmo != SMX_TMO_NOWAIT. Clears lockctr if called from a task 
+*  and tmo != SMX_TMO_NOWAIT. Not present if SMX_SIZE_XSEL is 0. <6>
+*/
+MCB_PTR smx_MsgReceiveAny(XCB_PTR* xl, u32 num, u8** bpp, u32 timeout, MCB_PTR* mhp, u32* xip)
+{
+   MCB_PTR  msg = NULL;
+   TCB_PTR  ct = smx_ct;
+   XSEL*    xs;
+   u32      i;
+
+   smx_SSR_ENTER6(SMX_ID_MSG_RECEIVE_ANY, xl, num, bpp, timeout, mhp, xip);
+   smx_EXIT_IF_IN_ISR(SMX_ID_MSG_RECEIVE_ANY, NULL);
+
+   if (smx_clsr && timeout)
+      smx_ERROR_EXIT(SMXE_WAIT_NOT_ALLOWED, NULL, 0, SMX_ID_MSG_RECEIVE_ANY);
+
+   /* test exchange list parameters */
+   if (xl == NULL || num == 0 || num > SMX_SIZE_XSEL)
+      smx_ERROR_EXIT(SMXE_INV_PAR, NULL, 0, SMX_ID_MSG_RECEIVE_ANY);
+
+   /* block multiple receives and verify current task has msg receive permission */
+   if ((msg = (MCB_PTR)smx_ObjectCreateTestH((u32*)mhp)) && !smx_errno)
+   {
+      msg = NULL;
+
+      /* verify that all exchanges are valid, accessible, and not broadcast */
+      for (i = 0; i < num; i++)
+      {
+         if (!smx_XCBTest(xl[i], SMX_PRIV_LO))
+            return((MCB_PTR)smx_SSRExit(NULL, SMX_ID_MSG_RECEIVE_ANY));
+         if (xl[i]->mode == SMX_XCHG_BCST)
+            smx_ERROR_EXIT(SMXE_WRONG_MODE, NULL, 0, SMX_ID_MSG_RECEIVE_ANY);
+      }
+
+      /* receive msg from first exchange that has one */
+      xs = &smx_xsel[ct->indx];
+      for (i = 0; i < num; i++)
+      {
+         if (xl[i]->flags.mq)
+         {
+            msg = smx_MsgReceive_F(xl[i], bpp, SMX_TMO_NOWAIT, mhp);
+            xs->xi = i;
+            break;
+         }
+      }
+
+      /* else wait in exchange select queue with a copy of xl */
+      if (i == num && timeout)
+      {
+         smx_DQRQTask(ct);
+         smx_PNQTask(smx_xselq, ct, SMX_CB_XSELQ);
+         ct->sv  = (u32)bpp;
+         ct->sv2 = (u32)mhp;
+         xs->xmap = 0;
+         for (i = 0; i < num; i++)
+         {
+            xs->xl[i] = xl[i];
+            xs->xmap |= 1 << ((xl[i] - (XCB_PTR)smx_xcbs.pi) & 31);
+            xl[i]->flags.sel = 1;
+         }
+         xs->num = num;
+         ct->flags.msg_m = 0;
+
+         smx_TimeoutSet(ct, timeout);
+         smx_sched = SMX_CT_SUSP;
+      }
+      if (timeout)
+         smx_lockctr = 0;
+   }
+   msg = (MCB_PTR)smx_SSRExit((u32)msg, SMX_ID_MSG_RECEIVE_ANY);
+
+   /* ct has msg, possibly after waiting, so load exchange index */
+   if (msg != NULL && xip != NULL)
+      *xip = smx_xsel[ct->indx].xi;
+   return msg;
+}
+#endif /* SMX_SIZE_XSEL */
+
+/*
+*  smx_MsgReceiveM()   SSR
+*
+*  Receives up to max messages from normal exchange xchg in one SSR. Their 
+*  handles are loaded into mcba[0..n-1] in queue order and each entry becomes
+*  its message's handle. Returns n. If no message is waiting and timeout > 0,
+*  ct waits at xchg like smx_MsgReceive(). The first message sent is loaded
+*  into mcba[0] and 1 is returned. Returns 0 if timeout or error. Each entry
+*  loaded must be NULL and, if ct needs tokens, have its own token. Stops at 
+*  the first entry that fails. Aborts if called from LSR and tmo != 
+*  SMX_TMO_NOWAIT. Clears lockctr if called from a task and tmo != 
+*  SMX_TMO_NOWAIT.
+*/
+u32 smx_MsgReceiveM(XCB_PTR xchg, MCB_PTR* mcba, u32 max, u32 timeout)
+{
+   MCB_PTR  msg = NULL;
+   TCB_PTR  ct = smx_ct;
+   u32      n = 0;
+
+   smx_SSR_ENTER4(SMX_ID_MSG_RECEIVE_M, xchg, mcba, max, timeout);
+   smx_EXIT_IF_IN_ISR(SMX_ID_MSG_RECEIVE_M, 0);
+
+   if (smx_clsr && timeout)
+      smx_ERROR_EXIT(SMXE_WAIT_NOT_ALLOWED, 0, 0, SMX_ID_MSG_RECEIVE_M);
+
+   if (mcba == NULL || max == 0)
+      smx_ERROR_EXIT(SMXE_INV_PAR, 0, 0, SMX_ID_MSG_RECEIVE_M);
+
+   /* block multiple receives and verify current task has msg receive permission */
+   if (smx_ObjectCreateTestH((u32*)mcba) && !smx_errno)
+   {
+      /* verify that xchg is valid and that current task has access permission */
+      if (!smx_XCBTest(xchg, SMX_PRIV_LO))
+         return(smx_SSRExit(0, SMX_ID_MSG_RECEIVE_M));
+      if (xchg->mode != SMX_XCHG_NORM)
+         smx_ERROR_EXIT(SMXE_WRONG_MODE, 0, 0, SMX_ID_MSG_RECEIVE_M);
+
+      /* dequeue waiting messages up to max and assign clsr or ct as their 
+         owner if not bound msgs */
+      while (xchg->flags.mq && n < max)
+      {
+         /* verify that mcba[n] is free and current task has access to it */
+         if (n > 0 && (smx_ObjectCreateTestH((u32*)&mcba[n]) == 0 || smx_errno))
+            break;
+         msg = smx_DQFMsg((CB_PTR)xchg);
+
+        #if SMX_CFG_PORTAL
+         if (msg->con.bnd)
+            xchg->bct = smx_ct; /* client */
+         else
+        #endif
+         {
+            xchg->bct = NULL;
+            msg->onr = (smx_clsr ? (TCB_PTR)smx_clsr : ct);
+         }
+         msg->mhp = &mcba[n];
+         mcba[n++] = msg;
+      }
+
+     #if SMX_CFG_SSMX
+      /* if not fixed, set taskp priv = last msg priv */
+      if (n > 0)
+      {
+         TCB_PTR  taskp = (ct->parent ? ct->parent : ct);
+         if (!taskp->flags.priv_fixed)
+            taskp->priv = msg->priv;
+      }
+     #endif
+
+      /* no message waiting: wait for one message */
+      if (n == 0 && timeout)
+      {
+         smx_DQRQTask(ct);
+         smx_PNQTask((CB_PTR)xchg, ct, xchg->cbtype);
+         xchg->flags.tq = 1;
+         ct->flags.msg_m = 1;
+         ct->sv  = 0;
+         ct->sv2 = (u32)mcba;
+         smx_TimeoutSet(ct, timeout);
+         smx_sched = SMX_CT_SUSP;
+      }
+      if (timeout)
+         smx_lockctr = 0;
+   }
+   return(smx_SSRExit(n, SMX_ID_MSG_RECEIVE_M));
+}
+
 /*
 *  smx_MsgReceiveStop()   SSR
 *
@@ -461,7 +724,9 @@ void smx_MsgReceiveStop(XCB_PTR xchg, u8** bpp, u32 timeout, MCB_PTR* mhp)
 *  pass exchange, assign the message's priority to the task, enqueue the task 
 *  on rq and clear the task's timeout unless there is a mutex conflict. If
 *  priority promotion is enabled, the task becomes the new xchg owner.
-*  If tq == 0, enqueue the message at xchg, in priority order. If xchg is a
+*  If tq == 0 and sel == 1, give the message to the highest priority task 
+*  waiting for xchg in smx_MsgReceiveAny(), if any, as above <5>.
+*  Else, enqueue the message at xchg, in priority order. If xchg is a
 *  pass exchange and priority inheritance is enabled, increase the xchg owner 
 *  priority to the new msg priority, if it is greater.
 *
@@ -527,10 +792,17 @@ bool smx_MsgSend(MCB_PTR msg, XCB_PTR xchg, u8 pri, void* reply)
          /* normal or pass exchange */
          if (xchg->mode != SMX_XCHG_BCST)
          {
+            task = NULL;
             if (xchg->flags.tq == 1) /* a task is waiting */
-            {
-               /* give msg to first waiting task and resume task */
                task = smx_DQFTask((CB_PTR)xchg);
+           #if SMX_SIZE_XSEL
+            else if (xchg->flags.sel == 1) /* a select task may be waiting */
+               task = smx_MsgXchgSelect(xchg);
+           #endif
+
+            if (task != NULL)
+            {
+               /* give msg to waiting task and resume task */
 
               #if SMX_CFG_PORTAL
                if (msg->con.bnd)
@@ -553,11 +825,20 @@ bool smx_MsgSend(MCB_PTR msg, XCB_PTR xchg, u8 pri, void* reply)
                if (xchg->flags.pi)
                   xchg->onr = task;
 
-               task->rv = (u32)msg;
-               smx_PUT_RV_IN_EXR0(task)
                mhp = (MCB_PTR*)task->sv2;
                msg->mhp = mhp;
 
+               /* smx_MsgReceiveM() returns count and msg handle in mcba[0] */
+               if (task->flags.msg_m)
+               {
+                  task->flags.msg_m = 0;
+                  *mhp = msg;
+                  task->rv = 1;
+               }
+               else
+                  task->rv = (u32)msg;
+               smx_PUT_RV_IN_EXR0(task)
+
                /* load message block pointer at address saved in sv if !NULL */
                if (task->sv != NULL)
                   *(u8**)task->sv = msg->bp;
@@ -818,6 +1099,59 @@ bool smx_MsgXchgSet(XCB_PTR xchg, SMX_ST_PAR par, u32 v1, u32 v2)
 *                            Do Not Call Directly                            *
 *===========================================================================*/
 
+/*
+*  smx_MsgGet_F()
+*
+*  Gets an MCB and a block from pool, which must be valid and not empty, and
+*  initializes the MCB. Clears clrsz bytes of the block, up to its size, and
+*  loads bpp and mhp, if not NULL. Returns the msg handle or NULL and reports
+*  OUT_OF_MCBS if no MCB is available. Called by smx_MsgGet() and
+*  smx_MsgGetSz().
+*/
+MCB_PTR smx_MsgGet_F(PCB_PTR pool, u8** bpp, u16 clrsz, MCB_PTR* mhp)
+{
+   MCB_PTR msg;
+   u8     *bp;
+
+   /* get MCB */
+   if ((msg = (MCB_PTR)smx_mcbs.pn) == NULL)
+      smx_ERROR_RET(SMXE_OUT_OF_MCBS, NULL, 0);
+   smx_mcbs.pn = *(u8**)msg;
+   smx_mcbs.num_used++;
+
+   /* get next block and update pcb.pn, with interrupts disabled */
+   sb_INT_DISABLE();
+   bp = pool->pn;
+   pool->pn = *(u8**)bp;
+   pool->num_used++;
+   sb_INT_ENABLE();
+
+   /* initialize MCB */
+   msg->fl = NULL;
+   msg->cbtype = SMX_CB_MCB;
+   msg->bp = bp;
+   msg->bs = (u32)pool;
+   msg->onr = (smx_clsr ? (TCB_PTR)smx_clsr : smx_ct);
+   msg->pri = 0;
+   msg->rpx = 0xFF;
+   msg->mhp = mhp;
+
+   /* clear clrsz bytes, up to block size */
+   if (clrsz)
+   {
+      if (clrsz < pool->size)
+         memset(bp, 0, clrsz);
+      else
+         memset(bp, 0, pool->size);
+   }
+   /* load message block pointer and message handle */
+   if (bpp)
+      *bpp = bp;
+   if (mhp)
+      *mhp = msg;
+   return msg;
+}
+
 /*
 *  smx_MsgPriorityPromotion()
 *
@@ -1053,6 +1387,7 @@ MCB_PTR smx_MsgReceive_F(XCB_PTR xchg, u8** bpp, u32 timeout, MCB_PTR* mhp)
                else
                   smx_NQTask((CB_PTR)xchg, ct);
                xchg->flags.tq = 1;
+               ct->flags.msg_m = 0;
                ct->sv  = (u32)bpp;
                ct->sv2 = (u32)mhp;
 
@@ -1068,9 +1403,11 @@ MCB_PTR smx_MsgReceive_F(XCB_PTR xchg, u8** bpp, u32 timeout, MCB_PTR* mhp)
 *  smx_MsgXchgClear_F()
 *
 *  Clears a message exchange by resuming all waiting tasks with NULL return
-*  values, if tq, or releasing all waiting messages, if mq. tq, mq, and
-*  xchg->fl are cleared. Returns true, if successful or false if invalid xchg.
-*  Aborts and reports error if invalid xchg or queue is broken.
+*  values, if tq, or releasing all waiting messages, if mq. Also resumes all
+*  tasks waiting for xchg in smx_MsgReceiveAny() with NULL return values, if
+*  sel. tq, mq, sel, and xchg->fl are cleared. Returns true, if successful or
+*  false if invalid xchg. Aborts and reports error if invalid xchg or queue is
+*  broken.
 */
 bool smx_MsgXchgClear_F(XCB_PTR xchg)
 {
@@ -1106,12 +1443,69 @@ bool smx_MsgXchgClear_F(XCB_PTR xchg)
             }
          }
       }
+     #if SMX_SIZE_XSEL
+      /* resume all tasks waiting for xchg in smx_MsgReceiveAny() */
+      if (xchg->flags.sel)
+      {
+         while ((task = smx_MsgXchgSelect(xchg)) != NULL)
+         {
+            smx_NQRQTask(task);
+            task->rv = 0;
+            smx_PUT_RV_IN_EXR0(task)
+            task->sv = 0;
+            smx_timeout[task->indx] = SMX_TMO_INF;
+         }
+         smx_DO_CTTEST();
+      }
+     #endif
       xchg->flags.tq = 0;
       xchg->flags.mq = 0;
    }
    return pass;
 }
 
+#if SMX_SIZE_XSEL
+/*
+*  smx_MsgXchgSelect()
+*
+*  Searches smx_xselq, in priority order, for the first task waiting for xchg
+*  in smx_MsgReceiveAny(). If found, dequeues the task, saves the index of xchg
+*  in the task's exchange list, and returns the task. The task's sv is 
+*  preserved for message delivery. If not found, clears xchg->flags.sel and 
+*  returns NULL. A task's list is searched only if its xmap has the bit for
+*  xchg. <7>
+*/
+static TCB_PTR smx_MsgXchgSelect(XCB_PTR xchg)
+{
+   TCB_PTR  t;
+   XSEL*    xs;
+   u32      i;
+   u32      sv;
+   u32      xbit = 1 << ((xchg - (XCB_PTR)smx_xcbs.pi) & 31);
+
+   for (t = (TCB_PTR)smx_xselq->fl; t != NULL && t->cbtype == SMX_CB_TASK;
+                                                        t = (TCB_PTR)t->fl)
+   {
+      xs = &smx_xsel[t->indx];
+      if ((xs->xmap & xbit) == 0)
+         continue;
+      for (i = 0; i < xs->num; i++)
+      {
+         if (xs->xl[i] == xchg)
+         {
+            sv = t->sv;
+            smx_DQTask(t);
+            t->sv = sv;
+            xs->xi = i;
+            return t;
+         }
+      }
+   }
+   xchg->flags.sel = 0;
+   return NULL;
+}
+#endif /* SMX_SIZE_XSEL */
+
 /* Notes:
    1. Current task will be suspended for up to smx_htmo ticks if heap hn is
       busy. Operation aborts with smx HEAP TIMEOUT error if timeout occurs.
@@ -1123,4 +1517,20 @@ bool smx_MsgXchgClear_F(XCB_PTR xchg)
    4. A client task bound to a server must have the same priority as the server. 
       This occurs with tunnel portals. The client task is returned to its normal
       priority when its portal connection is closed.
+   5. A task waiting at xchg itself takes precedence over a task waiting in
+      smx_MsgReceiveAny(). sel is cleared lazily, when a send or clear finds no
+      select task waiting for xchg.
+   6. The exchange list is copied into smx_xsel[], so a send never reads task
+      memory, and a task cannot change the list it waits on after its token
+      tests. smx_MsgXchgSelect() saves the exchange index in smx_xsel[], not
+      in the task's memory. smx_MsgReceiveAny() loads it into *xip after ct 
+      gets a message, in ct's own call. In umode, the SSR returns before ct 
+      resumes, so smxu_MsgReceiveAny() passes xip = NULL and loads *xip from 
+      smx_TaskPeek(SMX_CT, SMX_PK_XCHG).
+   7. smx_xselq has its own cbtype, SMX_CB_XSELQ, so smx_TaskLocate() and 
+      smx_SysWhatIs() report it as the select queue, not as an exchange. 
+      xmap lets a send skip select waiters that do not list xchg without 
+      walking their lists; only waiters with a matching bit are searched.
+      smx_MsgReceiveAny() and its RAM, SMX_NUM_TASKS*(SMX_SIZE_XSEL + 3)*4
+      bytes for smx_xsel[], are compiled out if SMX_SIZE_XSEL is 0.
 */
\ No newline at end of file
@@ -1,7 +1,7 @@
 /*
 * xmtx.c                                                    Version 6.0.0
 *
-* smx Mutex Functions
+* smx Mutex and Condition Variable Functions
 *
 * Copyright (c) 2004-2026 Micro Digital Inc.
 * All rights reserved. www.smxrtos.com
@@ -30,8 +30,13 @@
 
 /* internal subroutines */
 /* smx_MutexGetFast() and smx_MutexRelFast() in xsmx.h since shared */
+static void smx_CondVarResume_F(CVCB_PTR cv);
 static bool smx_MutexGet_F(MUCB_PTR mtx, u32 timeout);
+static void smx_MutexRel_F(MUCB_PTR mtx, TCB_PTR task);
 static void smx_MutexRemFromMOL(MUCB_PTR mtx, TCB_PTR task);
+static bool smx_MutexUmtxAdopt(MUCB_PTR mtx);
+static void smx_MutexUmtxSync(MUCB_PTR mtx);
+static void smx_MutexUmtxUnlink(MUCB_PTR mtx);
 
 /*
 *  smx_MutexClear()   SSR
@@ -89,6 +94,8 @@ bool smx_MutexClear(MUCB_PTR mtx)
             continue;                           /* Abort emptying task wait queue. */                         
          }
       }
+      if (mtx->um != NULL)
+         mtx->um->lock = (mtx->ceil ? SMX_UMTX_KERN : 0);
    }
    return((bool)smx_SSRExit(pass, SMX_ID_MUTEX_CLEAR));
 }
@@ -143,6 +150,14 @@ bool smx_MutexDelete(MUCB_PTR* muhp)
 
    if (pass = smx_MutexClear(mtx))
    {
+      /* unbind umode lock word so its fast path always fails */
+      if (mtx->um != NULL)
+      {
+         mtx->um->lock = SMX_UMTX_KERN;
+         mtx->um->mtx = NULL;
+         smx_MutexUmtxUnlink(mtx);
+      }
+
       /* release and clear MUCB & set mutex handle to nullcb */
       sb_BlockRel(&smx_mucbs, (u8*)mtx, sizeof(MUCB));
       *muhp = NULL;
@@ -166,7 +181,7 @@ bool smx_MutexFree(MUCB_PTR mtx)
    smx_EXIT_IF_IN_ISR(SMX_ID_MUTEX_FREE, false);
 
    /* verify that mutex is valid and that current task has access permission */
-   if (pass = smx_MUCBTest(mtx, SMX_PRIV_HI))
+   if ((pass = smx_MUCBTest(mtx, SMX_PRIV_HI)) && (pass = smx_MutexUmtxAdopt(mtx)))
    {
       task = mtx->onr;
 
@@ -213,6 +228,7 @@ bool smx_MutexFree(MUCB_PTR mtx)
             mtx->onr  = NULL;                /* Free mutex. */
          }
       }
+      smx_MutexUmtxSync(mtx);
    }
    return((bool)smx_SSRExit(pass, SMX_ID_MUTEX_FREE));
 }
@@ -227,8 +243,8 @@ bool smx_MutexGet(MUCB_PTR mtx, u32 timeout)
 {
    bool pass;
 
-   if (smx_clsr)
-      return !(bool)mtx->onr; /* allow LSR access if mutex is free */
+   if (smx_clsr)  /* allow LSR access if mutex is free */
+      return !(bool)mtx->onr && !(mtx->um != NULL && (mtx->um->lock & ~SMX_UMTX_KERN));
 
    smx_SSR_ENTER2(SMX_ID_MUTEX_GET, mtx, timeout);
    smx_EXIT_IF_IN_ISR(SMX_ID_MUTEX_GET, false);
@@ -261,6 +277,17 @@ void smx_MutexGetStop(MUCB_PTR mtx, u32 timeout)
    smx_SSRExit(pass, SMX_ID_MUTEX_GET_STOP);
 }
 
+/*
+*  smx_MutexGetU()
+*
+*  pmode counterpart of smxu_MutexGetU() for a mutex bound to umode lock word
+*  um. Calls smx_MutexGet() since there is no SVC to avoid.
+*/
+bool smx_MutexGetU(UMTX_PTR um, u32 timeout)
+{
+   return smx_MutexGet(um->mtx, timeout);
+}
+
 /*
 *  smx_MutexPeek()   SSR
 *
@@ -317,7 +344,6 @@ u32 smx_MutexPeek(MUCB_PTR mtx, SMX_PK_PAR par)
 */
 bool smx_MutexRel(MUCB_PTR mtx)
 {
-   TCB_PTR  nxt;  /* next task */
    bool     pass;
    TCB_PTR  task = smx_ct;
 
@@ -328,7 +354,7 @@ bool smx_MutexRel(MUCB_PTR mtx)
    smx_EXIT_IF_IN_ISR(SMX_ID_MUTEX_REL, false);
 
    /* verify that mutex is valid and that current task has access permission */
-   if (pass = smx_MUCBTest(mtx, SMX_PRIV_LO))
+   if ((pass = smx_MUCBTest(mtx, SMX_PRIV_LO)) && (pass = smx_MutexUmtxAdopt(mtx)))
    {
       if (mtx->onr != smx_ct)
       {
@@ -344,57 +370,31 @@ bool smx_MutexRel(MUCB_PTR mtx)
       else  /* Mutex owned by ct */
       {
          if (--mtx->ncnt == 0)               /* Decrement nesting count and test. */
-         {
-            smx_MutexRemFromMOL(mtx, task);
-
-            /* reduce task priority if it was promoted */
-            if (task->pri != task->prinorm)
-               smx_TaskPriAdj(task);
-
-            if (mtx->fl != NULL)             /* If mutex task queue is not empty: */
-            {
-               nxt = (TCB_PTR)mtx->fl;       /* Get next task, nxt. */
-               mtx->onr = nxt;               /* Give the mutex to nxt. */
-               mtx->ncnt = 1;                /* Set nesting count = 1. */
-
-               if (nxt->fl == (CB_PTR)mtx)   /* Dequeue nxt from mutex wait list. <3> */
-                  mtx->fl = NULL;
-               else
-               {
-                  nxt->fl->bl = nxt->bl;
-                  nxt->bl->fl = nxt->fl;
-               }
-
-               /* Link mtx into nxt's mutex owned list. */
-               if (nxt->molp != NULL)
-                  mtx->molp = nxt->molp;
-               nxt->molp = mtx;
-
-               /* Promote nxt priority to mtx ceiling. */
-               if (nxt->pri < mtx->ceil)
-                  nxt->pri = mtx->ceil;
-
-               nxt->flags.in_prq = 0;
-               nxt->flags.mtx_wait = 0;               /* Reset task's mutex wait flag. */
-               smx_NQRQTask(nxt);                     /* Enqueue nxt into rq. */
-               smx_DO_CTTEST();                       /* Possible preemption. */
-               smx_timeout[nxt->indx] = SMX_TMO_INF;  /* Reset nxt timeout timer. */
-               nxt->rv = true;                        /* Prior smx_MutexGet from nxt has succeeded. */
-               smx_PUT_RV_IN_EXR0(nxt)
-            }
-            else
-               mtx->onr = NULL;              /* Release mutex. */
-         }
+            smx_MutexRel_F(mtx, task);
       }
    }
    return((bool)smx_SSRExit(pass, SMX_ID_MUTEX_REL));
 }
 
+/*
+*  smx_MutexRelU()
+*
+*  pmode counterpart of smxu_MutexRelU(). Calls smx_MutexRel().
+*/
+bool smx_MutexRelU(UMTX_PTR um)
+{
+   return smx_MutexRel(um->mtx);
+}
+
 /*
 *  smx_MutexSet()   SSR
 *
 *  Sets the specified mutex parameter to the specified value.
 *  Not permitted in umode.
+*
+*  SMX_ST_UMTX: binds umode lock word v1 to mtx, which must be free. v2 is the
+*     top parent task of the partition whose tasks may own mtx via v1. v1 = 
+*     NULL unbinds the current lock word.
 */
 bool smx_MutexSet(MUCB_PTR mtx, SMX_ST_PAR par, u32 v1, u32 v2)
 {
@@ -414,6 +414,28 @@ bool smx_MutexSet(MUCB_PTR mtx, SMX_ST_PAR par, u32 v1, u32 v2)
       /* perform set operation on mutex */
       switch (par)
       {
+         case SMX_ST_UMTX:  /* bind umode lock word v1 to free mutex <7> */
+            if (mtx->onr != NULL || (mtx->um != NULL && mtx->um->lock & ~SMX_UMTX_KERN))
+               smx_ERROR_EXIT(SMXE_INV_OP, false, 0, SMX_ID_MUTEX_SET);
+            if (v1 != NULL && (!smx_TCBTest((TCB_PTR)v2, SMX_PRIV_LO) || 
+                               ((TCB_PTR)v2)->parent != NULL))
+               smx_ERROR_EXIT(SMXE_INV_PAR, false, 0, SMX_ID_MUTEX_SET);
+            if (mtx->um != NULL)
+            {
+               mtx->um->lock = SMX_UMTX_KERN;
+               mtx->um->mtx = NULL;
+               smx_MutexUmtxUnlink(mtx);
+            }
+            mtx->um = (UMTX_PTR)v1;
+            mtx->umpt = (v1 != NULL ? (TCB_PTR)v2 : NULL);
+            if (mtx->um != NULL)
+            {
+               mtx->um->mtx = mtx;
+               mtx->umlp = smx_umtxl;
+               smx_umtxl = mtx;
+               smx_MutexUmtxSync(mtx);
+            }
+            break;
          default:
             smx_ERROR_EXIT(SMXE_INV_PAR, false, 0, SMX_ID_MUTEX_SET);
       }
@@ -421,6 +443,168 @@ bool smx_MutexSet(MUCB_PTR mtx, SMX_ST_PAR par, u32 v1, u32 v2)
    return((bool)smx_SSRExit(pass, SMX_ID_MUTEX_SET));
 }
 
+/*============================================================================
+*                      CONDITION VARIABLE SERVICES <6>                       *
+============================================================================*/
+
+/*
+*  smx_CondVarBroadcast()   SSR
+*
+*  Wakes all tasks waiting at cv. They reacquire the bound mutex in priority
+*  order. Returns true, if cv is valid.
+*/
+bool smx_CondVarBroadcast(CVCB_PTR cv)
+{
+   bool pass;
+
+   smx_SSR_ENTER1(SMX_ID_CV_BROADCAST, cv);
+   smx_EXIT_IF_IN_ISR(SMX_ID_CV_BROADCAST, false);
+
+   /* verify that cv is valid and that current task has access permission */
+   if (pass = smx_CVCBTest(cv, SMX_PRIV_LO))
+   {
+      while (cv->fl != NULL)
+         smx_CondVarResume_F(cv);
+   }
+   return((bool)smx_SSRExit(pass, SMX_ID_CV_BROADCAST));
+}
+
+/*
+*  smx_CondVarCreate()   SSR
+*
+*  Gets a CVCB and initializes it. If cannot get a CVCB, does an error exit
+*  and returns NULL. Otherwise returns condition variable handle.
+*/
+CVCB_PTR smx_CondVarCreate(const char* name, CVCB_PTR* cvhp)
+{
+   CVCB_PTR  cv;
+
+   smx_SSR_ENTER2(SMX_ID_CV_CREATE, name, cvhp);
+   smx_EXIT_IF_IN_ISR(SMX_ID_CV_CREATE, NULL);
+
+   /* block multiple creates and verify current task has create permission */
+   if ((cv = (CVCB_PTR)smx_ObjectCreateTestH((u32*)cvhp)) && !smx_errno)
+   {
+      /* get a condition variable control block */
+      if ((cv = (CVCB_PTR)sb_BlockGet(&smx_cvcbs, 4)) == NULL)
+         smx_ERROR_EXIT(SMXE_OUT_OF_CVCBS, NULL, 0, SMX_ID_CV_CREATE);
+
+      /* initialize CVCB */
+      cv->cbtype = SMX_CB_CV;
+      cv->cvhp = cvhp;
+      if (name && *name)
+         cv->name = name;
+
+      /* load condition variable handle */
+      if (cvhp)
+         *cvhp = cv;
+   }
+   return((CVCB_PTR)smx_SSRExit((u32)cv, SMX_ID_CV_CREATE));
+}
+
+/*
+*  smx_CondVarDelete()   SSR
+*
+*  Deletes a condition variable created by smx_CondVarCreate(). Resumes all
+*  waiting tasks with false return values; they do not own the mutex. Clears
+*  and releases the CVCB and clears its handle.
+*/
+bool smx_CondVarDelete(CVCB_PTR* cvhp)
+{
+   CVCB_PTR cv = (cvhp ? *cvhp : NULL);
+   bool     pass;
+   TCB_PTR  task;
+
+   smx_SSR_ENTER1(SMX_ID_CV_DELETE, cv);  /* record actual handle */
+   smx_EXIT_IF_IN_ISR(SMX_ID_CV_DELETE, false);
+
+   /* verify that cv is valid and that current task has access permission */
+   if (pass = smx_CVCBTest(cv, SMX_PRIV_HI))
+   {
+      while (cv->fl != NULL)  /* clear task queue */
+      {
+         task = smx_DQFTask((CB_PTR)cv);
+         smx_NQRQTask(task);
+         smx_DO_CTTEST();
+         smx_timeout[task->indx] = SMX_TMO_INF;
+         task->rv = false;
+         smx_PUT_RV_IN_EXR0(task)
+      }
+
+      /* clear and release CVCB and set cv handle to nullcb */
+      sb_BlockRel(&smx_cvcbs, (u8*)cv, sizeof(CVCB));
+      *cvhp = NULL;
+   }
+   return((bool)smx_SSRExit(pass, SMX_ID_CV_DELETE));
+}
+
+/*
+*  smx_CondVarSignal()   SSR
+*
+*  Wakes the top task waiting at cv, if any. It gets the bound mutex, if free,
+*  else it is moved to the mutex wait queue. Returns true, if cv is valid.
+*/
+bool smx_CondVarSignal(CVCB_PTR cv)
+{
+   bool pass;
+
+   smx_SSR_ENTER1(SMX_ID_CV_SIGNAL, cv);
+   smx_EXIT_IF_IN_ISR(SMX_ID_CV_SIGNAL, false);
+
+   /* verify that cv is valid and that current task has access permission */
+   if (pass = smx_CVCBTest(cv, SMX_PRIV_LO))
+   {
+      if (cv->fl != NULL)
+         smx_CondVarResume_F(cv);
+   }
+   return((bool)smx_SSRExit(pass, SMX_ID_CV_SIGNAL));
+}
+
+/*
+*  smx_CondVarWait()   SSR
+*
+*  Atomically releases mtx, which ct must own with nesting count == 1, and
+*  waits at cv. Returns true when signaled and mtx has been reacquired. 
+*  Returns false, without mtx, on timeout or cv delete. If timeout == 0,
+*  returns false immediately and ct keeps mtx. All tasks waiting at cv at
+*  the same time must use the same mtx.
+*/
+bool smx_CondVarWait(CVCB_PTR cv, MUCB_PTR mtx, u32 timeout)
+{
+   TCB_PTR  ct = smx_ct;
+
+   smx_SSR_ENTER3(SMX_ID_CV_WAIT, cv, mtx, timeout);
+   smx_EXIT_IF_IN_ISR(SMX_ID_CV_WAIT, false);
+
+   /* verify that cv and mtx are valid and that ct has access permission */
+   if (smx_CVCBTest(cv, SMX_PRIV_LO) && smx_MUCBTest(mtx, SMX_PRIV_LO) &&
+       smx_MutexUmtxAdopt(mtx))
+   {
+      if (mtx->onr == NULL)
+         smx_ERROR_EXIT(SMXE_MTX_ALRDY_FREE, false, 0, SMX_ID_CV_WAIT);
+      if (mtx->onr != ct)
+         smx_ERROR_EXIT(SMXE_MTX_NON_ONR_REL, false, 0, SMX_ID_CV_WAIT);
+      if (mtx->ncnt != 1 || (cv->fl != NULL && cv->mtx != mtx))
+         smx_ERROR_EXIT(SMXE_INV_OP, false, 0, SMX_ID_CV_WAIT);
+
+      if (timeout)
+      {
+         /* release mtx and hand it to the next waiting task, if any */
+         cv->mtx = mtx;
+         mtx->ncnt = 0;
+         smx_MutexRel_F(mtx, ct);
+
+         /* move ct from rq to cv wait queue */
+         smx_DQRQTask(ct);
+         smx_PNQTask((CB_PTR)cv, ct, SMX_CB_CV);
+         smx_TimeoutSet(ct, timeout);
+         smx_sched = SMX_CT_SUSP;
+         smx_lockctr = 0;
+      }
+   }
+   return((bool)smx_SSRExit(false, SMX_ID_CV_WAIT));
+}
+
 /*===========================================================================*
 *                            INTERNAL SUBROUTINES                            *
 *                            Do Not Call Directly                            *
@@ -442,7 +626,7 @@ bool smx_MutexGet_F(MUCB_PTR mtx, u32 timeout)
    TCB_PTR   ct = smx_ct; 
 
    /* verify that mutex is valid and that current task has access permission */
-   if ((pass = smx_MUCBTest(mtx, SMX_PRIV_LO)))
+   if ((pass = smx_MUCBTest(mtx, SMX_PRIV_LO)) && (pass = smx_MutexUmtxAdopt(mtx)))
    {
       if (mtx->onr == NULL) /* mutex is free */
       {
@@ -507,10 +691,66 @@ bool smx_MutexGet_F(MUCB_PTR mtx, u32 timeout)
             pass = false;
          }
       }
+      smx_MutexUmtxSync(mtx);
    }
    return pass;
 }
 
+/*
+*  smx_CondVarResume_F()
+*
+*  Dequeues the top task waiting at cv. If the bound mutex is free, gives it to
+*  the task and resumes the task with true. Otherwise moves the task to the
+*  mutex wait queue, which promotes the mutex owner, if priority inheritance
+*  is enabled. The task's timeout continues to run while it waits there.
+*/
+void smx_CondVarResume_F(CVCB_PTR cv)
+{
+   MUCB_PTR mtx = cv->mtx;
+   TCB_PTR  task;
+
+   task = smx_DQFTask((CB_PTR)cv);
+
+   /* make owner in umode lock word, if any, known to mtx */
+   smx_MutexUmtxAdopt(mtx);
+
+   if (mtx->onr == NULL)   /* mutex is free */
+   {
+      mtx->onr = task;     /* give mutex to task */
+      mtx->ncnt = 1;
+
+      /* link mtx into task's mutex owned list. */
+      if (task->molp != NULL)
+         mtx->molp = task->molp;
+      task->molp = mtx;
+
+      /* promote task priority to mtx ceiling */
+      if (task->pri < mtx->ceil)
+         task->pri = mtx->ceil;
+
+      smx_NQRQTask(task);
+      smx_DO_CTTEST();
+      smx_timeout[task->indx] = SMX_TMO_INF;
+      task->rv = true;
+      smx_PUT_RV_IN_EXR0(task)
+      smx_MutexUmtxSync(mtx);
+   }
+   else
+   {
+      /* wait for mutex without rescheduling task */
+      smx_PNQTask((CB_PTR)mtx, task, SMX_CB_MTX);
+      task->flags.mtx_wait = 1;
+
+      /* priority promotion, if necessary */
+      if (mtx->pi && (task->pri > mtx->onr->pri))
+      {
+         mtx->onr->pri = task->pri;
+         if (mtx->onr->fl != NULL)
+            smx_ReQTask(mtx->onr);
+      }
+   }
+}
+
 /*
 *  smx_MutexGetFast()
 *
@@ -620,6 +860,60 @@ void smx_MutexRelFast(MUCB_PTR mtx)
    smx_SSRExitIF(SMX_HEAP_RETRY);  /* enable preemption */
 }
 
+/*
+*  smx_MutexRel_F()
+*
+*  Releases mtx, which task owns with nesting count already at 0. Removes mtx
+*  from task's MOL and reduces task priority, if it was promoted. Makes the
+*  next waiting task, if any, the new owner. Shared by smx_MutexRel() and
+*  smx_CondVarWait().
+*/
+void smx_MutexRel_F(MUCB_PTR mtx, TCB_PTR task)
+{
+   TCB_PTR  nxt;  /* next task */
+
+   smx_MutexRemFromMOL(mtx, task);
+
+   /* reduce task priority if it was promoted */
+   if (task->pri != task->prinorm)
+      smx_TaskPriAdj(task);
+
+   if (mtx->fl != NULL)             /* If mutex task queue is not empty: */
+   {
+      nxt = (TCB_PTR)mtx->fl;       /* Get next task, nxt. */
+      mtx->onr = nxt;               /* Give the mutex to nxt. */
+      mtx->ncnt = 1;                /* Set nesting count = 1. */
+
+      if (nxt->fl == (CB_PTR)mtx)   /* Dequeue nxt from mutex wait list. <3> */
+         mtx->fl = NULL;
+      else
+      {
+         nxt->fl->bl = nxt->bl;
+         nxt->bl->fl = nxt->fl;
+      }
+
+      /* Link mtx into nxt's mutex owned list. */
+      if (nxt->molp != NULL)
+         mtx->molp = nxt->molp;
+      nxt->molp = mtx;
+
+      /* Promote nxt priority to mtx ceiling. */
+      if (nxt->pri < mtx->ceil)
+         nxt->pri = mtx->ceil;
+
+      nxt->flags.in_prq = 0;
+      nxt->flags.mtx_wait = 0;               /* Reset task's mutex wait flag. */
+      smx_NQRQTask(nxt);                     /* Enqueue nxt into rq. */
+      smx_DO_CTTEST();                       /* Possible preemption. */
+      smx_timeout[nxt->indx] = SMX_TMO_INF;  /* Reset nxt timeout timer. */
+      nxt->rv = true;                        /* Prior smx_MutexGet from nxt has succeeded. */
+      smx_PUT_RV_IN_EXR0(nxt)
+   }
+   else
+      mtx->onr = NULL;              /* Release mutex. */
+   smx_MutexUmtxSync(mtx);
+}
+
 /*
 *  smx_MutexRemFromMOL(mtx)
 *
@@ -652,6 +946,108 @@ void smx_MutexRemFromMOL(MUCB_PTR mtx, TCB_PTR task)
    mtx->molp = NULL; /* <5> */
 }
 
+/*
+*  smx_MutexUmtxAdopt()
+*
+*  If mtx is bound to a umode lock word that was acquired by the umode fast
+*  path, makes the task in the lock word the owner of mtx with nesting count 1.
+*  The claimed owner must be a valid task in the partition bound to the lock
+*  word (mtx->umpt) and have a token for mtx. If not, discards the claim by 
+*  resetting the lock word and returns false, else returns true.
+*/
+bool smx_MutexUmtxAdopt(MUCB_PTR mtx)
+{
+   TCB_PTR  onr;
+   TCB_PTR  tp;
+
+   if (mtx->um == NULL || mtx->onr != NULL)
+      return true;
+   onr = (TCB_PTR)(mtx->um->lock & ~SMX_UMTX_KERN);
+   if (onr == NULL)
+      return true;
+
+   /* verify claimed owner */
+   if (!(onr >= (TCB_PTR)smx_tcbs.pi && onr <= (TCB_PTR)smx_tcbs.px &&
+         onr->cbtype == SMX_CB_TASK && onr->state != SMX_TASK_NULL &&
+         onr->state != SMX_TASK_DEL))
+   {
+      smx_MutexUmtxSync(mtx);
+      smx_ERROR_RET(SMXE_INV_TCB, false, 0);
+   }
+   for (tp = onr; tp->parent != NULL; tp = tp->parent) {}
+   if (tp != mtx->umpt)
+   {
+      smx_MutexUmtxSync(mtx);
+      smx_ERROR_RET(SMXE_TOKEN_VIOL, false, 0);
+   }
+   if (!smx_TOKEN_TEST(onr, (u32)mtx->muhp, SMX_PRIV_LO))
+   {
+      smx_MutexUmtxSync(mtx);
+      return false;
+   }
+
+   /* give mtx to onr and link it into onr's mutex owned list */
+   mtx->onr = onr;
+   mtx->ncnt = 1;
+   if (onr->molp != NULL)
+      mtx->molp = onr->molp;
+   onr->molp = mtx;
+   return true;
+}
+
+/*
+*  smx_MutexUmtxClear()
+*
+*  Resets every umode lock word that task holds via the umode fast path, 
+*  without the kernel knowing. Called from smx_TaskFreeAll() when task is 
+*  deleted. Mutexes that the kernel knows task owns are freed via its MOL.
+*  Only mutexes bound to lock words, in smx_umtxl, are checked.
+*/
+void smx_MutexUmtxClear(TCB_PTR task)
+{
+   MUCB_PTR mtx;
+
+   for (mtx = smx_umtxl; mtx != NULL; mtx = mtx->umlp)
+      if (mtx->onr == NULL && (mtx->um->lock & ~SMX_UMTX_KERN) == (u32)task)
+         smx_MutexUmtxSync(mtx);
+}
+
+/*
+*  smx_MutexUmtxSync()
+*
+*  Updates the umode lock word bound to mtx, if any, from the mutex state. If
+*  mtx is owned, or has a ceiling, sets SMX_UMTX_KERN so that the umode fast
+*  path falls back to the SVC path.
+*/
+void smx_MutexUmtxSync(MUCB_PTR mtx)
+{
+   if (mtx->um != NULL)
+   {
+      if (mtx->onr != NULL)
+         mtx->um->lock = (u32)mtx->onr | SMX_UMTX_KERN;
+      else
+         mtx->um->lock = (mtx->ceil ? SMX_UMTX_KERN : 0);
+   }
+}
+
+/*
+*  smx_MutexUmtxUnlink()
+*
+*  Removes mtx from smx_umtxl, the list of mutexes bound to umode lock words.
+*/
+void smx_MutexUmtxUnlink(MUCB_PTR mtx)
+{
+   MUCB_PTR* mpp;
+
+   for (mpp = &smx_umtxl; *mpp != NULL; mpp = &(*mpp)->umlp)
+      if (*mpp == mtx)
+      {
+         *mpp = mtx->umlp;
+         mtx->umlp = NULL;
+         break;
+      }
+}
+
 /* Notes:
    1. If mutex is not owned, it cannot have a wait queue, either.
    2. Setting mtx->fl to NULL ensures that the mtx ends up cleared and that
@@ -667,4 +1063,28 @@ void smx_MutexRemFromMOL(MUCB_PTR mtx, TCB_PTR task)
       it will proceed normally.
    5. It is known that mtx is owned by this task, hence it is OK to clear its
       molp even if it is not found in the task's MOL.
+   6. A condition variable is bound to the mutex passed to smx_CondVarWait()
+      while tasks are waiting at it. Signal and broadcast move woken tasks
+      directly to the mutex wait queue when the mutex is owned, rather than
+      making them ready only to block again on smx_MutexGet(). Hence, a
+      woken task resumes once, already owning the mutex, and mutex priority
+      inheritance applies to it while it waits for the mutex.
+   7. A umode lock word, UMTX, is put in a partition data region and bound
+      to a mutex by a pmode call to smx_MutexSet(mtx, SMX_ST_UMTX, um, pt).
+      Then smxu_MutexGetU() gets a free mutex with LDREX/STREX on the lock
+      word and smxu_MutexRelU() releases it the same way, both without an SVC.
+      Anything else (nesting, contention, a ceiling, or a failed STREX) goes
+      through the smx_MutexGet()/Rel() SVCs. These, and the condition 
+      variable services, first adopt the owner in the lock word into the 
+      MUCB. The owner must be a task of the partition named in smx_MutexSet()
+      and have a token for mtx, so a partition cannot make a task outside it
+      the owner; an invalid claim is discarded. Tasks that share a lock word
+      can write it, so they must trust each other. smx_TaskFreeAll() resets
+      lock words held by a deleted task that the kernel does not know; it
+      checks only the mutexes in smx_umtxl. While
+      the kernel knows the owner, the lock word holds onr | SMX_UMTX_KERN, so
+      release also goes through the kernel and priority inheritance works
+      normally. Since ARMv7-M/v8-M clear the exclusive monitor on exception
+      entry and return, a kernel update between LDREX and STREX makes the
+      STREX fail.
 */
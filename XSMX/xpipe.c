@@ -34,6 +34,7 @@ void  pktcpy(u8* sp, u8* dp, u32 sz);
 static bool  smx_PipeClear_F(PICB_PTR pipe);
 static void  smx_PipeGetPkt_F(PICB_PTR pipe, u8* pdst);
 static bool  smx_PipeGetPktWait_F(PICB_PTR pipe, void* pdst, u32 timeout);
+static bool  smx_PipePeekWait_F(PICB_PTR pipe, void* pdst, u32 timeout);
 static void  smx_PipePutPkt_F(PICB_PTR pipe, u8* psrc, SMX_PIPE_MODE mode=SMX_PUT_TO_BACK);
 static bool  smx_PipePutPktWait_F(PICB_PTR pipe, void* psrc, u32 timeout, SMX_PIPE_MODE mode=SMX_PUT_TO_BACK);
 static bool  smx_PipeResume_F(PICB_PTR pipe);
@@ -73,7 +74,7 @@ bool smx_PipeClear(PICB_PTR pipe)
 *  are not valid or cannot get a PICB, does an error exit and returns
 *  NULL. Else returns pipe handle.
 */
-PICB_PTR smx_PipeCreate(void* ppb, u8 width, u16 length, const char* name, PICB_PTR* php)
+PICB_PTR smx_PipeCreate(void* ppb, u16 width, u16 length, const char* name, PICB_PTR* php)
 {
    PICB_PTR p;
 
@@ -94,7 +95,6 @@ PICB_PTR smx_PipeCreate(void* ppb, u8 width, u16 length, const char* name, PICB_
       p->cbtype = SMX_CB_PIPE;
       p->flags.full = 0;
       p->width = width;
-      p->length = length;
       p->bi = p->rp = p->wp = (u8 *)ppb;
       p->bx = (u8 *)ppb + (length-1)*width;
       p->php = php;
@@ -266,6 +266,33 @@ bool smx_PipeGetPktWait(PICB_PTR pipe, void* pdst, u32 timeout)
    return((bool)smx_SSRExit(gotpkt, SMX_ID_PIPE_GET_PKT_WAIT));
 }
 
+/*
+*  smx_PipePeekWait()   SSR
+*
+*  Copies the oldest packet in pipe to pdst without removing it, and returns
+*  true. If pipe is empty, waits up to timeout for a packet <3>. Aborts if
+*  called from LSR and tmo != SMX_TMO_NOWAIT. Clears lockctr if called from
+*  a task and tmo != SMX_TMO_NOWAIT.
+*/
+bool smx_PipePeekWait(PICB_PTR pipe, void* pdst, u32 timeout)
+{
+   bool  gotpkt = false;
+
+   smx_SSR_ENTER3(SMX_ID_PIPE_PEEK_WAIT, pipe, pdst, timeout);
+   smx_EXIT_IF_IN_ISR(SMX_ID_PIPE_PEEK_WAIT, false);
+   if (!(smx_clsr && timeout))
+   {
+      gotpkt = smx_PipePeekWait_F(pipe, pdst, timeout);
+      if (gotpkt == false && timeout)
+         smx_sched = SMX_CT_SUSP;
+      if (timeout)
+         smx_lockctr = 0;
+   }
+   else
+      smx_ERROR(SMXE_WAIT_NOT_ALLOWED, 0);
+   return((bool)smx_SSRExit(gotpkt, SMX_ID_PIPE_PEEK_WAIT));
+}
+
 /*
 *  smx_PipeGetPktWaitStop()   SSR
 *
@@ -494,7 +521,7 @@ u32 smx_PipePeek(PICB_PTR pipe, SMX_PK_PAR par)
             val = pipe->width;
             break;
          case SMX_PK_LENGTH:
-            val = pipe->length;
+            val = (pipe->bx - pipe->bi)/pipe->width + 1;
             break;
          case SMX_PK_NUMPKTS:
             sb_INT_DISABLE();
@@ -502,7 +529,7 @@ u32 smx_PipePeek(PICB_PTR pipe, SMX_PK_PAR par)
             wp = pipe->wp;
             sb_INT_ENABLE();
             if (rp == wp && pipe->flags.full)
-               val = pipe->length;
+               val = (pipe->bx - pipe->bi)/pipe->width + 1;
             else if (rp <= wp)
                val = (wp - rp)/pipe->width;
             else
@@ -578,6 +605,7 @@ static bool smx_PipeClear_F(PICB_PTR pipe)
       t->rv = false;
       t->flags.pipe_put   = 0;
       t->flags.pipe_front = 0;
+      t->flags.pipe_peek  = 0;
       smx_NQRQTask(t);
       smx_DO_CTTEST();
       smx_timeout[t->indx] = SMX_TMO_INF;
@@ -670,6 +698,54 @@ static bool smx_PipeGetPktWait_F(PICB_PTR pipe, void* pdst, u32 timeout)
          smx_PNQTask((CB_PTR)pipe, ct, SMX_CB_PIPE);
          ct->sv = (u32)pdst;     /* save buffer pointer */
          ct->flags.pipe_put = 0; /* get */
+         ct->flags.pipe_peek = 0;
+         smx_TimeoutSet(ct, timeout);
+      }
+   }
+   return(gotpkt);
+}
+
+/*
+*  smx_PipePeekWait_F()
+*
+*  If a task is waiting to put a packet to the front of a full pipe, copies
+*  its pkt to pdst, since a get would get it next. Otherwise, if pipe is not
+*  empty, copies front pkt to pdst. In both cases, nothing is removed. If pipe
+*  is empty and if timeout, suspends ctask on pipe as a peek, saving pdst in
+*  smx_ct->sv. Called by smx_PipePeekWait().
+*/
+static bool smx_PipePeekWait_F(PICB_PTR pipe, void* pdst, u32 timeout)
+{
+   TCB_PTR  ct     = smx_ct;  /* current task */
+   bool  gotpkt;           /* got pkt */
+
+   /* verify that pipe is valid and that current task has access permission */
+   if (gotpkt = smx_PICBTest(pipe, SMX_PRIV_LO))
+   {
+      gotpkt = false;
+      if (!pdst)
+         smx_ERROR_RET(SMXE_INV_PAR, false, 0);
+
+      if (pipe->fl && pipe->fl->flags.pipe_put && pipe->fl->flags.pipe_front)
+      {
+         /* copy pkt of waiting front put */
+         memcpy(pdst, (u8*)pipe->fl->sv, pipe->width);
+         gotpkt = true;
+      }
+      else if (!smx_PIPE_EMPTY(pipe, pipe->rp))
+      {
+         /* copy first pkt in pipe */
+         pktcpy(pipe->rp, (u8*)pdst, pipe->width);
+         gotpkt = true;
+      }
+      else if (timeout)
+      {
+         /* suspend ct on pipe */
+         smx_DQRQTask(ct);
+         smx_PNQTask((CB_PTR)pipe, ct, SMX_CB_PIPE);
+         ct->sv = (u32)pdst;     /* save buffer pointer */
+         ct->flags.pipe_put = 0;
+         ct->flags.pipe_peek = 1;
          smx_TimeoutSet(ct, timeout);
       }
    }
@@ -738,6 +814,20 @@ static bool smx_PipePutPktWait_F(PICB_PTR pipe, void *psrc, u32 timeout, SMX_PIP
       if (!psrc)
          smx_ERROR_RET(SMXE_INV_PAR, false, 0);
 
+      /* give copies of pkt to tasks ahead of any get waiting to peek <3> */
+      while (pipe->fl && !pipe->fl->flags.pipe_put && pipe->fl->flags.pipe_peek)
+      {
+         wtask = smx_DQFTask((CB_PTR)pipe);
+         memcpy((void*)wtask->sv, psrc, (size_t)pipe->width);
+         wtask->sv = 0;
+         wtask->flags.pipe_peek = 0;
+         smx_NQRQTask(wtask);
+         smx_DO_CTTEST();
+         smx_timeout[wtask->indx] = SMX_TMO_INF;
+         wtask->rv = true;
+         smx_PUT_RV_IN_EXR0(wtask)
+      }
+
       /* test if wtask is waiting on pipe to get pkt */
       if (pipe->fl && !pipe->fl->flags.pipe_put)
       {
@@ -808,7 +898,14 @@ bool smx_PipeResume_F(PICB_PTR pipe)
       }
       else if (!smx_PIPE_EMPTY(pipe, pipe->rp))
       {
-         smx_PipeGetPkt_F(pipe, (u8*)wtask->sv);
+         if (wtask->flags.pipe_peek)
+         {
+            /* copy pkt and leave it in pipe */
+            pktcpy(pipe->rp, (u8*)wtask->sv, pipe->width);
+            wtask->flags.pipe_peek = 0;
+         }
+         else
+            smx_PipeGetPkt_F(pipe, (u8*)wtask->sv);
          pass = true;
       }
    }
@@ -858,4 +955,8 @@ void pktcpy(u8* sp, u8* dp, u32 sz)
 /* Notes:
    1. If wtask = NULL, all wtask flags == 0.
    2. All tasks in a pipe queue must be either gets or puts.
+   3. A peek waits with the gets, in priority order. A put gives copies of
+      its pkt to the peeks ahead of the first get, then gives it to that get
+      or puts it into the pipe, as usual. So a peek never removes a pkt, and
+      a pkt taken by a higher priority get is not seen by peeks behind it.
 */
\ No newline at end of file
@@ -257,6 +257,9 @@ dispatch_next_task:
          /* resume leg */
          sb_INT_DISABLE();     /* make task + stack switch atomic */
          smx_ct = smx_ctnew;   /* switch to new task */
+        #if SMX_CFG_SSMX
+         smxu_ct = smx_ct;
+        #endif
          smx_SWITCH_STACKS();
          sb_INT_ENABLE();
 
@@ -363,6 +366,9 @@ dispatch_next_task:
          }
 
          smx_ct = smx_ctnew;              /* switch to new task */
+        #if SMX_CFG_SSMX
+         smxu_ct = smx_ct;
+        #endif
 
          /* select autostop function */
          #if SMX_CFG_SSMX
@@ -28,15 +28,27 @@
 
 #include "xsmx.h"
 
+#if SMX_SIZE_SEMRD
+#define SMX_SEM_MODE_MAX   SMX_SEM_WRTR
+#define smx_SEM_WR(sem)    ((SCB_PTR)((u32)(sem) | 1))  /* write access slot <1> */
+#else
+#define SMX_SEM_MODE_MAX   SMX_SEM_GATE  /* no RDR and WRTR modes */
+#endif
+
 /* internal subroutines */
 static bool smx_SemClear_F(SCB_PTR sem);
 static bool smx_SemTest_F(SCB_PTR sem, u32 timeout);
+#if SMX_SIZE_SEMRD
+static void smx_SemRWResume(SCB_PTR sem);
+static SCB_PTR* smx_SemSlot(TCB_PTR task, SCB_PTR sem);
+#endif
 
 /*
 *  smx_SemClear()   SSR
 *
 *  Clears a semaphore by resuming all waiting tasks with NULL return values,
-*  and sets count = 0 for EVENT, THRES, & GATE, and = lim for RSRC semaphores.
+*  and sets count = 0 for EVENT, THRES, GATE, RDR, & WRTR, and = lim for RSRC
+*  semaphores. Also clears the writer owner of RDR and WRTR semaphores.
 *  Returns true, if successful.
 */
 bool smx_SemClear(SCB_PTR sem)
@@ -54,6 +66,7 @@ bool smx_SemClear(SCB_PTR sem)
          sem->count = sem->lim;
       else
          sem->count = 0;
+      sem->onr = NULL;
    }
    return((bool)smx_SSRExit(pass, SMX_ID_SEM_CLEAR));
 }
@@ -63,12 +76,12 @@ bool smx_SemClear(SCB_PTR sem)
 *
 *  Allocates a semaphore control block from the SCB pool and initializes it.
 *  If parameters are invalid or allocation fails because no block is available,
-*  returns NULL. Otherwise returns semaphore handle.
+*  returns NULL. Otherwise returns semaphore handle. RDR and WRTR modes are
+*  invalid if SMX_SIZE_SEMRD == 0.
 */
-SCB_PTR smx_SemCreate(SMX_SEM_MODE mode, u8 lim, const char* name, SCB_PTR* shp)
+SCB_PTR smx_SemCreate(SMX_SEM_MODE mode, u32 lim, const char* name, SCB_PTR* shp)
 {
    SCB_PTR sp;
-   u32 *p, count = 0;
 
    smx_SSR_ENTER4(SMX_ID_SEM_CREATE, mode, lim, name, shp);
    smx_EXIT_IF_IN_ISR(SMX_ID_SEM_CREATE, NULL);
@@ -77,8 +90,9 @@ SCB_PTR smx_SemCreate(SMX_SEM_MODE mode, u8 lim, const char* name, SCB_PTR* shp)
    if ((sp = (SCB_PTR)smx_ObjectCreateTestH((u32*)shp)) && !smx_errno)
    {
       /* check parameters */
-      if (mode > SMX_SEM_WRTR || ((mode == SMX_SEM_RSRC || mode == SMX_SEM_THRES)
-            && lim < 1) || (mode == SMX_SEM_GATE && lim != 1))
+      if (mode > SMX_SEM_MODE_MAX || ((mode == SMX_SEM_RSRC || mode == SMX_SEM_THRES ||
+            mode == SMX_SEM_RDR || mode == SMX_SEM_WRTR) && lim < 1) || 
+            (mode == SMX_SEM_GATE && lim != 1))
          smx_ERROR_EXIT(SMXE_INV_PAR, NULL, 0, SMX_ID_SEM_CREATE);
 
       /* get a semaphore control block */
@@ -86,17 +100,13 @@ SCB_PTR smx_SemCreate(SMX_SEM_MODE mode, u8 lim, const char* name, SCB_PTR* shp)
          smx_ERROR_EXIT(SMXE_OUT_OF_SCBS, NULL, 0, SMX_ID_SEM_CREATE);
 
       /* Initialize SCB */
-      p = (u32*)sp + 2;
-      if (mode == SMX_SEM_RSRC)
-         count = lim;
-
-     #if __LITTLE_ENDIAN__
-      *p = lim << 24 | count << 16 | mode << 8 | SMX_CB_SEM;
-     #else
-      *p = SMX_CB_SEM << 24 | mode << 16 | count << 8 | lim;
-     #endif
-
+      sp->cbtype = SMX_CB_SEM;
+      sp->mode = mode;
+      sp->count = (mode == SMX_SEM_RSRC ? lim : 0);
+      sp->lim = lim;
       sp->shp = shp;
+      sp->onr = NULL;
+      sp->wrtrs = 0;
       if (name && *name)
          sp->name = name;
 
@@ -164,6 +174,9 @@ u32 smx_SemPeek(SCB_PTR sem, SMX_PK_PAR par)
          case SMX_PK_LIMIT:
             val = (u32)sem->lim;
             break;
+         case SMX_PK_ONR:
+            val = (u32)sem->onr;
+            break;
          case SMX_PK_NAME:
             val = (u32)sem->name;
             break;
@@ -219,17 +232,25 @@ bool smx_SemSet(SCB_PTR sem, SMX_ST_PAR par, u32 v1, u32 v2)
 *  EVENT mode:
 *     resumes first waiting task with true; else:
 *        for lim == 1 and count < lim, count++; else:
-*           for if count < 255, count++, else: SMXE_SEM_CTR_OVFL error.
+*           for if count < 0xFFFFFFFF, count++, else: SMXE_SEM_CTR_OVFL error.
 *  THRES mode:
 *     if task waiting and count >= (lim - 1): count - (lim - 1) and resume task
-*     with true; else if count < 0xFF, count++; else SMXE_SEM_CTR_OVFL error.
+*     with true; else if count < 0xFFFFFFFF, count++; else SMXE_SEM_CTR_OVFL 
+*     error.
 *  GATE mode:
 *     resume all waiting tasks with true
+*  RDR and WRTR modes:
+*     if ct is writer owner, releases write access, else if ct holds read 
+*     access, releases one read access (count--), else SMXE_INV_OP error. 
+*     Then resumes waiting tasks that can now get access <1>.
 */
 bool smx_SemSignal(SCB_PTR sem)
 {
    bool     pass;
    TCB_PTR  task;
+  #if SMX_SIZE_SEMRD
+   SCB_PTR* rp;
+  #endif
    bool     dq = false;
 
    smx_SSR_ENTER1(SMX_ID_SEM_SIGNAL, sem);
@@ -238,6 +259,28 @@ bool smx_SemSignal(SCB_PTR sem)
    /* verify that sem is valid and that current task has access permission */
    if (pass = smx_SCBTest(sem, SMX_PRIV_LO))
    {
+     #if SMX_SIZE_SEMRD
+      if (sem->mode == SMX_SEM_RDR || sem->mode == SMX_SEM_WRTR)
+      {
+         /* release write or read access held by ct */
+         if (sem->onr != NULL && sem->onr == smx_ct && !smx_clsr)
+         {
+            sem->onr = NULL;
+            if ((rp = smx_SemSlot(smx_ct, smx_SEM_WR(sem))) != NULL)
+               *rp = NULL;
+         }
+         else if (!smx_clsr && (rp = smx_SemSlot(smx_ct, sem)) != NULL)
+         {
+            *rp = NULL;
+            sem->count--;
+         }
+         else
+            smx_ERROR_EXIT(SMXE_INV_OP, false, 0, SMX_ID_SEM_SIGNAL);
+         if (sem->fl != NULL)
+            smx_SemRWResume(sem);
+      }
+      else
+     #endif
       if (sem->fl == 0) /* no task waiting */
       {
          switch (sem->mode)
@@ -256,7 +299,7 @@ bool smx_SemSignal(SCB_PTR sem)
                }
 
             case SMX_SEM_THRES: /* non-binary event or threshold semaphore */
-               if ((sem->count < 0xFF))
+               if ((sem->count < 0xFFFFFFFF))
                   sem->count++;
                else
                   smx_ERROR_EXIT(SMXE_SEM_CTR_OVFL, false, 0, SMX_ID_SEM_SIGNAL);
@@ -301,6 +344,114 @@ bool smx_SemSignal(SCB_PTR sem)
    return((bool)smx_SSRExit(pass, SMX_ID_SEM_SIGNAL));
 }
 
+/*
+*  smx_SemSignalN()   SSR
+*
+*  Same as n calls to smx_SemSignal(), in one pass. Tasks are resumed in queue
+*  order. If SCB is not valid, or if SMX_CFG_TOKENS and ct does not have access
+*  token, returns false, else executes. Callable from LSRs.
+*
+*  RSRC and EVENT modes:
+*     resumes up to n waiting tasks with true and adds the remainder to count.
+*     RSRC and binary EVENT counts stop at lim, with no error. For non-binary
+*     EVENT, reports SMXE_SEM_CTR_OVFL if count would exceed 0xFFFFFFFF.
+*  THRES mode:
+*     adds n to count, then while a task is waiting and count >= lim, 
+*     count - lim and resumes the first task with true.
+*  GATE mode:
+*     if n > 0, resumes all waiting tasks with true.
+*  RDR and WRTR modes:
+*     not allowed; reports SMXE_WRONG_MODE.
+*/
+bool smx_SemSignalN(SCB_PTR sem, u32 n)
+{
+   bool     pass;
+   TCB_PTR  task;
+   bool     rdy = false;
+
+   smx_SSR_ENTER2(SMX_ID_SEM_SIGNAL_N, sem, n);
+   smx_EXIT_IF_IN_ISR(SMX_ID_SEM_SIGNAL_N, false);
+
+   /* verify that sem is valid and that current task has access permission */
+   if (pass = smx_SCBTest(sem, SMX_PRIV_LO))
+   {
+      switch (sem->mode)
+      {
+         case SMX_SEM_RSRC:
+         case SMX_SEM_EVENT:
+            /* resume up to n waiting tasks */
+            for (; n > 0 && sem->fl != NULL; n--)
+            {
+               task = smx_DQFTask((CB_PTR)sem);
+               smx_NQRQTask(task);
+               smx_timeout[task->indx] = SMX_TMO_INF;
+               task->rv = true;
+               smx_PUT_RV_IN_EXR0(task)
+               rdy = true;
+            }
+            /* add remainder to count */
+            if (sem->mode == SMX_SEM_RSRC || sem->lim == 1)
+            {
+               if (n > sem->lim - sem->count)
+                  sem->count = sem->lim;
+               else
+                  sem->count += n;
+            }
+            else if (n <= 0xFFFFFFFF - sem->count)
+               sem->count += n;
+            else
+            {
+               sem->count = 0xFFFFFFFF;
+               smx_ERROR(SMXE_SEM_CTR_OVFL, 0);
+               pass = false;
+            }
+            break;
+
+         case SMX_SEM_THRES:
+            if (n > 0xFFFFFFFF - sem->count)
+               smx_ERROR_EXIT(SMXE_SEM_CTR_OVFL, false, 0, SMX_ID_SEM_SIGNAL_N);
+            sem->count += n;
+            while (sem->fl != NULL && sem->count >= sem->lim)
+            {
+               sem->count -= sem->lim;
+               task = smx_DQFTask((CB_PTR)sem);
+               smx_NQRQTask(task);
+               smx_timeout[task->indx] = SMX_TMO_INF;
+               task->rv = true;
+               smx_PUT_RV_IN_EXR0(task)
+               rdy = true;
+            }
+            break;
+
+         case SMX_SEM_GATE:
+            while (n > 0 && sem->fl != NULL)  /* resume all tasks */
+            {
+               task = smx_DQFTask((CB_PTR)sem);
+               smx_NQRQTask(task);
+               smx_timeout[task->indx] = SMX_TMO_INF;
+               task->rv = true;
+               smx_PUT_RV_IN_EXR0(task)
+               rdy = true;
+            }
+            break;
+
+         case SMX_SEM_RDR:
+         case SMX_SEM_WRTR:
+            smx_ERROR_EXIT(SMXE_WRONG_MODE, false, 0, SMX_ID_SEM_SIGNAL_N);
+
+         default:
+            smx_ERROR_EXIT(SMXE_INV_SCB, false, 0, SMX_ID_SEM_SIGNAL_N);
+      }
+      if (rdy)
+         smx_DO_CTTEST();
+
+      /* callback */
+      if (sem->cbfun)
+         sem->cbfun((u32)sem);
+   }
+   return((bool)smx_SSRExit(pass, SMX_ID_SEM_SIGNAL_N));
+}
+
 /*
 *  smx_SemTest()   SSR
 *
@@ -325,6 +476,67 @@ bool smx_SemTest(SCB_PTR sem, u32 timeout)
    return((bool)smx_SSRExit(pass, SMX_ID_SEM_TEST));
 }
 
+/*
+*  smx_SemTestWrtr()   SSR
+*
+*  Gets write access to a RDR or WRTR semaphore for ct. Access is granted if
+*  there are no readers (count == 0) and no writer owner. ct then becomes the 
+*  writer owner until it calls smx_SemSignal(). Otherwise, if timeout > 0, ct
+*  waits at sem in priority order with readers. Read access is obtained with
+*  smx_SemTest(). Not permitted from LSRs. Clears lockctr if timeout !=
+*  SMX_TMO_NOWAIT. Write access takes one of ct's SMX_SIZE_SEMRD slots; 
+*  SMXE_INV_OP error if there is none.
+*/
+bool smx_SemTestWrtr(SCB_PTR sem, u32 timeout)
+{
+   TCB_PTR  ct = smx_ct;
+   bool     pass;
+  #if SMX_SIZE_SEMRD
+   SCB_PTR* rp;
+  #endif
+
+   smx_SSR_ENTER2(SMX_ID_SEM_TEST_WRTR, sem, timeout);
+   smx_EXIT_IF_IN_ISR(SMX_ID_SEM_TEST_WRTR, false);
+
+   if (smx_clsr)
+      smx_ERROR_EXIT(SMXE_OP_NOT_ALLOWED, false, 0, SMX_ID_SEM_TEST_WRTR);
+
+   /* verify that sem is valid and that current task has access permission */
+   if (pass = smx_SCBTest(sem, SMX_PRIV_LO))
+   {
+      if (!(sem->mode == SMX_SEM_RDR || sem->mode == SMX_SEM_WRTR))
+         smx_ERROR_EXIT(SMXE_WRONG_MODE, false, 0, SMX_ID_SEM_TEST_WRTR);
+
+     #if SMX_SIZE_SEMRD
+      if ((rp = smx_SemSlot(ct, NULL)) == NULL)
+         smx_ERROR_EXIT(SMXE_INV_OP, false, 0, SMX_ID_SEM_TEST_WRTR);
+
+      if (timeout > 0)
+         smx_lockctr = 0;
+
+      if (sem->onr == NULL && sem->count == 0)
+      {
+         *rp = smx_SEM_WR(sem);
+         sem->onr = ct;
+      }
+      else
+      {
+         pass = false;
+         if (timeout)
+         {
+            smx_sched = SMX_CT_SUSP;
+            smx_DQRQTask(ct);
+            smx_PNQTask((CB_PTR)sem, ct, SMX_CB_SEM);
+            ct->flags.sem_wrtr = 1;
+            sem->wrtrs++;
+            smx_TimeoutSet(ct, timeout);
+         }
+      }
+     #endif
+   }
+   return((bool)smx_SSRExit(pass, SMX_ID_SEM_TEST_WRTR));
+}
+
 /*
 *  smx_SemTestStop()   SSR
 *
@@ -361,6 +573,11 @@ void smx_SemTestStop(SCB_PTR sem, u32 timeout)
 *  If semaphore mode is:
 *     RSRC, EVENT, or GATE mode: if count > 0, count-- else pass = false.
 *     THRES mode: if count >= lim, count - lim else pass = false.
+*     RDR mode: read access. If no writer owner and count < lim, count++ 
+*        and record sem in ct's read slots, else pass = false. Not permitted
+*        from LSRs. SMXE_INV_OP error if ct already holds SMX_SIZE_SEMRD accesses.
+*     WRTR mode: same as RDR mode, except pass = false if a writer is
+*        waiting, so new readers cannot pass it.
 *     Invalid mode: report SMXE_INV_SCB and return false.
 *  If pass == false and timeout > 0, move ct to sem wait queue.
 *  Return pass.
@@ -369,6 +586,9 @@ void smx_SemTestStop(SCB_PTR sem, u32 timeout)
 static bool smx_SemTest_F(SCB_PTR sem, u32 timeout)
 {
    TCB_PTR  ct = smx_ct; /* globals optimization */
+  #if SMX_SIZE_SEMRD
+   SCB_PTR* rp;
+  #endif
    bool     pass;
 
    /* verify that sem is valid and that current task has access permission */
@@ -387,10 +607,27 @@ static bool smx_SemTest_F(SCB_PTR sem, u32 timeout)
             break;
          case SMX_SEM_THRES:
             if (sem->count >= sem->lim)
-               sem->count -= (u8)sem->lim;
+               sem->count -= sem->lim;
             else
                pass = false;
             break;
+        #if SMX_SIZE_SEMRD
+         case SMX_SEM_RDR:
+         case SMX_SEM_WRTR:
+            if (smx_clsr)
+               smx_ERROR_RET(SMXE_OP_NOT_ALLOWED, false, 0);
+            if ((rp = smx_SemSlot(ct, NULL)) == NULL)
+               smx_ERROR_RET(SMXE_INV_OP, false, 0);
+            if (sem->onr == NULL && sem->count < sem->lim &&
+                !(sem->mode == SMX_SEM_WRTR && sem->wrtrs > 0))
+            {
+               *rp = sem;
+               sem->count++;
+            }
+            else
+               pass = false;
+            break;
+        #endif
          default:
             smx_ERROR_RET(SMXE_INV_SCB, false, 0);
       }
@@ -409,17 +646,119 @@ static bool smx_SemTest_F(SCB_PTR sem, u32 timeout)
    return pass;
 }
 
+#if SMX_SIZE_SEMRD
+/*
+*  smx_SemRWResume()
+*
+*  Resumes tasks waiting at RDR or WRTR semaphore sem that can get access, in
+*  priority order, with true. A waiting writer (flags.sem_wrtr) becomes
+*  writer owner if there are no readers; this stops the scan. Waiting readers
+*  are resumed while count < lim and there is no writer owner. For WRTR mode,
+*  the scan also stops at the first writer that cannot get access, so that
+*  readers do not pass it.
+*/
+static void smx_SemRWResume(SCB_PTR sem)
+{
+   TCB_PTR  t;
+   TCB_PTR  n;
+   SCB_PTR* rp;
+   bool     wrtr;
+
+   for (t = sem->fl; t != NULL && t->cbtype == SMX_CB_TASK && sem->onr == NULL; t = n)
+   {
+      n = (TCB_PTR)t->fl;
+      wrtr = t->flags.sem_wrtr;
+      if (wrtr && sem->count == 0 && (rp = smx_SemSlot(t, NULL)) != NULL)
+      {
+         *rp = smx_SEM_WR(sem);
+         sem->onr = t;
+         t->flags.sem_wrtr = 0;
+         sem->wrtrs--;
+      }
+      else if (!wrtr && sem->count < sem->lim && (rp = smx_SemSlot(t, NULL)) != NULL)
+      {
+         *rp = sem;
+         sem->count++;
+      }
+      else if (wrtr && sem->mode == SMX_SEM_RDR)
+         continue;  /* reader preference: skip writer */
+      else
+         break;
+
+      smx_DQTask(t);
+      smx_NQRQTask(t);
+      smx_timeout[t->indx] = SMX_TMO_INF;
+      t->rv = true;
+      smx_PUT_RV_IN_EXR0(t)
+   }
+   smx_DO_CTTEST();
+}
+
+/*
+*  smx_SemSlot()
+*
+*  Returns a pointer to the first of task's access slots that holds sem, or 
+*  to the first free slot if sem == NULL. Pass smx_SEM_WR(sem) to find write
+*  access. Returns NULL if there is none.
+*/
+static SCB_PTR* smx_SemSlot(TCB_PTR task, SCB_PTR sem)
+{
+   SCB_PTR* rp = smx_semrd[task->indx];
+   SCB_PTR* rx = rp + SMX_SIZE_SEMRD;
+
+   for (; rp < rx; rp++)
+      if (*rp == sem)
+         return rp;
+   return NULL;
+}
+
+/*
+*  smx_SemRelAll_F()
+*
+*  Releases all read and write accesses that task holds to RDR and WRTR
+*  semaphores and resumes waiting tasks that can now get access. Called from
+*  smx_TaskFreeAll(), so a deleted task does not block writers forever. Only
+*  task's own slots are scanned.
+*/
+void smx_SemRelAll_F(TCB_PTR task)
+{
+   SCB_PTR  sem;
+   SCB_PTR* rp = smx_semrd[task->indx];
+   SCB_PTR* rx = rp + SMX_SIZE_SEMRD;
+
+   for (; rp < rx; rp++)
+   {
+      if ((sem = *rp) != NULL)
+      {
+         *rp = NULL;
+         if ((u32)sem & 1)  /* write access */
+         {
+            sem = (SCB_PTR)((u32)sem & ~1u);
+            sem->onr = NULL;
+         }
+         else               /* read access */
+            sem->count--;
+         if (sem->fl != NULL)
+            smx_SemRWResume(sem);
+      }
+   }
+}
+#endif /* SMX_SIZE_SEMRD */
 
 /*
 *  smx_SemClear_F()
 *
-*  Resumes all tasks waiting at sem, with NULL return values. Returns true, if
+*  Resumes all tasks waiting at sem, with NULL return values. For RDR and WRTR
+*  semaphores, also removes sem from all tasks' access slots. Returns true, if
 *  successful.
 */
 static bool smx_SemClear_F(SCB_PTR sem)
 {
    bool     pass;
    TCB_PTR  task = NULL;
+  #if SMX_SIZE_SEMRD
+   SCB_PTR* rp;
+  #endif
 
    /* verify that sem is valid and that current task has access permission */
    if (pass = smx_SCBTest(sem, SMX_PRIV_HI))
@@ -430,7 +769,32 @@ static bool smx_SemClear_F(SCB_PTR sem)
          smx_NQRQTask(task);
          smx_DO_CTTEST();
          smx_timeout[task->indx] = SMX_TMO_INF;
+         task->flags.sem_wrtr = 0;
       }
+      sem->wrtrs = 0;
+     #if SMX_SIZE_SEMRD
+      if (sem->mode == SMX_SEM_RDR || sem->mode == SMX_SEM_WRTR)
+         for (rp = &smx_semrd[0][0]; rp < &smx_semrd[0][0] + SMX_NUM_TASKS*SMX_SIZE_SEMRD; rp++)
+            if (*rp == sem || *rp == smx_SEM_WR(sem))
+               *rp = NULL;
+     #endif
    }
    return pass;
-}
\ No newline at end of file
+}
+
+/* Notes:
+   1. RDR and WRTR semaphores are reader/writer locks. smx_SemTest() gets
+      read access and smx_SemTestWrtr() gets write access; smx_SemSignal()
+      releases either. lim is the maximum number of concurrent readers.
+      Waiting readers and writers share the priority-ordered sem queue; 
+      flags.sem_wrtr marks writers and sem->wrtrs counts them, so a WRTR
+      read test need not scan the queue. smx_DQTask() decrements wrtrs when
+      a writer leaves by timeout, stop, or delete. A writer that times out
+      does not resume readers blocked behind it; they are resumed by the 
+      next smx_SemSignal(). Each read or write access is recorded in one of
+      the task's SMX_SIZE_SEMRD slots in smx_semrd[], write access as sem|1
+      (smx_SEM_WR()), so smx_SemSignal() releases only access that ct actually
+      holds, and task delete scans only the task's own slots. If
+      SMX_SIZE_SEMRD == 0, RDR and WRTR modes and smx_semrd[] are compiled
+      out.
+*/
\ No newline at end of file
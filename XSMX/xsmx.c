@@ -221,14 +221,16 @@ void smx_DQRQTask(TCB_PTR t)
 *
 *  Dequeue task t from whatever queue it may be in:
 *  Event Queue: Add the diff count to the next task's diff count, if there is
-*               one, and clear flags.in_eq.
+*               one, and clear flags.in_eq. With count buckets (SMX_SIZE_EQ_WHEEL),
+*               sv holds an absolute count, so other tasks need no adjustment.
 *  RQ: Do like smx_DQRQTask.
 *  Alter the tq field only if RQ, XCB, or EVCB.
 *  Clears task->sv. This function is called by functions such as smx_TaskStop(),
 *  smx_TaskStart(), smx_TaskResume(), which can operate on a task waiting
 *  anywhere, such as an event queue or a pipe, so we need to clear sv. If task
 *  is in a mutex queue, mutex owner is demoted if task promoted it, and priority
-*  change is propagated, if necessary. 
+*  change is propagated, if necessary. If task is a writer waiting at a RDR or
+*  WRTR semaphore, the semaphore's waiting writer count is decremented.
 *
 *  Note: Do not use this to dequeue and requeue a task. Instead call
 *        smx_TaskRequeue().
@@ -237,12 +239,27 @@ void smx_DQTask(TCB_PTR t)
 {
    CB_PTR q = t->bl; /* save t->bl before t is dequeued */
 
+   #if SMX_SIZE_EQ_WHEEL
+   t->flags.in_eq = 0;
+   #else
    if (t->flags.in_eq == 1)
    {
       if (((TCB_PTR)t->fl)->cbtype == SMX_CB_TASK)
           ((TCB_PTR)t->fl)->sv += t->sv;
       t->flags.in_eq = 0;
    }
+   #endif
+
+   #if SMX_SIZE_SEMRD
+   /* if t is a waiting writer, find its sem and count one fewer writer */
+   if (t->flags.sem_wrtr && t->fl != NULL)
+   {
+      CB_PTR h;
+      for (h = t->fl; h->cbtype == SMX_CB_TASK; h = (CB_PTR)h->fl){}
+      ((SCB_PTR)h)->wrtrs--;
+      t->flags.sem_wrtr = 0;
+   }
+   #endif
    if (t->fl == t->bl) /* only task in queue */
    {
       if ((t->fl >= (CB_PTR)smx_xcbs.pi) && (t->fl <= (CB_PTR)smx_xcbs.px))
@@ -553,6 +570,17 @@ bool smx_BCBTest(BCB_PTR blk, bool priv)
    return(smx_TOKEN_TEST(smx_ct, (u32)blk->bhp, priv));
 }
 
+bool smx_CVCBTest(CVCB_PTR cv, bool priv)
+{
+   if (!(cv != 0 && cv >= (CVCB_PTR)smx_cvcbs.pi && cv <= (CVCB_PTR)smx_cvcbs.px &&
+         cv->cbtype == SMX_CB_CV))
+   {
+      smx_ct->flags.tok_ok = 1;  /*<1>*/
+      smx_ERROR_RET(SMXE_INV_CVCB, false, 0);
+   }
+   return(smx_TOKEN_TEST(smx_ct, (u32)cv->cvhp, priv));
+}
+
 bool smx_EGCBTest(EGCB_PTR eg, bool priv)
 {
    if (!(eg != 0 && eg >= (EGCB_PTR)smx_egcbs.pi && eg <= (EGCB_PTR)smx_egcbs.px &&
@@ -807,6 +835,12 @@ bool smx_CBPoolsCreate(void)
                                                       sizeof(BCB), "smx_bcbs");
    #endif
 
+   #if SMX_NUM_CVS
+   static CVCB cvcb_pool[SMX_NUM_CVS];
+   pass &= sb_BlockPoolCreate((u8*)&cvcb_pool, &smx_cvcbs, SMX_NUM_CVS, 
+                                                   sizeof(CVCB), "cvcb_pool");
+   #endif
+
    #if SMX_NUM_EGS
    static EGCB egcb_pool[SMX_NUM_EGS];
    pass &= sb_BlockPoolCreate((u8*)&egcb_pool, &smx_egcbs, SMX_NUM_EGS, 
@@ -48,6 +48,7 @@ bool     smx_ObjectCreateTest(u32* hp);
 u32      smx_ObjectCreateTestH(u32* hp);
 bool     smx_ObjectDupTest(u32* hp);
 bool     smx_BCBTest(BCB_PTR blk, bool priv);
+bool     smx_CVCBTest(CVCB_PTR cv, bool priv);
 bool     smx_EGCBTest(EGCB_PTR eg, bool priv);
 bool     smx_EQCBTest(EQCB_PTR eq, bool priv);
 bool     smx_LCBTest(LCB_PTR lsr, bool priv);
@@ -106,15 +107,22 @@ void     smx_EMC(SMX_ERRNO errno, u8 sev);   /* error manager call */
 void     smx_EMClear(void);                  /* error manager clear */
 void     smx_EMHook(SMX_ERRNO errno, void* t, u8 sev);
 bool     smx_EMInit(void);                   /* initialize error mgr */
+#if SMX_CFG_HEAP_CACHE
+bool     smx_HeapCacheFlush(TCB_PTR task);   /* free task heap cache blocks */
+#endif
 bool     smx_InMS(void);                     /* in main stack */
 void     smx_KeepTimeLSRMain(u32 par);
 MCB_PTR  smx_MsgReceive_F(XCB_PTR xchg, u8** bpp, u32 timeout, MCB_PTR* mhp);
 bool     smx_MsgRel_F(MCB_PTR msg, u16 clrsz);
 u32      smx_MsgRelAll_F(TCB_PTR task);
 void     smx_MutexOnrPriAdj(MUCB_PTR mtx);   /* mutex owner priority adjust */
+void     smx_MutexUmtxClear(TCB_PTR task);   /* reset task's umode lock words */
 void     smx_RelPoolStack(TCB_PTR task);
 bool     smx_SchedRunLSRs(void);             /* LSR scheduler */
 bool     smx_SchedRunTasks(void);            /* task scheduler */
+#if SMX_SIZE_SEMRD
+void     smx_SemRelAll_F(TCB_PTR task);      /* release RDR/WRTR sem access */
+#endif
 u32      smx_SSRExit(u32 ret, u32 id);       /* SSR exit */
 u32      smx_SSRExitIF(u32 ret);             /* SSR exit internal function */
 void     smx_StackScan(void);                /* scan a stack to set HWM */
@@ -236,7 +244,9 @@ bool     smx_TokenTest(TCB_PTR task, u32 hp, bool priv);  /* verify task has tok
 /* test macros */
 #define smx_TEST_BRKNQ(q) \
    ((q) != 0 && ((((q)->cbtype >= SMX_CB_RQ) && ((q)->cbtype <= SMX_CB_MTX)) || \
-    ((q)->cbtype == SMX_CB_PIPE) || ((q)->cbtype == SMX_CB_EG)))
+    ((q)->cbtype == SMX_CB_PIPE) || ((q)->cbtype == SMX_CB_EG) || \
+    ((q)->cbtype == SMX_CB_CV) || ((q)->cbtype == SMX_CB_EQBKT) || \
+    ((q)->cbtype == SMX_CB_XSELQ)))
 
 #define smx_TEST_PRIORITY(pri) \
    (((u32)(pri) < SMX_PRI_NUM) || ((u32)(pri) == SMX_PRI_NOCHG))
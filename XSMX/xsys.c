@@ -165,7 +165,7 @@ SMX_CBTYPE smx_SysWhatIs(void* h)
       type = SMX_CB_BCB;
    else
       type = ((CB_PTR)h)->cbtype;
-   if (type > SMX_CB_LSR)
+   if (type > SMX_CB_XSELQ)
       smx_ERROR_EXIT(SMXE_INV_PAR, SMX_CB_NULL, 0, SMX_ID_SYS_WHAT_IS);
    return((SMX_CBTYPE)smx_SSRExit((u32)type, SMX_ID_SYS_WHAT_IS));
 }
@@ -427,6 +427,12 @@ void* smx_TaskLocate(const TCB_PTR task)
          qb = (CB_PTR)((u32)qb - sizeof(RQCB));
       }
 
+      #if SMX_SIZE_EQ_WHEEL
+      /* if in an event queue bucket, get the event queue */
+      if (qb != NULL && qb->cbtype == SMX_CB_EQBKT)
+         qb = (CB_PTR)((EQBKT*)qb)->eq;
+      #endif
+
       if (!smx_TEST_BRKNQ(qb))
          smx_ERROR_EXIT(SMXE_BROKEN_Q, NULL, 0, SMX_ID_TASK_LOCATE);
    }
@@ -592,6 +598,11 @@ u32 smx_TaskPeek(TCB_PTR task, SMX_PK_PAR par)
             if (val != SMX_TMO_INF)
                val -= smx_etime;
             break;
+        #if SMX_SIZE_XSEL
+         case SMX_PK_XCHG:
+            val = smx_xsel[task->indx].xi;
+            break;
+        #endif
         #if SMX_CFG_SSMX
          case SMX_PK_PRIV:
             if (task->parent)
@@ -1181,7 +1192,8 @@ void smx_TaskDeleteLSRMain(u32 taskp)
 *  smx_TaskFreeAll()
 *
 *  Releases all owned timers, frees task's MPA, deactivates task timeout, 
-*  and releases all owned blocks, messages, and mutexes.
+*  and releases all owned blocks, messages, heap cache blocks, RDR/WRTR 
+*  semaphore accesses, and mutexes.
 */
 bool smx_TaskFreeAll(TCB_PTR task)
 {
@@ -1207,6 +1219,24 @@ bool smx_TaskFreeAll(TCB_PTR task)
    smx_BlockRelAll_F(task);
    smx_MsgRelAll_F(task);
 
+   #if SMX_CFG_HEAP_CACHE
+   /* free all blocks in task heap cache */
+   pass &= smx_HeapCacheFlush(task);
+   #endif
+
+   #if SMX_CFG_HEAP_PLACE
+   /* reset task default heap placement hint */
+   smx_HeapPlaceTask(task, SMX_HP_NORM);
+   #endif
+
+   #if SMX_SIZE_SEMRD
+   /* release all read and write accesses to RDR and WRTR sems */
+   smx_SemRelAll_F(task);
+   #endif
+
+   /* reset umode mutex lock words taken by task without kernel knowledge */
+   smx_MutexUmtxClear(task);
+
    /* search for and free all owned mutexes */
    while (task->molp != NULL)
       pass &= smx_MutexFree(task->molp);
@@ -36,6 +36,7 @@
 /* These must be ahead of the struct defs below to avoid forward references. */
 typedef struct BCB*   BCB_PTR;
 typedef struct CB*    CB_PTR;
+typedef struct CVCB*  CVCB_PTR;
 typedef struct EGCB*  EGCB_PTR;
 typedef struct EQCB*  EQCB_PTR;
 typedef struct LCB*   LCB_PTR;
@@ -69,6 +70,17 @@ typedef struct CPS {       /* COARSE PROFILE STRUCTURE */
    u32         ovh;
 } CPS;
 
+typedef struct CVCB {      /* CONDITION VARIABLE CONTROL BLOCK */
+   TCB_PTR     fl;            /* forward link */
+   TCB_PTR     bl;            /* backward link */
+   SMX_CBTYPE  cbtype;        /* control block type (SMX_CB_CV) */
+   u8          pad1;
+   u16         pad2;
+   MUCB_PTR    mtx;           /* bound mutex while tasks are waiting */
+   const char* name;          /* name */
+   CVCB_PTR*   cvhp;          /* condition variable handle pointer */
+} CVCB;
+
 typedef struct EGCB {      /* EVENT GROUP CONTROL BLOCK */
    TCB_PTR     fl;            /* forward link */
    TCB_PTR     bl;            /* backward link */
@@ -76,14 +88,26 @@ typedef struct EGCB {      /* EVENT GROUP CONTROL BLOCK */
    u8          pad1;
    u16         pad2;
    u32         flags;         /* event flags */
+   u32         wmask;         /* OR of waiting task test masks */
    CBF_PTR     cbfun;         /* callback function */
    const char* name;          /* name */
    EGCB_PTR*   eghp;          /* event group handle pointer */
 } EGCB, *EGCB_PTR;
 
-typedef struct EQCB {      /* EVENT QUEUE CONTROL BLOCK */
+#if SMX_SIZE_EQ_WHEEL
+typedef struct EQBKT {     /* EVENT QUEUE COUNT BUCKET */
    TCB_PTR     fl;            /* forward link */
    TCB_PTR     bl;            /* backward link */
+   SMX_CBTYPE  cbtype;        /* control block type (SMX_CB_EQBKT) */
+   u8          pad1;
+   u16         pad2;
+   EQCB_PTR    eq;            /* event queue */
+} EQBKT;
+#endif
+
+typedef struct EQCB {      /* EVENT QUEUE CONTROL BLOCK */
+   TCB_PTR     fl;            /* forward link (not used with wheel) */
+   TCB_PTR     bl;            /* backward link (not used with wheel) */
    SMX_CBTYPE  cbtype;        /* control block type */
    u8          pad1;
    u8          pad2;
@@ -91,6 +115,10 @@ typedef struct EQCB {      /* EVENT QUEUE CONTROL BLOCK */
    CBF_PTR     cbfun;         /* callback function */
    const char* name;          /* name */
    EQCB_PTR*   eqhp;          /* event queue handle pointer */
+#if SMX_SIZE_EQ_WHEEL
+   u32         ctr;           /* signal counter */
+   EQBKT       bkt[SMX_SIZE_EQ_WHEEL]; /* task wait buckets by count */
+#endif
 } EQCB, *EQCB_PTR;
 
 typedef struct EREC {      /* ERROR RECORD FORMAT */
@@ -174,6 +202,26 @@ typedef struct MCB {       /* MESSAGE CONTROL BLOCK */
 #endif
 } MCB, *MCB_PTR;
 
+typedef struct MPSC {      /* MESSAGE POOL SET SIZE CLASS */
+   PCB_PTR     pool;          /* block pool for this class */
+   u32         gets;          /* messages gotten from this class */
+   u32         falls;         /* gets that fell back to this class because smaller class empty */
+   u32         waste;         /* total unused bytes in blocks gotten from this class */
+   u16         hwm;           /* high-water mark of blocks in use */
+   u16         pad;
+} MPSC;
+
+typedef struct MPS {       /* MESSAGE POOL SET */
+   MPSC*       cls;           /* size classes, in increasing block size order */
+   u32         num;           /* number of size classes */
+   u32         fails;         /* gets that failed because no class had a free block */
+} MPS, *MPS_PTR;
+
+typedef struct UMTX {      /* UMODE MUTEX LOCK WORD */
+   vu32        lock;          /* owner TCB | SMX_UMTX_KERN flag, 0 if free */
+   MUCB_PTR    mtx;           /* mutex */
+} UMTX, *UMTX_PTR;
+
 typedef struct MUCB {      /* MUTEX CONTROL BLOCK */
    TCB_PTR     fl;            /* forward link */
    TCB_PTR     bl;            /* backward link */
@@ -186,6 +234,9 @@ typedef struct MUCB {      /* MUTEX CONTROL BLOCK */
    MUCB_PTR    molp;          /* next mutex in mutex owned list */
    u32         ncnt;          /* nesting count */
    MUCB_PTR*   muhp;          /* mutex handle pointer */
+   UMTX_PTR    um;            /* umode lock word, NULL if none */
+   TCB_PTR     umpt;          /* top parent of tasks that may own mtx via um */
+   MUCB_PTR    umlp;          /* next mutex in smx_umtxl */
 } MUCB;
 
 /* PCB -- see bdef.h */
@@ -197,8 +248,7 @@ typedef struct PICB {      /* PIPE CONTROL BLOCK */
    struct {                   /* flags */
       u8       full : 1;      /* pipe is full */
    } flags;
-   u8          width;         /* pipe width (bytes) */
-   u8          length;        /* pipe length (cells) */
+   u16         width;         /* pipe width (bytes) */
    const char* name;          /* name */
    u8*         bi;            /* start of buffer */
    u8*         rp;            /* pipe read pointer */
@@ -224,11 +274,13 @@ typedef struct SCB {       /* SEMAPHORE CONTROL BLOCK */
    TCB_PTR     bl;            /* backward link */
    SMX_CBTYPE  cbtype;        /* control block type */
    SMX_SEM_MODE mode;         /* operating mode */
-   u8          count;         /* signal count */
-   u8          lim;           /* count limit or threshold */
+   u16         wrtrs;         /* writers waiting (RDR and WRTR modes) */
+   u32         count;         /* signal count */
+   u32         lim;           /* count limit or threshold */
    CBF_PTR     cbfun;         /* callback function */
    const char* name;          /* name */
    SCB_PTR*    shp;           /* semaphore handle pointer */
+   TCB_PTR     onr;           /* writer owner (RDR and WRTR modes) */
 } SCB, *SCB_PTR;
 
 #define SMX_TCB_OFFS_SP     32   /* offset to TCB.sp field */
@@ -275,6 +327,9 @@ typedef struct TCB {       /* TASK CONTROL BLOCK */
       u32      da_enter : 1;     /* deferred action function enter */
       u32      da_run : 1;       /* deferred action function running */
       u32      da_exit : 1;      /* deferred action function exit */
+      u32      msg_m : 1;        /* task waiting in smx_MsgReceiveM() */
+      u32      pipe_peek : 1;    /* task waiting to peek at pipe */
+      u32      sem_wrtr : 1;     /* task waiting for write access to RDR/WRTR sem */
    } flags;
    u8*         spp;           /* +24 stack pad pointer */
    u8*         stp;           /* +28 stack top pointer -- last usable word */
@@ -351,6 +406,7 @@ typedef struct XCB {       /* EXCHANGE CONTROL BLOCK */
       u8       mq : 1;        /* message queue present */
       u8       tq : 1;        /* task queue present */
       u8       pi : 1;        /* priority inheritance */
+      u8       sel : 1;       /* select waiter may be present */
    } flags;
    TCB_PTR     onr;           /* owner if pi = true */
    CBF_PTR     cbfun;         /* callback function */
@@ -359,6 +415,15 @@ typedef struct XCB {       /* EXCHANGE CONTROL BLOCK */
    TCB_PTR     bct;           /* bound client task if pi = true */
 } XCB, *XCB_PTR;
 
+#if SMX_SIZE_XSEL
+typedef struct XSEL {      /* EXCHANGE SELECT RECORD */
+   XCB_PTR     xl[SMX_SIZE_XSEL]; /* exchange list (copy) */
+   u32         num;           /* number of exchanges in list */
+   u32         xi;            /* index of exchange that supplied msg */
+   u32         xmap;          /* bit (XCB index & 31) set for each exchange in xl */
+} XSEL;
+#endif
+
 
 /* Notes:
    1. Do not move. See note 1 in xglob.c.